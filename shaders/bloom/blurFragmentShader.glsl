@@ -0,0 +1,27 @@
+#version 330 core
+
+// BLOOM BLUR SHADER
+// One direction of a separable 9-tap gaussian blur. Bilinear filtering merges pairs of taps, so only 5 fetches are needed.
+
+out vec3 FragColor;
+
+in vec2 TexCoords;
+
+uniform sampler2D SourceTexture;
+uniform vec2 Direction; // (1, 0) for the horizontal pass, (0, 1) for the vertical pass
+
+const float offsets[3] = float[](0.0, 1.3846153846, 3.2307692308);
+const float weights[3] = float[](0.2270270270, 0.3162162162, 0.0702702703);
+
+void main()
+{
+    vec2 step = Direction / textureSize(SourceTexture, 0);
+
+    vec3 color = texture(SourceTexture, TexCoords).rgb * weights[0];
+    for (int i = 1; i < 3; i++) {
+        color += texture(SourceTexture, TexCoords + step * offsets[i]).rgb * weights[i];
+        color += texture(SourceTexture, TexCoords - step * offsets[i]).rgb * weights[i];
+    }
+
+    FragColor = color;
+}
\ No newline at end of file
@@ -0,0 +1,29 @@
+#version 330 core
+
+// BLOOM DOWNSAMPLE SHADER
+// Halves the resolution of the source texture. The first pass also removes everything below the bloom threshold.
+
+out vec3 FragColor;
+
+in vec2 TexCoords;
+
+uniform sampler2D SourceTexture;
+uniform bool ApplyThreshold;
+uniform float Threshold;
+
+void main()
+{
+    // Each bilinear fetch sits on the corner between 4 source texels, so 4 fetches average a 4x4 block
+    vec2 texelSize = 1.0 / textureSize(SourceTexture, 0);
+    vec3 color = (texture(SourceTexture, TexCoords + texelSize * vec2(-1.0, -1.0)).rgb
+                + texture(SourceTexture, TexCoords + texelSize * vec2( 1.0, -1.0)).rgb
+                + texture(SourceTexture, TexCoords + texelSize * vec2(-1.0,  1.0)).rgb
+                + texture(SourceTexture, TexCoords + texelSize * vec2( 1.0,  1.0)).rgb) * 0.25;
+
+    if (ApplyThreshold) {
+        float brightness = max(color.r, max(color.g, color.b));
+        color *= max(brightness - Threshold, 0.0) / max(brightness, 0.0001);
+    }
+
+    FragColor = color;
+}
\ No newline at end of file
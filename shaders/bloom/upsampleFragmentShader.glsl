@@ -0,0 +1,21 @@
+#version 330 core
+
+// BLOOM UPSAMPLE SHADER
+// Samples the next smaller level with a tent filter. The result is added on top of the current level with additive blending.
+
+out vec3 FragColor;
+
+in vec2 TexCoords;
+
+uniform sampler2D SourceTexture;
+
+void main()
+{
+    vec2 texelSize = 1.0 / textureSize(SourceTexture, 0);
+    vec3 color = (texture(SourceTexture, TexCoords + texelSize * vec2(-0.5, -0.5)).rgb
+                + texture(SourceTexture, TexCoords + texelSize * vec2( 0.5, -0.5)).rgb
+                + texture(SourceTexture, TexCoords + texelSize * vec2(-0.5,  0.5)).rgb
+                + texture(SourceTexture, TexCoords + texelSize * vec2( 0.5,  0.5)).rgb) * 0.25;
+
+    FragColor = color;
+}
\ No newline at end of file
@@ -0,0 +1,13 @@
+#version 330 core
+
+// FULLSCREEN TRIANGLE VERTEX SHADER USED BY THE BLOOM PASSES
+// No vertex buffer is needed: the 3 vertices are generated from their index and cover the whole screen
+
+out vec2 TexCoords;
+
+void main()
+{
+    vec2 position = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2); // (0,0), (2,0), (0,2)
+    TexCoords = position;
+    gl_Position = vec4(position * 2.0 - 1.0, 0.0, 1.0);
+}
\ No newline at end of file
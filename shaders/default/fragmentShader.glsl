@@ -13,47 +13,83 @@ in float visibility;
 layout(location = 0) out vec3 color;
 layout(location = 1) out vec3 emission;
 
+// Values that stay constant for the whole frame.
+layout(std140) uniform FrameData {
+	mat4 View;
+	mat4 Projection;
+	mat4 ViewProjection;
+	vec4 Light_worldspace; // xyz = position, w = radius
+	vec4 LightColor;
+	vec4 Camera_worldspace; // xyz = position, w = time
+};
+
 // Values that stay constant for the whole mesh.
-uniform mat4 MV;
-uniform bool Unlit;
-uniform bool Emissive;
-uniform vec3 LightPosition_worldspace;
-uniform vec3 LightColor;
-uniform vec3 ModelColor;
-
-// For shadow raymarching. An occluder is a body that can cast a shadow on the currently rendered object.
-uniform int OccluderCount;
-uniform vec3 OccluderPositions[4];
-uniform float OccluderRadiuses[4];
-uniform float LightRadius;
-
-const float MAX_RAYMARCH_DISTANCE = 1000.0F;
+layout(std140) uniform DrawData {
+	mat4 M;
+	vec4 ModelColor;
+	ivec4 DrawFlags; // x = unlit, y = emissive, z = occluder offset, w = occluder count
+};
+
+// For shadows. An occluder is a body that can cast a shadow on the currently rendered object.
+// The occluders of every body are stored in a single buffer (xyz = position, w = radius), this object's ones being in [DrawFlags.z; DrawFlags.z + DrawFlags.w[
+uniform samplerBuffer Occluders;
+
+const float PI = 3.1415926538;
 const float MIN_LIGHT_LEVEL = 0.1;
 
-float estimateOccluderDistance(vec3 p) {
-	float minDist = MAX_RAYMARCH_DISTANCE;
+// Area of the intersection of two disks of radiuses a and b whose centers are c apart
+float diskOverlap(float a, float b, float c) {
+	if (c >= a + b) return 0.0; // Disjoint
+	if (c <= abs(a - b)) return PI * min(a, b) * min(a, b); // One is inside the other
+
+	float a2 = a * a, b2 = b * b;
+	return a2 * acos(clamp((c * c + a2 - b2) / (2.0 * c * a), -1.0, 1.0))
+		+ b2 * acos(clamp((c * c + b2 - a2) / (2.0 * c * b), -1.0, 1.0))
+		- 0.5 * sqrt(max((-c + a + b) * (c + a - b) * (c - a + b) * (c + a + b), 0.0));
+}
+
+// Fraction of the light disk hidden by the occluders, as seen from p.
+// Each occluder is a disk on the sky of p, so its shadow is the overlap of that disk with the light's disk (constant time per occluder)
+float computeOcclusion(vec3 p) {
+	vec3 toLight = Light_worldspace.xyz - p;
+	float distToLight = length(toLight);
+	toLight /= distToLight;
+
+	float lightAngularRadius = asin(min(Light_worldspace.w / distToLight, 1.0));
+	float lightArea = max(PI * lightAngularRadius * lightAngularRadius, 1e-8);
+
+	float lightVisibility = 1.0;
+	for (int i = 0; i < DrawFlags.w; i++) {
+		vec4 occluder = texelFetch(Occluders, DrawFlags.z + i);
+
+		vec3 toOccluder = occluder.xyz - p;
+		float distToOccluder = length(toOccluder);
+		if (distToOccluder - occluder.w > distToLight) continue; // Behind the light
+		toOccluder /= distToOccluder;
+
+		float occluderAngularRadius = asin(min(occluder.w / distToOccluder, 1.0));
+		float separation = atan(length(cross(toLight, toOccluder)), dot(toLight, toOccluder)); // More precise than acos for small angles
 
-	for (int i = 0; i < OccluderCount; i++) {
-		minDist = min(minDist, distance(p, OccluderPositions[i]) - OccluderRadiuses[i]);
+		lightVisibility *= 1.0 - min(diskOverlap(lightAngularRadius, occluderAngularRadius, separation) / lightArea, 1.0);
 	}
 
-	return minDist;
+	return 1.0 - lightVisibility;
 }
 
 void main() {
-	if (Unlit) {
-		color = ModelColor * visibility;
+	if (DrawFlags.x != 0) { // Unlit
+		color = ModelColor.rgb * visibility;
 	} else {
 		// Light emission properties
 		float LightPower = 25.0f;
 
 		// Material properties
-		vec3 MaterialDiffuseColor = ModelColor;
+		vec3 MaterialDiffuseColor = ModelColor.rgb;
 		vec3 MaterialAmbientColor = vec3(MIN_LIGHT_LEVEL) * MaterialDiffuseColor;
 		vec3 MaterialSpecularColor = vec3(0);
 
 		// Distance to the light
-		float distance = length(LightPosition_worldspace - Position_worldspace);
+		float distance = length(Light_worldspace.xyz - Position_worldspace);
 
 		// Normal of the computed fragment, in camera space
 		vec3 n = normalize(Normal_cameraspace);
@@ -76,32 +112,20 @@ void main() {
 		//  - Looking elsewhere -> < 1
 		float cosAlpha = clamp(dot(E, R), 0.0, 1.0);
 
-		// Shadow raymarching
+		// Shadows
 		float occlusion = 0.0;
 
-		if (dot(l, n) > 0.0 && OccluderCount > 0) { // Don't compute occlusion if fragment is facing away from the light or if there isn't any occluder
-			vec3 toLight = normalize(LightPosition_worldspace - Position_worldspace);
-			float distToLight = length(LightPosition_worldspace - Position_worldspace);
-			float d = LightRadius * 0.1;
-			while (d < MAX_RAYMARCH_DISTANCE)
-			{
-				float ed = estimateOccluderDistance(Position_worldspace + d * toLight);
-				occlusion = max(0.5 + (-ed) * distToLight / (2.0 * LightRadius * d), occlusion);
-				if (occlusion >= 1.0) break;
-
-				d += max(ed, LightRadius * d / distToLight);
-				if (d >= distToLight) break;
-			}
-			occlusion = clamp(occlusion, 0.0, 1.0);
+		if (dot(l, n) > 0.0 && DrawFlags.w > 0) { // Don't compute occlusion if fragment is facing away from the light or if there isn't any occluder
+			occlusion = computeOcclusion(Position_worldspace);
 		}
 
 		color =
-			(max(MaterialDiffuseColor * LightColor * cosTheta * (1.0 - occlusion), MaterialAmbientColor) // Diffuse, shadow and ambient
-			+ MaterialSpecularColor * LightColor * LightPower * pow(cosAlpha, 5) / (distance * distance)) // Specular
+			(max(MaterialDiffuseColor * LightColor.rgb * cosTheta * (1.0 - occlusion), MaterialAmbientColor) // Diffuse, shadow and ambient
+			+ MaterialSpecularColor * LightColor.rgb * LightPower * pow(cosAlpha, 5) / (distance * distance)) // Specular
 			* visibility;
 	}
 
-	if (Emissive) {
-		emission = ModelColor;
+	if (DrawFlags.y != 0) { // Emissive
+		emission = ModelColor.rgb;
 	}
 }
\ No newline at end of file
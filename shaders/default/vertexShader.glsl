@@ -13,11 +13,22 @@ out vec3 EyeDirection_cameraspace;
 out vec3 LightDirection_cameraspace;
 out float visibility;
 
+// Values that stay constant for the whole frame.
+layout(std140) uniform FrameData {
+	mat4 View;
+	mat4 Projection;
+	mat4 ViewProjection;
+	vec4 Light_worldspace; // xyz = position, w = radius
+	vec4 LightColor;
+	vec4 Camera_worldspace; // xyz = position, w = time
+};
+
 // Values that stay constant for the whole mesh.
-uniform mat4 MVP;
-uniform mat4 V;
-uniform mat4 M;
-uniform vec3 LightPosition_worldspace;
+layout(std140) uniform DrawData {
+	mat4 M;
+	vec4 ModelColor;
+	ivec4 DrawFlags; // x = unlit, y = emissive, z = occluder offset, w = occluder count
+};
 
 // "Fog" settings (make things fade out when too far away to avoid a hard edge at the end of the far plane)
 const float density = 0.015;
@@ -25,25 +36,25 @@ const float gradient = 3.0;
 
 void main() {
 
-	// Output position of the vertex, in clip space : MVP * position
-	gl_Position = MVP * vec4(vertexPosition_modelspace, 1);
+	// Output position of the vertex, in clip space : VP * M * position
+	gl_Position = ViewProjection * M * vec4(vertexPosition_modelspace, 1);
 
 	// Position of the vertex, in worldspace : M * position
 	Position_worldspace = (M * vec4(vertexPosition_modelspace, 1)).xyz;
 
 	// Vector that goes from the vertex to the camera, in camera space.
 	// In camera space, the camera is at the origin (0,0,0).
-	vec3 vertexPosition_cameraspace = (V * M * vec4(vertexPosition_modelspace, 1)).xyz;
+	vec3 vertexPosition_cameraspace = (View * M * vec4(vertexPosition_modelspace, 1)).xyz;
 	EyeDirection_cameraspace = vec3(0, 0, 0) - vertexPosition_cameraspace;
 
 	// Vector that goes from the vertex to the light, in camera space. M is ommited because it's identity.
-	vec3 LightPosition_cameraspace = (V * vec4(LightPosition_worldspace, 1)).xyz;
+	vec3 LightPosition_cameraspace = (View * vec4(Light_worldspace.xyz, 1)).xyz;
 	LightDirection_cameraspace = LightPosition_cameraspace + EyeDirection_cameraspace;
 
 	// Normal of the the vertex, in camera space
-	Normal_cameraspace = (V * M * vec4(vertexNormal_modelspace, 0)).xyz; // Only correct if ModelMatrix does not scale the model ! Use its inverse transpose if not.
+	Normal_cameraspace = (View * M * vec4(vertexNormal_modelspace, 0)).xyz; // Only correct if ModelMatrix does not scale the model ! Use its inverse transpose if not.
 
-	vec3 position_cameraspace = (V * vec4(Position_worldspace, 1)).xyz;
+	vec3 position_cameraspace = (View * vec4(Position_worldspace, 1)).xyz;
 	float distance = length(position_cameraspace);
 	visibility = clamp(exp(-pow((distance * density), gradient)), 0.0, 1.0);
 }
\ No newline at end of file
@@ -0,0 +1,74 @@
+#version 330 core
+
+// INFINITE GRID FRAGMENT SHADER
+// Intersects the view ray with the y = 0 plane and draws the grid lines analytically, so the grid has no edges and keeps the same look at any zoom
+
+in vec3 NearPoint_worldspace;
+in vec3 FarPoint_worldspace;
+
+// Ouput data
+layout(location = 0) out vec4 color;
+layout(location = 1) out vec4 emission;
+
+// Values that stay constant for the whole frame.
+layout(std140) uniform FrameData {
+	mat4 View;
+	mat4 Projection;
+	mat4 ViewProjection;
+	vec4 Light_worldspace; // xyz = position, w = radius
+	vec4 LightColor;
+	vec4 Camera_worldspace; // xyz = position, w = time
+};
+
+const float BASE_SPACING = 10.0; // Spacing of the finest lines
+const float MIN_PIXELS_BETWEEN_LINES = 12.0; // Lines closer than this on screen are replaced by the next level (10 times larger)
+const float LINE_WIDTH = 1.0; // In pixels
+const float AXIS_WIDTH = 3.0; // In pixels
+
+// Same "fog" as the default shader, so that the grid fades out with the rest of the world
+const float density = 0.015;
+const float gradient = 3.0;
+
+// Returns 1 on a line of the grid with the given spacing and 0 between lines (antialiased using the screen-space derivatives)
+float gridLines(vec2 p, float spacing) {
+	vec2 coord = p / spacing;
+	vec2 derivative = fwidth(coord);
+	vec2 distanceToLine = abs(fract(coord - 0.5) - 0.5) / derivative; // In pixels
+	return 1.0 - min(min(distanceToLine.x, distanceToLine.y) / LINE_WIDTH, 1.0);
+}
+
+void main() {
+	// No discard before the derivatives below: they are undefined in non-uniform control flow, which would break the lines along the horizon
+	float t = -NearPoint_worldspace.y / (FarPoint_worldspace.y - NearPoint_worldspace.y); // t <= 0: the ray doesn't hit the plane
+
+	vec3 position_worldspace = NearPoint_worldspace + t * (FarPoint_worldspace - NearPoint_worldspace);
+	vec2 p = position_worldspace.xz;
+
+	// Pick the spacing from how much of the world a pixel covers here, blending between two levels to avoid popping
+	vec2 worldPerPixel = fwidth(p);
+	float lod = max(log(max(worldPerPixel.x, worldPerPixel.y) * MIN_PIXELS_BETWEEN_LINES / BASE_SPACING) / log(10.0), 0.0);
+	float spacing = BASE_SPACING * pow(10.0, floor(lod));
+	float lodBlend = fract(lod);
+
+	float lines = max(gridLines(p, spacing) * (1.0 - lodBlend), gridLines(p, spacing * 10.0));
+	vec3 lineColor = vec3(1.0);
+
+	// Axes (red along x, blue along z)
+	float xAxis = 1.0 - min(abs(p.y) / worldPerPixel.y / AXIS_WIDTH, 1.0);
+	float zAxis = 1.0 - min(abs(p.x) / worldPerPixel.x / AXIS_WIDTH, 1.0);
+	if (xAxis > 0.0) { lineColor = vec3(1.0, 0.0, 0.0); lines = max(lines, xAxis); }
+	if (zAxis > 0.0) { lineColor = vec3(0.0, 0.0, 1.0); lines = max(lines, zAxis); }
+
+	float distance = length(position_worldspace - Camera_worldspace.xyz);
+	float visibility = clamp(exp(-pow((distance * density), gradient)), 0.0, 1.0);
+
+	float alpha = lines * visibility;
+	if (t <= 0.0 || alpha < 0.01) discard;
+
+	// Write the depth of the plane so that bodies correctly hide the grid (and the other way around)
+	vec4 position_clipspace = ViewProjection * vec4(position_worldspace, 1.0);
+	gl_FragDepth = (position_clipspace.z / position_clipspace.w) * 0.5 + 0.5;
+
+	color = vec4(lineColor, alpha);
+	emission = vec4(0.0);
+}
\ No newline at end of file
@@ -0,0 +1,32 @@
+#version 330 core
+
+// INFINITE GRID VERTEX SHADER
+// Draws a fullscreen triangle and computes, for each corner, the points on the near and far planes it covers (in world space)
+
+// Output data ; will be interpolated for each fragment.
+out vec3 NearPoint_worldspace;
+out vec3 FarPoint_worldspace;
+
+// Values that stay constant for the whole frame.
+layout(std140) uniform FrameData {
+	mat4 View;
+	mat4 Projection;
+	mat4 ViewProjection;
+	vec4 Light_worldspace; // xyz = position, w = radius
+	vec4 LightColor;
+	vec4 Camera_worldspace; // xyz = position, w = time
+};
+
+vec3 unproject(vec2 position, float depth, mat4 inverseViewProjection) {
+	vec4 point = inverseViewProjection * vec4(position, depth, 1.0);
+	return point.xyz / point.w;
+}
+
+void main() {
+	vec2 position = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2) * 2.0 - 1.0; // (-1,-1), (3,-1), (-1,3)
+	gl_Position = vec4(position, 0.0, 1.0);
+
+	mat4 inverseViewProjection = inverse(ViewProjection);
+	NearPoint_worldspace = unproject(position, -1.0, inverseViewProjection);
+	FarPoint_worldspace = unproject(position, 1.0, inverseViewProjection);
+}
\ No newline at end of file
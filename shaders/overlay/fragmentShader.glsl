@@ -7,11 +7,20 @@ in vec2 uv;
 layout(location = 0) out vec4 color;
 layout(location = 1) out vec3 emission;
 
-uniform float Time;
+// Values that stay constant for the whole frame.
+layout(std140) uniform FrameData {
+    mat4 View;
+    mat4 Projection;
+    mat4 ViewProjection;
+    vec4 Light_worldspace; // xyz = position, w = radius
+    vec4 LightColor;
+    vec4 Camera_worldspace; // xyz = position, w = time
+};
+
 uniform vec2 OverlaySize;
 
 void main() {
-    float size = sin(4.0 * Time) * 0.05 + 0.95;
+    float size = sin(4.0 * Camera_worldspace.w) * 0.05 + 0.95;
     float width = 0.005 / OverlaySize.x * 1.5F;
 
     float b = 0.0;
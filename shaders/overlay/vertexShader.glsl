@@ -9,16 +9,27 @@ layout(location = 0) in vec3 vertexPosition_modelspace;
 // Output data ; will be interpolated for each fragment.
 out vec2 uv;
 
+// Values that stay constant for the whole frame.
+layout(std140) uniform FrameData {
+	mat4 View;
+	mat4 Projection;
+	mat4 ViewProjection;
+	vec4 Light_worldspace; // xyz = position, w = radius
+	vec4 LightColor;
+	vec4 Camera_worldspace; // xyz = position, w = time
+};
+
 // Values that stay constant for the whole mesh.
-uniform vec3 CameraRight_worldspace;
-uniform vec3 CameraUp_worldspace;
-uniform mat4 VP; // View-Projection matrix, but without the Model
 uniform vec3 OverlayPos; // Position of the center of the overlay
 uniform vec2 OverlaySize; // Size of the overlay
 
 void main() {
 	vec3 particleCenter_wordspace = OverlayPos;
 
+	// http://www.opengl-tutorial.org/intermediate-tutorials/billboards-particles/billboards/
+	vec3 CameraRight_worldspace = vec3(View[0][0], View[1][0], View[2][0]);
+	vec3 CameraUp_worldspace = vec3(View[0][1], View[1][1], View[2][1]);
+
 	vec3 vertexPosition_worldspace =
 		particleCenter_wordspace
 		+ CameraRight_worldspace * vertexPosition_modelspace.x * OverlaySize.x
@@ -26,7 +37,7 @@ void main() {
 
 
 	// Output position of the vertex
-	gl_Position = VP * vec4(vertexPosition_worldspace, 1.0f);
+	gl_Position = ViewProjection * vec4(vertexPosition_worldspace, 1.0f);
 
 	uv = vertexPosition_modelspace.xy * 0.5 + vec2(0.5, 0.5);
 }
\ No newline at end of file
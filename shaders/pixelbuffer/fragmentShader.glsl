@@ -0,0 +1,39 @@
+#version 330 core
+
+// PIXEL BUFFER SHADER OF THE PLANE PRESENTER
+// Rebuilds the color from the textures of any of the presenter's pixel formats (see plane_presenter.cpp), like the EEPixelViewer shaders:
+// one texture whose channels are reordered, two (Y' then interleaved CbCr) or three (one channel each)
+
+out vec4 FragColor;
+
+in vec2 TexCoords;
+
+uniform sampler2D Texture1;
+uniform sampler2D Texture2;
+uniform sampler2D Texture3;
+uniform int TextureCount;
+uniform ivec3 PermuteMap; // Channel each component is read from (Y' from the first texture, the others from the last one)
+
+uniform bool YpCbCr;
+uniform mat4 CoefficientMatrix;
+uniform vec4 YpCbCrOffsets;
+
+void main()
+{
+    vec4 first = texture(Texture1, TexCoords);
+    vec4 color;
+    if (TextureCount == 1) {
+        color = vec4(first[PermuteMap[0]], first[PermuteMap[1]], first[PermuteMap[2]], 1.0);
+    }
+    else if (TextureCount == 2) {
+        vec4 second = texture(Texture2, TexCoords);
+        color = vec4(first[PermuteMap[0]], second[PermuteMap[1]], second[PermuteMap[2]], 1.0);
+    }
+    else {
+        color = vec4(first.r, texture(Texture2, TexCoords).r, texture(Texture3, TexCoords).r, 1.0);
+    }
+
+    if (YpCbCr) color = (color - YpCbCrOffsets) * CoefficientMatrix;
+
+    FragColor = vec4(color.rgb, 1.0);
+}
\ No newline at end of file
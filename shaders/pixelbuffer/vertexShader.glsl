@@ -0,0 +1,13 @@
+#version 330 core
+
+// FULLSCREEN TRIANGLE VERTEX SHADER OF THE PLANE PRESENTER
+// Same as the bloom one, except that the texture rows go from top to bottom like the pixel buffers
+
+out vec2 TexCoords;
+
+void main()
+{
+    vec2 position = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2); // (0,0), (2,0), (0,2)
+    TexCoords = vec2(position.x, 1.0 - position.y);
+    gl_Position = vec4(position * 2.0 - 1.0, 0.0, 1.0);
+}
\ No newline at end of file
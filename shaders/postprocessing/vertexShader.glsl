@@ -1,11 +1,11 @@
 #version 330 core
-layout(location = 0) in vec2 aPos;
-layout(location = 1) in vec2 aTexCoords;
 
+// Fullscreen triangle generated from the vertex index (no vertex buffer needed)
 out vec2 TexCoords;
 
 void main()
 {
-    gl_Position = vec4(aPos.x, aPos.y, 0.0, 1.0);
-    TexCoords = aTexCoords;
+    vec2 position = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2); // (0,0), (2,0), (0,2)
+    gl_Position = vec4(position * 2.0 - 1.0, 0.0, 1.0);
+    TexCoords = position;
 }
\ No newline at end of file
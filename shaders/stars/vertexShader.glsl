@@ -1,31 +1,17 @@
 #version 330 core
-#define PI 3.1415926538
 
-// STAR SPHERE VERTEX SHADER
+// STARFIELD SKYBOX VERTEX SHADER
+// Draws a fullscreen triangle on the far plane and computes the world-space view direction of each corner
 
-// Input vertex data, different for all executions of this shader.
-layout(location = 0) in vec3 vertexPosition_modelspace;
-layout(location = 1) in vec2 vertexTextureCoordinate;
-layout(location = 2) in vec3 vertexNormal_modelspace;
+out vec3 ViewDirection_worldspace;
 
-// Output data ; will be interpolated for each fragment.
-out vec3 Position_worldspace;
-out vec3 Normal_cameraspace;
-out vec3 EyeDirection_cameraspace;
-out vec2 uv;
-
-// Values that stay constant for the whole mesh.
-uniform mat4 MVP;
-uniform mat4 V;
+// Inverse of the projection * view matrix, without the camera translation
+uniform mat4 InverseVP;
 
 void main() {
+	vec2 position = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2) * 2.0 - 1.0; // (-1,-1), (3,-1), (-1,3)
+	gl_Position = vec4(position, 1.0, 1.0);
 
-	// Output position of the vertex, in clip space : MVP * position
-	gl_Position = MVP * vec4(vertexPosition_modelspace, 1);
-
-	// Normal of the the vertex, in camera space
-	Normal_cameraspace = (V * vec4(vertexNormal_modelspace, 0)).xyz; // Only correct if ModelMatrix does not scale the model ! Use its inverse transpose if not.
-
-	vec3 d = normalize(vertexPosition_modelspace);
-	uv = vec2(0.5 + atan(d.x, d.z)/(2*PI), 0.5 - asin(d.y)/PI);
+	vec4 farPoint = InverseVP * vec4(position, 1.0, 1.0);
+	ViewDirection_worldspace = farPoint.xyz / farPoint.w;
 }
\ No newline at end of file
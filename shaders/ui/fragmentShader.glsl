@@ -7,16 +7,20 @@ in vec2 uv;
 layout(location = 0) out vec4 color;
 layout(location = 1) out vec3 emission;
 
-uniform bool UseTexture;
+// Font atlas (solid rectangles use a white area of it, so everything can be drawn at once)
 uniform sampler2D textureData;
+uniform bool DistanceField; // The atlas alpha is a signed distance with the glyph edges at 0.5
 
 void main() {
-    if (UseTexture) {
-        color = texture(textureData, uv) * interpolatedVertexColor;
-    }
-    else {
-        color = interpolatedVertexColor;
+    vec4 texel = texture(textureData, uv);
+
+    if (DistanceField) {
+        // Antialias over about one screen pixel, whatever the text scale is
+        float smoothing = max(fwidth(texel.a) * 0.75, 0.0001);
+        texel.a = smoothstep(0.5 - smoothing, 0.5 + smoothing, texel.a);
     }
 
+    color = texel * interpolatedVertexColor;
+
     emission = vec3(0);
 }
\ No newline at end of file
@@ -10,8 +10,6 @@ layout(location = 2) in vec2 textureCoords;
 out vec4 interpolatedVertexColor;
 out vec2 uv;
 
-uniform bool UseTexture;
-
 void main() {
 	gl_Position = vec4(vertexPos, 1.0f);
 
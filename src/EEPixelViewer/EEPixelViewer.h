@@ -27,6 +27,7 @@
 #define GL_SILENCE_DEPRECATION
 #import <GLKit/GLKit.h>
 
+// renderer::planePresenter::Plane (src/rendering/plane_presenter.h) has the same layout, for the portable GLFW version of this view
 typedef struct EEPixelViewerPlane
 {
     void    *data;
@@ -31,7 +31,7 @@
 
 #import "OGLProgramManager.h"
 
-#import <Accelerate/Accelerate.h>
+#include "../rendering/pixel_convert.h"
 
 #import "NSLabel.h"
 
@@ -107,6 +107,9 @@ typedef enum ContentModeCustom {
     // This is a special optimization for OpenGL ES 2.0 devices that somewhat improves performance
     // for 24bpp formats such as 24RGB, 24BGR, and 444YpCbCr.
     BOOL treat24bppAs3Planes;
+    
+    // The three 8bpp planes of load24bppAsPlanarTextures, kept from frame to frame
+    PixelBufferPool planarBufferPool;
 }
 @end
 
@@ -325,7 +328,7 @@ typedef enum ContentModeCustom {
             {
                 // For kCVPixelFormatType_444YpCbCr8, we describe it as a 3-planar format because
                 // that appears to be a quicker way to load the textures. Rather than load a single 24-bpp
-                // buffer, we use the Accelerate framework to break it down into three separate 8-bpp planes,
+                // buffer, we use SIMD conversions (pixel_convert.h) to break it down into three separate 8-bpp planes,
                 // which we then proceed to load as three distinct textures. It ends up being much faster
                 // on older devices.
                 shaderName = @"PixelViewer_YpCbCr_3P";
@@ -381,7 +384,7 @@ typedef enum ContentModeCustom {
             {
                 // We treat 24-bpp RGB formats as 3-planar formats because that appears to be a
                 // quicker way to load the textures. Rather than load a single 24-bpp buffer, we use
-                // the Accelerate framework to break it down into three separate 8-bpp planes,
+                // SIMD conversions (pixel_convert.h) to break it down into three separate 8-bpp planes,
                 // which we then proceed to load as three distinct textures. It ends up being much faster
                 // on older devices.
                 
@@ -896,6 +899,8 @@ typedef enum ContentModeCustom {
     glDeleteTextures(4, textures);
 	glDeleteBuffers(1, &rectVertexBuffer);
 	glDeleteBuffers(1, &rectIndexBuffer);
+    
+    pixelBufferPoolRelease(&planarBufferPool);
 }
 
 #pragma mark - Public API
@@ -908,37 +913,47 @@ typedef enum ContentModeCustom {
 }
 
 // load24bppAsPlanarTextures: This is an optimization for ES 2.0 where we convert any 24bpp formats
-// to 3 8bpp planes which are then loaded to the GPU. The conversion is done efficiently on multiple
-// threads using Accelerate.framework. On devices that support OpenGL ES 3.0 we just load the 24bpp
+// to 3 8bpp planes which are then loaded to the GPU. The conversion uses SSSE3/AVX2 or NEON (pixel_convert.h)
+// into planes that are only allocated again when the image grows. On devices that support OpenGL ES 3.0 we just load the 24bpp
 // textures directly, which seems to be an overall better compromise.
 - (void) load24bppAsPlanarTextures: (EEPixelViewerPlane *) planes count: (int) planeCount
 {
-    vImage_Buffer destPlanarBuffers[3] = { malloc(_sourceImageSize.width * _sourceImageSize.height), _sourceImageSize.height, _sourceImageSize.width, _sourceImageSize.width,
-        
-        malloc(_sourceImageSize.width * _sourceImageSize.height), _sourceImageSize.height, _sourceImageSize.width, _sourceImageSize.width,
-        
-        malloc(_sourceImageSize.width * _sourceImageSize.height), _sourceImageSize.height, _sourceImageSize.width, _sourceImageSize.width};
+    int width = (int) _sourceImageSize.width;
+    int height = (int) _sourceImageSize.height;
+    size_t planeSize = (size_t) width * height;
+    
+    unsigned char *planarBuffer = pixelBufferPoolGet(&planarBufferPool, planeSize * 3);
+    if (planarBuffer == NULL)
+        return;
     
-    vImage_Buffer sourceRGBBuffer = { planes[0].data, planes[0].height, planes[0].width, planes[0].rowBytes };
+    unsigned char *destPlanarBuffers[3] = { planarBuffer, planarBuffer + planeSize, planarBuffer + planeSize * 2 };
 
     switch ([self pixelFormat])
     {
         case kCVPixelFormatType_24RGB:
-            vImageConvert_RGB888toPlanar8(&sourceRGBBuffer, &destPlanarBuffers[0], &destPlanarBuffers[1], &destPlanarBuffers[2], kvImageNoFlags);
+        {
+            unsigned char *channelPlanes[3] = { destPlanarBuffers[0], destPlanarBuffers[1], destPlanarBuffers[2] };
+            pixelConvertRGB888ToPlanar8(planes[0].data, planes[0].rowBytes, channelPlanes, width, width, height);
             break;
+        }
         case kCVPixelFormatType_444YpCbCr8:
-            vImageConvert_RGB888toPlanar8(&sourceRGBBuffer, &destPlanarBuffers[2], &destPlanarBuffers[0], &destPlanarBuffers[1], kvImageNoFlags);
+        {
+            unsigned char *channelPlanes[3] = { destPlanarBuffers[2], destPlanarBuffers[0], destPlanarBuffers[1] };
+            pixelConvertRGB888ToPlanar8(planes[0].data, planes[0].rowBytes, channelPlanes, width, width, height);
             break;
+        }
         case kCVPixelFormatType_24BGR:
-            vImageConvert_RGB888toPlanar8(&sourceRGBBuffer, &destPlanarBuffers[2], &destPlanarBuffers[1], &destPlanarBuffers[0], kvImageNoFlags);
+        {
+            unsigned char *channelPlanes[3] = { destPlanarBuffers[2], destPlanarBuffers[1], destPlanarBuffers[0] };
+            pixelConvertRGB888ToPlanar8(planes[0].data, planes[0].rowBytes, channelPlanes, width, width, height);
             break;
+        }
     }
     
     for (int planeIndex = 0 ; planeIndex < 3; planeIndex ++)
     {
-        EEPixelViewerPlane pvPlane = { destPlanarBuffers[planeIndex].data, destPlanarBuffers[planeIndex].height, destPlanarBuffers[planeIndex].width, destPlanarBuffers[planeIndex].rowBytes };
+        EEPixelViewerPlane pvPlane = { destPlanarBuffers[planeIndex], height, width, width };
         [self loadTextureForPlane: &pvPlane forTextureIndex: planeIndex];
-        free (destPlanarBuffers[planeIndex].data);
     }
 }
 
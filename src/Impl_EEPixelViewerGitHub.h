@@ -17,6 +17,7 @@
     UInt8* pixelBuffer;
     UInt8 counter;
     long long startingMilliseconds;
+    BOOL softwareRendering; // The universe is drawn into the pixel buffer instead of the test pattern
 }
 
 - (id)initWithFrame:(CGRect)rect pixelBufferWidth:(size_t)width pixelBufferHeight:(size_t)height;
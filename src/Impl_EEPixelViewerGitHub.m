@@ -1,4 +1,7 @@
 #import "Impl_EEPixelViewerGitHub.h"
+#include "rendering/pixel_view.h"
+
+#define PIXEL_VIEW_SCENE_PATH "Scenes/default.scene"
 
 #include <stdint.h>
 typedef struct Color {
@@ -33,6 +36,13 @@ typedef struct Color {
         long long milliseconds = (long long)([[NSDate date] timeIntervalSince1970] * 1000.0); // https://stackoverflow.com/questions/6150422/get-current-date-in-milliseconds
         startingMilliseconds = milliseconds;
         
+#if !defined(USE_HASKELL_EXPORTS) && !defined(USE_ALPHA)
+        // The software renderer fills RGB pixels
+        softwareRendering = pixelViewStart(PIXEL_VIEW_SCENE_PATH) != 0;
+#else
+        softwareRendering = NO;
+#endif
+        
         [self setupShadersForCropAndScaling];
         
         [self setupDisplayLink];
@@ -43,6 +53,7 @@ typedef struct Color {
 
 - (void)dealloc {
     CVDisplayLinkStop(displayLink);
+    if (softwareRendering) pixelViewStop();
     free(pixelBuffer);
 }
 
@@ -91,10 +102,17 @@ static CVReturn renderCallback(CVDisplayLinkRef displayLink,
     long long t = milliseconds - startingMilliseconds;
     fillPixelBuffer(pixelBuffer, t);
 #else
-    // Greyscale test
-    size_t size = plane.rowBytes * plane.height;
-    for(size_t ui = 0; ui < size; ui++) {
-        self->pixelBuffer[ui] = 1+ui+counter;
+    if (softwareRendering) {
+        long long milliseconds = (long long)([[NSDate date] timeIntervalSince1970] * 1000.0);
+        double t = (milliseconds - startingMilliseconds) / 1000.0;
+        pixelViewRender(pixelBuffer, (int)plane.width, (int)plane.height, plane.rowBytes, t);
+    }
+    else {
+        // Greyscale test
+        size_t size = plane.rowBytes * plane.height;
+        for(size_t ui = 0; ui < size; ui++) {
+            self->pixelBuffer[ui] = 1+ui+counter;
+        }
     }
 #endif
     
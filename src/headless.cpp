@@ -0,0 +1,101 @@
+#include "headless.h"
+#include "universe/scene_loader.h"
+#include "universe/checkpoint.h"
+
+#include <iostream>
+#include <cstring>
+#include <cstdlib>
+#include <chrono>
+
+namespace headless {
+	volatile std::sig_atomic_t interrupted = 0;
+
+	void onInterrupt(int) {
+		interrupted = 1;
+	}
+
+	void catchInterrupts() {
+		std::signal(SIGINT, onInterrupt);
+		std::signal(SIGTERM, onInterrupt);
+	}
+
+	bool parseArgument(int argc, char** argv, int& i, Options& options) {
+		bool hasValue = i + 1 < argc;
+
+		if (strcmp(argv[i], "--scene") == 0 && hasValue) options.scenePath = argv[++i];
+		else if (strcmp(argv[i], "--ticks") == 0 && hasValue) options.tickLimit = std::strtoull(argv[++i], nullptr, 10);
+		else if (strcmp(argv[i], "--checkpoint") == 0 && hasValue) options.checkpointPath = argv[++i];
+		else if (strcmp(argv[i], "--checkpoint-interval") == 0 && hasValue) options.checkpointInterval = std::strtoull(argv[++i], nullptr, 10);
+		else if (strcmp(argv[i], "--resume") == 0) options.resume = true;
+		else return false;
+
+		return true;
+	}
+
+	void printUsage() {
+		std::cout << "  --scene <path>                Scene to simulate (default: " << DEFAULT_SCENE_PATH << ")" << std::endl
+			<< "  --ticks <count>               Headless only: stop once the run reaches this tick" << std::endl
+			<< "  --checkpoint <path>           Headless only: where checkpoints are saved (default: " << DEFAULT_CHECKPOINT_PATH << ")" << std::endl
+			<< "  --checkpoint-interval <ticks> Headless only: ticks between two checkpoints, 0 to disable them" << std::endl
+			<< "  --resume                      Continue from the checkpoint if there is one" << std::endl;
+	}
+
+	Universe* loadStartingUniverse(const Options& options, unsigned long long& tick) {
+		tick = 0;
+
+		if (options.resume) {
+			std::ifstream checkpointFile(options.checkpointPath);
+			if (checkpointFile.good()) {
+				checkpointFile.close();
+
+				Universe* universe = checkpoint::load(options.checkpointPath, tick);
+				if (universe != nullptr) {
+					std::cout << "Resuming from '" << options.checkpointPath << "' at tick " << tick << "." << std::endl;
+					return universe;
+				}
+
+				// Don't silently start over from the scene and overwrite the checkpoint with it
+				return nullptr;
+			}
+
+			std::cout << "No checkpoint at '" << options.checkpointPath << "', starting from the scene." << std::endl;
+		}
+
+		return loadScene(options.scenePath.c_str());
+	}
+
+	int run(const Options& options) {
+		unsigned long long tick;
+		Universe* universe = loadStartingUniverse(options, tick);
+		if (universe == nullptr) return 1;
+
+		catchInterrupts();
+
+		const double tickDuration = std::chrono::duration<double>(1.0 / SIMULATION_TICK_RATE).count();
+		unsigned long long firstTick = tick;
+		unsigned long long savedTick = tick; // Last tick that has a checkpoint (a resumed one already has)
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+		while (!interrupted && (options.tickLimit == 0 || tick < options.tickLimit)) {
+			universe->tick(tickDuration);
+			tick++;
+
+			if (options.checkpointInterval > 0 && tick % options.checkpointInterval == 0 && checkpoint::save(universe, tick, options.checkpointPath)) {
+				savedTick = tick;
+			}
+		}
+
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		std::cout << (interrupted ? "Interrupted" : "Stopped") << " at tick " << tick << " (" << (tick - firstTick) / seconds << " ticks per second)." << std::endl;
+
+		// The last state is always kept, so a preempted run loses nothing
+		if (options.checkpointInterval > 0 && tick != savedTick) {
+			checkpoint::wait();
+			checkpoint::save(universe, tick, options.checkpointPath);
+		}
+		checkpoint::wait();
+
+		delete universe;
+		return 0;
+	}
+}
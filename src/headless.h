@@ -0,0 +1,35 @@
+#pragma once
+
+#include <string>
+#include <csignal>
+
+#include "universe/universe.h"
+#include "universe/simulation.h"
+
+#define DEFAULT_SCENE_PATH "Scenes/default.scene"
+#define DEFAULT_CHECKPOINT_PATH "checkpoint.scene"
+#define DEFAULT_CHECKPOINT_INTERVAL (SIMULATION_TICK_RATE * 600) // Ticks between two checkpoints of a headless run (10 simulated minutes)
+
+// Simulation runs without a window. Nothing here depends on OpenGL, so it is shared by the simulator (--headless) and the
+// headless build (src/headless_main.cpp, "make headless") for machines without a GPU
+namespace headless {
+	struct Options {
+		std::string scenePath = DEFAULT_SCENE_PATH;
+		unsigned long long tickLimit = 0; // Headless runs stop after this many ticks (counted from the start of the run, before any resume), 0 to run until interrupted
+		std::string checkpointPath = DEFAULT_CHECKPOINT_PATH;
+		unsigned long long checkpointInterval = DEFAULT_CHECKPOINT_INTERVAL; // 0 disables the checkpoints
+		bool resume = false; // Start from the checkpoint instead of the scene if there is one
+	};
+
+	extern volatile std::sig_atomic_t interrupted; // Set by SIGINT and SIGTERM once catchInterrupts() has been called
+	void catchInterrupts();
+
+	// Parses argv[i] (and moves i past its value) if it is one of the options above, returns false if it isn't
+	bool parseArgument(int argc, char** argv, int& i, Options& options);
+	void printUsage(); // Lines of the options above
+
+	// The universe to start from and the tick it is at
+	Universe* loadStartingUniverse(const Options& options, unsigned long long& tick);
+	// Ticks the universe on this thread, as fast as possible, exactly like the simulation thread does
+	int run(const Options& options);
+}
@@ -0,0 +1,21 @@
+#include "headless.h"
+
+#include <iostream>
+#include <cstring>
+
+// Entry point of the headless build ("make headless"): same command line as the simulator's --headless mode, without any OpenGL dependency
+int main(int argc, char** argv) {
+	headless::Options options;
+
+	for (int i = 1; i < argc; i++) {
+		if (headless::parseArgument(argc, argv, i, options)) continue;
+		if (strcmp(argv[i], "--headless") == 0) continue; // Implied
+
+		std::cout << "[ERROR] Unknown or incomplete option '" << argv[i] << "'." << std::endl;
+		std::cout << "Usage: " << argv[0] << " [options]" << std::endl;
+		headless::printUsage();
+		return 1;
+	}
+
+	return headless::run(options);
+}
@@ -0,0 +1,180 @@
+#include "headless.h"
+#include "offscreen.h"
+#include "rendering/renderer.h"
+#include "rendering/software_renderer.h"
+#include "rendering/plane_presenter.h"
+
+#include <iostream>
+#include <string>
+#include <cstring>
+#include <cstdlib>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <algorithm>
+
+struct Options {
+	headless::Options run; // Scene, checkpoint and tick limit
+	bool headless = false;
+	offscreen::Options offscreen; // Render the run into images or a video stream instead of a window
+};
+
+void printUsage(const char* program) {
+	std::cout << "Usage: " << program << " [options]" << std::endl
+		<< "  --headless                    Simulate as fast as possible without a window" << std::endl;
+	headless::printUsage();
+	offscreen::printUsage();
+	std::cout << "  --software                    Render on the CPU: offscreen without OpenGL (for machines without a GPU), or in a window that only shows the frames" << std::endl;
+}
+
+bool parseArguments(int argc, char** argv, Options& options) {
+	bool valid = true;
+
+	for (int i = 1; i < argc && valid; i++) {
+		if (headless::parseArgument(argc, argv, i, options.run)) continue;
+		if (offscreen::parseArgument(argc, argv, i, options.offscreen, valid)) continue;
+
+		if (strcmp(argv[i], "--headless") == 0) options.headless = true;
+		else if (strcmp(argv[i], "--software") == 0) options.offscreen.capture.software = true;
+		else {
+			std::cout << "[ERROR] Unknown or incomplete option '" << argv[i] << "'." << std::endl;
+			return false;
+		}
+	}
+	if (!valid) return false;
+
+	if (options.headless && options.offscreen.enabled) {
+		std::cout << "[ERROR] --headless doesn't render anything, it can't be combined with --render." << std::endl;
+		return false;
+	}
+	if (options.headless && options.offscreen.capture.software) {
+		std::cout << "[ERROR] --headless doesn't render anything, it can't be combined with --software." << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+int runWindowed(const Options& options) {
+	unsigned long long tick;
+	Universe* universe = headless::loadStartingUniverse(options.run, tick);
+	if (universe == nullptr) return 1;
+
+	if (renderer::init() < 0) {
+		std::cout << "[ERROR] Could not create the window." << std::endl;
+		delete universe;
+		return 1;
+	}
+
+	renderer::setUniverse(universe);
+	ui::setupUIPanels();
+
+	while (!glfwWindowShouldClose(renderer::getWindow())) {
+		renderer::renderAll();
+	}
+
+	ui::disposeUI();
+	renderer::terminate();
+	return 0;
+}
+
+// Renders a frame every few ticks, as fast as possible, into the capture output
+int runOffscreen(const Options& options) {
+	unsigned long long tick;
+	Universe* universe = headless::loadStartingUniverse(options.run, tick);
+	if (universe == nullptr) return 1;
+
+	const offscreen::Options& render = options.offscreen;
+	if (renderer::init(render.capture.width, render.capture.height) < 0) {
+		std::cout << "[ERROR] Could not create an OpenGL context." << std::endl;
+		delete universe;
+		return 1;
+	}
+
+	if (!renderer::capture::start(render.capture) || !renderer::capture::readback::start()) {
+		delete universe;
+		renderer::terminate();
+		return 1;
+	}
+
+	renderer::setUniverse(universe, false);
+
+	headless::catchInterrupts();
+
+	unsigned int ticksPerFrame = offscreen::getTicksPerFrame(render.capture.frameRate);
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	unsigned long long frame = 0;
+	while (!headless::interrupted && (render.frameLimit == 0 || frame < render.frameLimit)) {
+		simulation::step(ticksPerFrame);
+		renderer::renderAll();
+		frame++;
+	}
+
+	renderer::terminate(); // Writes the last frames
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	std::cout << "Rendered " << renderer::capture::getWrittenFrameCount() << " frames (" << frame / seconds << " frames per second)." << std::endl;
+
+	return 0;
+}
+
+// Shows the frames of the software renderer in a window, at the size of the window, while the simulation runs in real time
+int runSoftwareWindowed(const Options& options) {
+	unsigned long long tick;
+	Universe* universe = headless::loadStartingUniverse(options.run, tick);
+	if (universe == nullptr) return 1;
+
+	if (!renderer::planePresenter::init(1280, 720, "Gravity Simulator 3D (software)")) {
+		std::cout << "[ERROR] Could not create the window." << std::endl;
+		delete universe;
+		return 1;
+	}
+	renderer::planePresenter::setPixelFormat(renderer::planePresenter::PixelFormat::RGB24);
+
+	simulation::start(universe);
+
+	renderer::SoftwareRenderer softwareRenderer;
+	renderer::FrameScene scene;
+	std::vector<uint8_t> pixels;
+
+	while (!glfwWindowShouldClose(renderer::planePresenter::getWindow())) {
+		int width, height;
+		glfwGetFramebufferSize(renderer::planePresenter::getWindow(), &width, &height);
+		if (width <= 0 || height <= 0) { // Minimized
+			glfwWaitEvents();
+			continue;
+		}
+		pixels.resize((size_t)width * height * 3);
+
+		simulation::acquireSnapshot();
+		const simulation::Snapshot& snapshot = simulation::getSnapshot();
+
+		glm::vec3 focus = snapshot.bodies.empty() ? glm::vec3(0) : snapshot.bodies[0].position;
+		glm::mat4 projection = renderer::getProjection(glm::radians(45.0f), (float)width / height);
+		renderer::buildFrameScene(snapshot, renderer::getOrbitView(focus, FRAME_CAMERA_DISTANCE, 0.0f), projection, scene);
+		softwareRenderer.render(scene, pixels.data(), width, height, (size_t)width * 3);
+
+		renderer::planePresenter::Plane plane = { pixels.data(), height, width, (size_t)width * 3 };
+		renderer::planePresenter::present(&plane, 1);
+	}
+
+	simulation::stop();
+	renderer::planePresenter::terminate();
+	return 0;
+}
+
+int main(int argc, char** argv) {
+	Options options;
+	if (!parseArguments(argc, argv, options)) {
+		printUsage(argv[0]);
+		return 1;
+	}
+
+	if (options.offscreen.enabled && options.offscreen.capture.output != renderer::capture::Output::PNG) {
+		if (!renderer::capture::takeStdout()) return 1; // stdout carries the frames, messages go to stderr
+	}
+
+	if (options.headless) return headless::run(options.run);
+	if (options.offscreen.capture.software) return options.offscreen.enabled ? offscreen::runSoftware(options.run, options.offscreen) : runSoftwareWindowed(options);
+	return options.offscreen.enabled ? runOffscreen(options) : runWindowed(options);
+}
@@ -0,0 +1,107 @@
+#include "offscreen.h"
+#include "rendering/frame_scene.h"
+#include "rendering/software_renderer.h"
+
+#include <iostream>
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+#include <chrono>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+namespace offscreen {
+	bool parseArgument(int argc, char** argv, int& i, Options& options, bool& valid) {
+		bool hasValue = i + 1 < argc;
+
+		if (strcmp(argv[i], "--render") == 0 && hasValue) {
+			options.enabled = true;
+			options.capture.output = renderer::capture::Output::PNG;
+			options.capture.pathPattern = argv[++i];
+		}
+		else if (strcmp(argv[i], "--render-raw") == 0 && hasValue) {
+			options.enabled = true;
+			i++;
+			if (strcmp(argv[i], "rgb") == 0) options.capture.output = renderer::capture::Output::RawRGB;
+			else if (strcmp(argv[i], "yuv") == 0) options.capture.output = renderer::capture::Output::RawYUV;
+			else {
+				std::cout << "[ERROR] Unknown raw format '" << argv[i] << "'." << std::endl;
+				valid = false;
+			}
+		}
+		else if (strcmp(argv[i], "--resolution") == 0 && hasValue) {
+			if (sscanf(argv[++i], "%dx%d", &options.capture.width, &options.capture.height) != 2) {
+				std::cout << "[ERROR] Invalid resolution '" << argv[i] << "'." << std::endl;
+				valid = false;
+			}
+		}
+		else if (strcmp(argv[i], "--fps") == 0 && hasValue) options.capture.frameRate = (unsigned int)std::strtoul(argv[++i], nullptr, 10);
+		else if (strcmp(argv[i], "--frames") == 0 && hasValue) options.frameLimit = std::strtoull(argv[++i], nullptr, 10);
+		else return false;
+
+		return true;
+	}
+
+	void printUsage() {
+		std::cout << "  --render <path pattern>       Render offscreen into PNG images (e.g. frames/%06d.png)" << std::endl
+			<< "  --render-raw <rgb|yuv>        Render offscreen into raw RGB24 or YUV 4:2:0 (BT.709) frames on stdout, for a video encoder" << std::endl
+			<< "  --resolution <width>x<height> Offscreen only: size of the frames (default: 1920x1080)" << std::endl
+			<< "  --fps <rate>                  Offscreen only: frames per second of simulated time (default: 60)" << std::endl
+			<< "  --frames <count>              Offscreen only: stop after this many frames" << std::endl;
+	}
+
+	unsigned int getTicksPerFrame(unsigned int frameRate) {
+		unsigned int ticksPerFrame = (unsigned int)std::max(1.0, std::round((double)SIMULATION_TICK_RATE / frameRate));
+		if (ticksPerFrame * frameRate != SIMULATION_TICK_RATE) {
+			std::cout << "[WARNING] " << SIMULATION_TICK_RATE << " ticks per second can't be split evenly into " << frameRate
+				<< " frames per second, the video will play at " << (double)SIMULATION_TICK_RATE / ticksPerFrame / frameRate << "x speed." << std::endl;
+		}
+		return ticksPerFrame;
+	}
+
+	int runSoftware(const headless::Options& runOptions, const Options& options) {
+		unsigned long long tick;
+		Universe* universe = headless::loadStartingUniverse(runOptions, tick);
+		if (universe == nullptr) return 1;
+
+		if (!renderer::capture::start(options.capture)) {
+			delete universe;
+			return 1;
+		}
+
+		simulation::start(universe, false);
+
+		headless::catchInterrupts();
+
+		unsigned int ticksPerFrame = getTicksPerFrame(options.capture.frameRate);
+
+		int width = options.capture.width, height = options.capture.height;
+		renderer::SoftwareRenderer softwareRenderer;
+		renderer::FrameScene scene;
+		std::vector<uint8_t> pixels((size_t)width * height * 3);
+		glm::mat4 projection = renderer::getProjection(glm::radians(45.0f), (float)width / height);
+
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		unsigned long long frame = 0;
+		while (!headless::interrupted && (options.frameLimit == 0 || frame < options.frameLimit)) {
+			simulation::step(ticksPerFrame);
+			simulation::acquireSnapshot();
+			const simulation::Snapshot& snapshot = simulation::getSnapshot();
+
+			// The starting view of the window, which follows the first body
+			glm::vec3 focus = snapshot.bodies.empty() ? glm::vec3(0) : snapshot.bodies[0].position;
+			renderer::buildFrameScene(snapshot, renderer::getOrbitView(focus, FRAME_CAMERA_DISTANCE, 0.0f), projection, scene);
+			softwareRenderer.render(scene, pixels.data(), width, height, (size_t)width * 3);
+			renderer::capture::submitFrame(pixels.data(), (size_t)width * 3);
+			frame++;
+		}
+
+		renderer::capture::stop(); // Writes the last frames
+		simulation::stop();
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		std::cout << "Rendered " << renderer::capture::getWrittenFrameCount() << " frames (" << frame / seconds << " frames per second)." << std::endl;
+
+		return 0;
+	}
+}
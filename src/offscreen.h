@@ -0,0 +1,24 @@
+#pragma once
+
+#include "headless.h"
+#include "rendering/frame_capture.h"
+
+// Runs rendered into images or a video stream instead of a window. Nothing here depends on OpenGL, so the software rendered runs are
+// shared by the simulator (--software --render) and the software build (src/software_main.cpp, "make software") for machines without a GPU
+namespace offscreen {
+	struct Options {
+		bool enabled = false; // --render or --render-raw was given
+		renderer::capture::Settings capture;
+		unsigned long long frameLimit = 0; // Offscreen runs stop after this many frames, 0 to run until interrupted
+	};
+
+	// Parses argv[i] (and moves i past its value) if it is one of the options above, returns false if it isn't.
+	// An invalid value is reported and sets valid to false
+	bool parseArgument(int argc, char** argv, int& i, Options& options, bool& valid);
+	void printUsage(); // Lines of the options above
+
+	// Simulation ticks between two frames
+	unsigned int getTicksPerFrame(unsigned int frameRate);
+	// Renders a frame every few ticks with the software renderer, as fast as possible, into the capture output
+	int runSoftware(const headless::Options& runOptions, const Options& options);
+}
@@ -40,25 +40,18 @@ static const GLfloat g_vertex_buffer_data[] = {
 	1.0f,-1.0f, 1.0f
 };
 
-static const GLuint g_index_buffer_data[] = {
-	0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35
-};
-
 Cube::Cube() {
-	this->normals = new glm::vec3[sizeof(g_vertex_buffer_data) / 3];
+	const int cubeVertexCount = sizeof(g_vertex_buffer_data) / sizeof(g_vertex_buffer_data[0]) / 3;
 
-	this->vertexCount = sizeof(g_vertex_buffer_data) / sizeof(g_vertex_buffer_data[0]) / 3;
-	this->indexCount = sizeof(g_index_buffer_data) / sizeof(g_index_buffer_data[0]);
-	this->vertexData = &g_vertex_buffer_data[0];
-	this->indexData = &g_index_buffer_data[0];
-	this->normalData = normals;
+	// Every triangle has its own vertices so that its normal can be flat
+	std::vector<ModelVertex> vertices(cubeVertexCount);
+	std::vector<GLushort> indices(cubeVertexCount);
+	for (int i = 0; i < cubeVertexCount; i++) {
+		vertices[i].position = glm::vec3(g_vertex_buffer_data[i * 3], g_vertex_buffer_data[i * 3 + 1], g_vertex_buffer_data[i * 3 + 2]);
+		indices[i] = i;
+	}
 
-	calculateNormals();
+	calculateFlatNormals(vertices);
 
-	init();
+	upload(vertices, indices);
 }
-
-Cube::~Cube() {
-	dispose();
-	delete[] normals;
-}
\ No newline at end of file
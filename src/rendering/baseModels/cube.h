@@ -4,10 +4,7 @@
 
 class Cube : public RenderModel
 {
-protected:
-	glm::vec3* normals;
 public: 
 	Cube();
-	~Cube();
 };
 
@@ -1,72 +1,83 @@
 #include "sphere.h"
 
 #include <iostream>
+#include <unordered_map>
 
-Sphere::Sphere(int resolution, float radius) {
-    std::vector<glm::vec3> vertices;
+// Returns the index of the vertex halfway between a and b (normalized onto the sphere), creating it if no other triangle did so already
+static GLushort getMidpoint(GLushort a, GLushort b, std::vector<ModelVertex>& vertices, std::unordered_map<unsigned int, GLushort>& midpointCache) {
+    unsigned int key = a < b ? (a << 16 | b) : (b << 16 | a);
 
-    for (int i = 0; i < resolution / 2; i++) {
-        for (int j = 0; j < resolution; j++) {
-            float iRads = (float)i / resolution * glm::two_pi<float>();
-            float jRads = (float)j / resolution * glm::two_pi<float>();
+    auto cached = midpointCache.find(key);
+    if (cached != midpointCache.end()) return cached->second;
 
-            float x = std::sin(jRads) * std::sin(iRads);
-            float y = std::cos(iRads);
-            float z = std::cos(jRads) * std::sin(iRads);
+    glm::vec3 position = glm::normalize(vertices[a].position + vertices[b].position);
+    vertices.push_back({ position, position });
 
-            vertices.push_back(glm::vec3(x, y, z) * radius);
-        }
-    }
-
-    // Bottom vertex
-    vertices.push_back(glm::vec3(0, -radius, 0));
+    GLushort index = vertices.size() - 1;
+    midpointCache[key] = index;
 
-    this->vertexCount = vertices.size();
-
-    for (int i = 0; i < resolution * ((resolution - 2) / 2); i++) {
-        indices.push_back(i);
-        indices.push_back(i + resolution - 1);
-        indices.push_back(i + resolution);
+    return index;
+}
 
-        indices.push_back(i + resolution);
-        indices.push_back(i + 1);
-        indices.push_back(i);
+void generateIcosphere(int subdivisions, std::vector<ModelVertex>& vertices, std::vector<GLushort>& indices) {
+    if (subdivisions > MAX_SPHERE_SUBDIVISIONS) {
+        std::cout << "[WARNING] Sphere subdivisions clamped from " << subdivisions << " to " << MAX_SPHERE_SUBDIVISIONS << "." << std::endl;
+        subdivisions = MAX_SPHERE_SUBDIVISIONS;
     }
 
-    // Bottom faces
-    for (int i = 0; i < resolution - 1; i++) {
-        indices.push_back(vertexCount - 1);
-        indices.push_back(vertexCount - 1 - resolution + i + 1);
-        indices.push_back(vertexCount - 1 - resolution + i);
+    // Icosahedron
+    const float t = (1.0f + std::sqrt(5.0f)) / 2.0f;
+    const glm::vec3 icosahedronVertices[] = {
+        glm::vec3(-1,  t,  0), glm::vec3( 1,  t,  0), glm::vec3(-1, -t,  0), glm::vec3( 1, -t,  0),
+        glm::vec3( 0, -1,  t), glm::vec3( 0,  1,  t), glm::vec3( 0, -1, -t), glm::vec3( 0,  1, -t),
+        glm::vec3( t,  0, -1), glm::vec3( t,  0,  1), glm::vec3(-t,  0, -1), glm::vec3(-t,  0,  1)
+    };
+    const GLushort icosahedronIndices[] = {
+        0, 11, 5,    0, 5, 1,    0, 1, 7,    0, 7, 10,   0, 10, 11,
+        1, 5, 9,     5, 11, 4,   11, 10, 2,  10, 7, 6,   7, 1, 8,
+        3, 9, 4,     3, 4, 2,    3, 2, 6,    3, 6, 8,    3, 8, 9,
+        4, 9, 5,     2, 4, 11,   6, 2, 10,   8, 6, 7,    9, 8, 1
+    };
+
+    size_t finalVertexCount = 10 * ((size_t)1 << (2 * subdivisions)) + 2;
+    vertices.clear();
+    vertices.reserve(finalVertexCount);
+    for (const glm::vec3& vertex : icosahedronVertices) {
+        glm::vec3 position = glm::normalize(vertex);
+        vertices.push_back({ position, position }); // On a unit sphere, the normal is the position
     }
 
-    // Last triangle
-    indices.push_back(vertexCount - resolution - 1);
-    indices.push_back(vertexCount - 2);
-    indices.push_back(vertexCount - 1);
+    indices.assign(std::begin(icosahedronIndices), std::end(icosahedronIndices));
+
+    // Split every triangle into 4, reusing the midpoints shared with the neighbouring triangles
+    for (int level = 0; level < subdivisions; level++) {
+        std::unordered_map<unsigned int, GLushort> midpointCache;
+        std::vector<GLushort> subdividedIndices;
+        subdividedIndices.reserve(indices.size() * 4);
+
+        for (unsigned int i = 0; i < indices.size(); i += 3) {
+            GLushort a = indices[i], b = indices[i + 1], c = indices[i + 2];
+            GLushort ab = getMidpoint(a, b, vertices, midpointCache);
+            GLushort bc = getMidpoint(b, c, vertices, midpointCache);
+            GLushort ca = getMidpoint(c, a, vertices, midpointCache);
+
+            subdividedIndices.insert(subdividedIndices.end(), {
+                a, ab, ca,
+                b, bc, ab,
+                c, ca, bc,
+                ab, bc, ca
+            });
+        }
 
-    for (int i = 0; i < vertexCount; i++) {
-        glm::vec3 vertex = vertices[i];
-        vertexDataVector.push_back(vertex.x);
-        vertexDataVector.push_back(vertex.y);
-        vertexDataVector.push_back(vertex.z);
+        indices.swap(subdividedIndices);
     }
+}
 
-    this->normals = new glm::vec3[vertexCount];
-
-    this->indexCount = indices.size();
-    this->vertexData = &vertexDataVector[0];
-    this->indexData = &indices[0];
-    this->normalData = normals;
+Sphere::Sphere(int subdivisions) {
+    std::vector<ModelVertex> vertices;
+    std::vector<GLushort> indices;
 
-    for (int i = 0; i < vertexCount; i++) {
-        normals[i] = glm::normalize(vertices[i]);
-    }
-
-    init();
-}
+    generateIcosphere(subdivisions, vertices, indices);
 
-Sphere::~Sphere() {
-    dispose();
-    delete[] normals;
+    upload(vertices, indices);
 }
@@ -3,14 +3,15 @@
 #include <vector>
 #include <glm/gtc/matrix_transform.hpp>
 
+// An icosphere has 10 * 4^n + 2 vertices, so 6 subdivisions is the most that still fits in 16-bit indices
+#define MAX_SPHERE_SUBDIVISIONS 6
+
+// Builds a unit icosphere where every vertex is shared by all the triangles around it
+void generateIcosphere(int subdivisions, std::vector<ModelVertex>& vertices, std::vector<GLushort>& indices);
+
 class Sphere : public RenderModel
 {
-protected:
-	std::vector<GLfloat> vertexDataVector;
-	std::vector<GLuint> indices;
-	glm::vec3* normals;
 public:
-	Sphere(int resolution, float radius);
-	~Sphere();
+	Sphere(int subdivisions);
 };
 
@@ -0,0 +1,141 @@
+#include "bloom.h"
+#include "renderer.h"
+
+namespace renderer {
+	namespace bloom {
+		BloomShaders shaders;
+
+		GLuint FramebufferID;
+
+		int levelCount;
+		int levelWidths[BLOOM_MAX_LEVELS];
+		int levelHeights[BLOOM_MAX_LEVELS];
+		GLuint LevelTextureIDs[BLOOM_MAX_LEVELS]; // Mip pyramid
+		GLuint TempTextureIDs[BLOOM_MAX_LEVELS]; // Holds the horizontally blurred level before the vertical pass
+
+		GLuint createLevelTexture(int width, int height) {
+			GLuint textureID;
+			glGenTextures(1, &textureID);
+			glBindTexture(GL_TEXTURE_2D, textureID);
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_R11F_G11F_B10F, width, height, 0, GL_RGB, GL_FLOAT, NULL);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+			return textureID;
+		}
+
+		void createLevels(int width, int height) {
+			levelCount = 0;
+
+			int levelWidth = width / 2;
+			int levelHeight = height / 2;
+			while (levelCount < BLOOM_MAX_LEVELS && levelWidth >= BLOOM_MIN_LEVEL_SIZE && levelHeight >= BLOOM_MIN_LEVEL_SIZE) {
+				levelWidths[levelCount] = levelWidth;
+				levelHeights[levelCount] = levelHeight;
+				LevelTextureIDs[levelCount] = createLevelTexture(levelWidth, levelHeight);
+				TempTextureIDs[levelCount] = createLevelTexture(levelWidth, levelHeight);
+
+				levelCount++;
+				levelWidth /= 2;
+				levelHeight /= 2;
+			}
+
+			glBindTexture(GL_TEXTURE_2D, 0);
+		}
+
+		void deleteLevels() {
+			glDeleteTextures(levelCount, LevelTextureIDs);
+			glDeleteTextures(levelCount, TempTextureIDs);
+			levelCount = 0;
+		}
+
+		void init(int width, int height) {
+			shaders.DownsampleProgramID = LoadShaderProgram("shaders/bloom/vertexShader.glsl", "shaders/bloom/downsampleFragmentShader.glsl");
+			shaders.BlurProgramID = LoadShaderProgram("shaders/bloom/vertexShader.glsl", "shaders/bloom/blurFragmentShader.glsl");
+			shaders.UpsampleProgramID = LoadShaderProgram("shaders/bloom/vertexShader.glsl", "shaders/bloom/upsampleFragmentShader.glsl");
+
+			shaders.DownsampleSourceTextureUniformID = glGetUniformLocation(shaders.DownsampleProgramID, "SourceTexture");
+			shaders.DownsampleApplyThresholdUniformID = glGetUniformLocation(shaders.DownsampleProgramID, "ApplyThreshold");
+			shaders.DownsampleThresholdUniformID = glGetUniformLocation(shaders.DownsampleProgramID, "Threshold");
+			shaders.BlurSourceTextureUniformID = glGetUniformLocation(shaders.BlurProgramID, "SourceTexture");
+			shaders.BlurDirectionUniformID = glGetUniformLocation(shaders.BlurProgramID, "Direction");
+			shaders.UpsampleSourceTextureUniformID = glGetUniformLocation(shaders.UpsampleProgramID, "SourceTexture");
+
+			glGenFramebuffers(1, &FramebufferID);
+
+			levelCount = 0;
+			createLevels(width, height);
+		}
+
+		void resize(int width, int height) {
+			deleteLevels();
+			createLevels(width, height);
+		}
+
+		// Renders a fullscreen triangle with the currently bound program into the given texture
+		void renderPass(GLuint targetTextureID, GLuint sourceTextureID, int width, int height) {
+			glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, targetTextureID, 0);
+			glViewport(0, 0, width, height);
+
+			glBindTexture(GL_TEXTURE_2D, sourceTextureID);
+			drawFullscreenTriangle();
+		}
+
+		GLuint render(GLuint emissionTextureID) {
+			if (levelCount == 0) return 0;
+
+			glBindFramebuffer(GL_FRAMEBUFFER, FramebufferID);
+			glDrawBuffer(GL_COLOR_ATTACHMENT0);
+			glActiveTexture(GL_TEXTURE0);
+
+			// Step 1: threshold the emission and build the pyramid
+			glUseProgram(shaders.DownsampleProgramID);
+			glUniform1i(shaders.DownsampleSourceTextureUniformID, 0);
+			glUniform1f(shaders.DownsampleThresholdUniformID, BLOOM_THRESHOLD);
+
+			glUniform1i(shaders.DownsampleApplyThresholdUniformID, 1);
+			renderPass(LevelTextureIDs[0], emissionTextureID, levelWidths[0], levelHeights[0]);
+
+			glUniform1i(shaders.DownsampleApplyThresholdUniformID, 0);
+			for (int i = 1; i < levelCount; i++) {
+				renderPass(LevelTextureIDs[i], LevelTextureIDs[i - 1], levelWidths[i], levelHeights[i]);
+			}
+
+			// Step 2: blur every level, horizontally into the temporary texture then vertically back into the level
+			glUseProgram(shaders.BlurProgramID);
+			glUniform1i(shaders.BlurSourceTextureUniformID, 0);
+			for (int i = 0; i < levelCount; i++) {
+				glUniform2f(shaders.BlurDirectionUniformID, 1.0f, 0.0f);
+				renderPass(TempTextureIDs[i], LevelTextureIDs[i], levelWidths[i], levelHeights[i]);
+
+				glUniform2f(shaders.BlurDirectionUniformID, 0.0f, 1.0f);
+				renderPass(LevelTextureIDs[i], TempTextureIDs[i], levelWidths[i], levelHeights[i]);
+			}
+
+			// Step 3: add every level on top of the next bigger one, from the smallest to the biggest
+			glUseProgram(shaders.UpsampleProgramID);
+			glUniform1i(shaders.UpsampleSourceTextureUniformID, 0);
+			glEnable(GL_BLEND);
+			glBlendFunc(GL_ONE, GL_ONE);
+			for (int i = levelCount - 2; i >= 0; i--) {
+				renderPass(LevelTextureIDs[i], LevelTextureIDs[i + 1], levelWidths[i], levelHeights[i]);
+			}
+			glDisable(GL_BLEND);
+
+			glBindTexture(GL_TEXTURE_2D, 0);
+			glViewport(0, 0, windowWidth, windowHeight);
+
+			return LevelTextureIDs[0];
+		}
+
+		void dispose() {
+			deleteLevels();
+			glDeleteFramebuffers(1, &FramebufferID);
+			glDeleteProgram(shaders.DownsampleProgramID);
+			glDeleteProgram(shaders.BlurProgramID);
+			glDeleteProgram(shaders.UpsampleProgramID);
+		}
+	}
+}
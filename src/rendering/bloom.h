@@ -0,0 +1,33 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include "bloom_settings.h"
+
+namespace renderer {
+	namespace bloom {
+		// Shaders used by the bloom passes
+		struct BloomShaders {
+			GLuint DownsampleProgramID;
+			GLuint DownsampleSourceTextureUniformID;
+			GLuint DownsampleApplyThresholdUniformID;
+			GLuint DownsampleThresholdUniformID;
+
+			GLuint BlurProgramID;
+			GLuint BlurSourceTextureUniformID;
+			GLuint BlurDirectionUniformID;
+
+			GLuint UpsampleProgramID;
+			GLuint UpsampleSourceTextureUniformID;
+		};
+
+		void init(int width, int height);
+		void resize(int width, int height); // Must be called when the screen size changes
+
+		// Thresholds the emission texture, blurs it at every level of the pyramid and combines the levels back together.
+		// Returns the texture that contains the final bloom (at half the screen resolution)
+		GLuint render(GLuint emissionTextureID);
+
+		void dispose();
+	}
+}
@@ -0,0 +1,6 @@
+#pragma once
+
+// Shared by the OpenGL bloom (bloom.cpp) and the software renderer, which must not depend on OpenGL
+#define BLOOM_MAX_LEVELS 6 // Number of levels in the mip pyramid (the first one being half the screen resolution)
+#define BLOOM_MIN_LEVEL_SIZE 8 // Levels stop being added once they would be smaller than this (in pixels)
+#define BLOOM_THRESHOLD 0.1f // Emission below this brightness doesn't bloom
@@ -26,6 +26,6 @@ Color::Color() {
 	blue = 1.0f;
 }
 
-int Color::toHex() {
+int Color::toHex() const {
 	return ((int)(red * 255) << 16 | (int)(green * 255) << 8 | (int)(blue * 255));
 }
\ No newline at end of file
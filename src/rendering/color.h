@@ -14,5 +14,5 @@ struct Color {
 	Color();
 	Color(float red, float green, float blue);
 	Color(unsigned int hex);
-	int toHex();
+	int toHex() const;
 };
\ No newline at end of file
@@ -0,0 +1,86 @@
+#include "draw_queue.h"
+
+#include <cstring>
+#include <vector>
+
+namespace renderer {
+	namespace drawQueue {
+		struct QueuedDraw {
+			RenderModel* model;
+			DrawData drawData;
+		};
+
+		GLuint FrameBufferID;
+		GLuint DrawBufferID; // Holds the DrawData of every queued draw, each one starting on a multiple of drawDataStride
+
+		GLint drawDataStride;
+		std::vector<QueuedDraw> queuedDraws;
+		std::vector<unsigned char> drawDataUpload;
+
+		void init() {
+			// Ranges bound with glBindBufferRange must start on a multiple of this alignment
+			GLint alignment;
+			glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+			drawDataStride = ((sizeof(DrawData) + alignment - 1) / alignment) * alignment;
+
+			glGenBuffers(1, &FrameBufferID);
+			glBindBuffer(GL_UNIFORM_BUFFER, FrameBufferID);
+			glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameData), NULL, GL_DYNAMIC_DRAW);
+
+			glGenBuffers(1, &DrawBufferID);
+			glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+			glBindBufferBase(GL_UNIFORM_BUFFER, FRAME_DATA_BINDING, FrameBufferID);
+		}
+
+		void bindUniformBlocks(GLuint programID) {
+			GLuint frameDataIndex = glGetUniformBlockIndex(programID, "FrameData");
+			if (frameDataIndex != GL_INVALID_INDEX) glUniformBlockBinding(programID, frameDataIndex, FRAME_DATA_BINDING);
+
+			GLuint drawDataIndex = glGetUniformBlockIndex(programID, "DrawData");
+			if (drawDataIndex != GL_INVALID_INDEX) glUniformBlockBinding(programID, drawDataIndex, DRAW_DATA_BINDING);
+		}
+
+		void setFrameData(const FrameData& frameData) {
+			glBindBuffer(GL_UNIFORM_BUFFER, FrameBufferID);
+			glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameData), &frameData);
+			glBindBuffer(GL_UNIFORM_BUFFER, 0);
+		}
+
+		void queue(RenderModel* model, const DrawData& drawData) {
+			queuedDraws.push_back({ model, drawData });
+		}
+
+		void flush() {
+			if (queuedDraws.empty()) return;
+
+			drawDataUpload.resize(queuedDraws.size() * drawDataStride);
+			for (unsigned int i = 0; i < queuedDraws.size(); i++) {
+				memcpy(&drawDataUpload[i * drawDataStride], &queuedDraws[i].drawData, sizeof(DrawData));
+			}
+
+			// Orphan the previous buffer so that the upload doesn't have to wait for the last frame's draws
+			glBindBuffer(GL_UNIFORM_BUFFER, DrawBufferID);
+			glBufferData(GL_UNIFORM_BUFFER, drawDataUpload.size(), drawDataUpload.data(), GL_STREAM_DRAW);
+			glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+			for (unsigned int i = 0; i < queuedDraws.size(); i++) {
+				RenderModel* model = queuedDraws[i].model;
+
+				glBindBufferRange(GL_UNIFORM_BUFFER, DRAW_DATA_BINDING, DrawBufferID, i * drawDataStride, sizeof(DrawData));
+
+				// The VAO also holds the index buffer binding
+				glBindVertexArray(model->VertexArrayID);
+				glDrawElements(GL_TRIANGLES, model->GetIndexCount(), GL_UNSIGNED_SHORT, (void*)0);
+			}
+			glBindVertexArray(0);
+
+			queuedDraws.clear();
+		}
+
+		void dispose() {
+			glDeleteBuffers(1, &FrameBufferID);
+			glDeleteBuffers(1, &DrawBufferID);
+		}
+	}
+}
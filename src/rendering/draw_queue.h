@@ -0,0 +1,46 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "render_model.h"
+
+#define FRAME_DATA_BINDING 0 // Uniform buffer binding point of the FrameData block
+#define DRAW_DATA_BINDING 1 // Uniform buffer binding point of the DrawData block
+
+namespace renderer {
+	namespace drawQueue {
+		// Shader state that is the same for every draw of a frame (FrameData block, std140 layout)
+		struct FrameData {
+			glm::mat4 view;
+			glm::mat4 projection;
+			glm::mat4 viewProjection;
+			glm::vec4 light; // xyz = position, w = radius
+			glm::vec4 lightColor;
+			glm::vec4 camera; // xyz = position, w = time
+		};
+
+		// Shader state of a single draw (DrawData block, std140 layout)
+		struct DrawData {
+			glm::mat4 model;
+			glm::vec4 color;
+			glm::ivec4 flags; // x = unlit, y = emissive, z = occluder offset, w = occluder count
+		};
+
+		void init();
+
+		// Makes the FrameData and DrawData blocks of the given program use the bindings above
+		void bindUniformBlocks(GLuint programID);
+
+		// Uploads the frame state and binds it for the rest of the frame
+		void setFrameData(const FrameData& frameData);
+
+		// Queues a model to be drawn by the next flush
+		void queue(RenderModel* model, const DrawData& drawData);
+
+		// Uploads the data of every queued draw in one go and draws them (requires the default shader)
+		void flush();
+
+		void dispose();
+	}
+}
@@ -0,0 +1,280 @@
+#include "frame_capture.h"
+#include "png_writer.h"
+#include "pixel_convert.h"
+
+#include <iostream>
+#include <cstdio>
+#include <cstdint>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <algorithm>
+#include <cstring>
+#include <cctype>
+
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace renderer {
+	namespace capture {
+		bool active = false;
+		Settings settings;
+
+		unsigned long long queuedFrameCount = 0; // Frames handed over to the writer, which also numbers them
+
+		struct Frame {
+			unsigned long long index;
+			std::vector<uint8_t> pixels; // RGBA, bottom row first (as read from OpenGL), or RGB, top row first (software rendered)
+		};
+
+		std::thread writerThread;
+		std::mutex queueMutex;
+		std::condition_variable queueCondition;
+		std::deque<Frame*> queuedFrames;
+		std::vector<Frame*> freeFrames;
+		bool stopping = false;
+		Frame* takenFrame = nullptr; // Between takeFrame and queueFrame
+
+		// Only accessed by the writer thread while capturing
+		std::vector<uint8_t> convertedPixels;
+		std::vector<uint8_t> encodedImage;
+		unsigned long long writtenFrameCount = 0;
+		bool outputFailed = false;
+
+		FILE* frameOutput = nullptr; // Raw outputs: the original stdout, see takeStdout
+
+		// Frames are converted from their top row, however they are stored
+		const uint8_t* getTopRow(const Frame& frame) {
+			if (settings.software) return frame.pixels.data();
+			return frame.pixels.data() + (size_t)(settings.height - 1) * settings.width * 4;
+		}
+
+		ptrdiff_t getRowBytes() {
+			return settings.software ? (ptrdiff_t)settings.width * 3 : -(ptrdiff_t)settings.width * 4;
+		}
+
+		// Flips the image and drops the alpha channel
+		void toRGB(const Frame& frame, std::vector<uint8_t>& rgb) {
+			rgb.resize((size_t)settings.width * settings.height * 3);
+			pixelConvertRGBA8888ToRGB888(getTopRow(frame), getRowBytes(), rgb.data(), (ptrdiff_t)settings.width * 3, settings.width, settings.height);
+		}
+
+		// BT.709 limited range, every chroma sample being the average of 2x2 pixels
+		void toYUV(const Frame& frame, std::vector<uint8_t>& yuv) {
+			size_t pixelCount = (size_t)settings.width * settings.height;
+			yuv.resize(pixelCount * 3 / 2);
+			unsigned char* planes[3] = { yuv.data(), yuv.data() + pixelCount, yuv.data() + pixelCount + pixelCount / 4 };
+			size_t planeRowBytes[3] = { (size_t)settings.width, (size_t)settings.width / 2, (size_t)settings.width / 2 };
+			pixelConvertRGBToYpCbCr(getTopRow(frame), getRowBytes(), settings.software ? 3 : 4, settings.width, settings.height, PIXEL_YPCBCR_420_PLANAR, 0, planes, planeRowBytes);
+		}
+
+		void writeFrame(const Frame& frame) {
+			if (outputFailed) return;
+
+			const std::vector<uint8_t>* pixels = &frame.pixels; // Software rendered frames already are RGB, from the top row
+			if (settings.output == Output::RawYUV) {
+				toYUV(frame, convertedPixels);
+				pixels = &convertedPixels;
+			}
+			else if (!settings.software) {
+				toRGB(frame, convertedPixels);
+				pixels = &convertedPixels;
+			}
+
+			if (settings.output == Output::PNG) {
+				int pathLength = snprintf(nullptr, 0, settings.pathPattern.c_str(), (int)frame.index); // The pattern was checked by isFramePattern
+				std::vector<char> path(pathLength + 1);
+				snprintf(path.data(), path.size(), settings.pathPattern.c_str(), (int)frame.index);
+				outputFailed = !png::write(path.data(), pixels->data(), settings.width, settings.height);
+			}
+			else {
+				if (fwrite(pixels->data(), 1, pixels->size(), frameOutput) != pixels->size()) {
+					std::cout << "[ERROR] Couldn't write the frame to the output stream (was it closed?)." << std::endl;
+					outputFailed = true;
+				}
+			}
+
+			if (!outputFailed) writtenFrameCount++;
+		}
+
+		void runWriter() {
+			std::unique_lock<std::mutex> lock(queueMutex);
+
+			while (true) {
+				queueCondition.wait(lock, []() { return stopping || !queuedFrames.empty(); });
+				if (queuedFrames.empty()) break; // Stopping, and everything was written
+
+				Frame* frame = queuedFrames.front();
+				queuedFrames.pop_front();
+
+				lock.unlock();
+				writeFrame(*frame);
+				lock.lock();
+
+				freeFrames.push_back(frame);
+				queueCondition.notify_all(); // The render thread may be waiting for a free frame
+			}
+
+			if (frameOutput != nullptr) fflush(frameOutput);
+		}
+
+		// Waits until the writer is done with a frame if they are all queued
+		Frame* takeFreeFrame() {
+			std::unique_lock<std::mutex> lock(queueMutex);
+			queueCondition.wait(lock, []() { return !freeFrames.empty(); });
+			Frame* frame = freeFrames.back();
+			freeFrames.pop_back();
+			return frame;
+		}
+
+		void pushFrame(Frame* frame) {
+			{
+				std::lock_guard<std::mutex> lock(queueMutex);
+				queuedFrames.push_back(frame);
+			}
+			queueCondition.notify_all();
+		}
+
+		// True if the pattern has exactly one printf conversion and it takes an int (%d or %i, with flags, width and precision). %% is a literal %
+		static bool isFramePattern(const std::string& pattern) {
+			int conversionCount = 0;
+
+			for (size_t i = 0; i < pattern.size(); i++) {
+				if (pattern[i] != '%') continue;
+				if (++i < pattern.size() && pattern[i] == '%') continue;
+
+				while (i < pattern.size() && strchr("-+ #0", pattern[i]) != nullptr) i++;
+				while (i < pattern.size() && isdigit((unsigned char)pattern[i])) i++;
+				if (i < pattern.size() && pattern[i] == '.') {
+					i++;
+					while (i < pattern.size() && isdigit((unsigned char)pattern[i])) i++;
+				}
+
+				if (i >= pattern.size() || (pattern[i] != 'd' && pattern[i] != 'i')) return false;
+				conversionCount++;
+			}
+
+			return conversionCount == 1;
+		}
+
+		bool takeStdout() {
+			if (frameOutput != nullptr) return true;
+
+			fflush(stdout);
+#ifdef _WIN32
+			int frameDescriptor = _dup(_fileno(stdout));
+			bool redirected = frameDescriptor >= 0 && _dup2(_fileno(stderr), _fileno(stdout)) == 0;
+			if (redirected) {
+				_setmode(frameDescriptor, _O_BINARY);
+				frameOutput = _fdopen(frameDescriptor, "wb");
+			}
+#else
+			int frameDescriptor = dup(STDOUT_FILENO);
+			bool redirected = frameDescriptor >= 0 && dup2(STDERR_FILENO, STDOUT_FILENO) >= 0;
+			if (redirected) frameOutput = fdopen(frameDescriptor, "wb");
+#endif
+
+			if (frameOutput == nullptr) {
+				std::cout << "[ERROR] Couldn't keep stdout for the frames." << std::endl;
+				return false;
+			}
+			return true;
+		}
+
+		bool start(const Settings& newSettings) {
+			stop();
+
+			if (newSettings.width <= 0 || newSettings.height <= 0 || newSettings.frameRate == 0) {
+				std::cout << "[ERROR] Invalid capture resolution " << newSettings.width << "x" << newSettings.height << " or frame rate " << newSettings.frameRate << "." << std::endl;
+				return false;
+			}
+			if (newSettings.output == Output::RawYUV && (newSettings.width % 2 != 0 || newSettings.height % 2 != 0)) {
+				std::cout << "[ERROR] YUV 4:2:0 frames need an even width and height." << std::endl;
+				return false;
+			}
+			if (newSettings.output == Output::PNG && !isFramePattern(newSettings.pathPattern)) {
+				std::cout << "[ERROR] The image path '" << newSettings.pathPattern << "' needs exactly one frame number pattern, and no other % than %% (e.g. frames/%06d.png)." << std::endl;
+				return false;
+			}
+
+			if (newSettings.output != Output::PNG && !takeStdout()) return false;
+
+			settings = newSettings;
+
+			for (int i = 0; i < CAPTURE_QUEUE_SIZE; i++) {
+				freeFrames.push_back(new Frame());
+			}
+
+			queuedFrameCount = 0;
+			writtenFrameCount = 0;
+			outputFailed = false;
+			stopping = false;
+			writerThread = std::thread(runWriter);
+
+			active = true;
+			return true;
+		}
+
+		bool isActive() {
+			return active;
+		}
+
+		const Settings& getSettings() {
+			return settings;
+		}
+
+		std::vector<uint8_t>& takeFrame() {
+			takenFrame = takeFreeFrame();
+			return takenFrame->pixels;
+		}
+
+		void queueFrame() {
+			takenFrame->index = queuedFrameCount++;
+			pushFrame(takenFrame);
+			takenFrame = nullptr;
+		}
+
+		void submitFrame(const uint8_t* pixels, size_t rowBytes) {
+			if (!active || !settings.software) return;
+
+			std::vector<uint8_t>& framePixels = takeFrame();
+			size_t rowSize = (size_t)settings.width * 3;
+			framePixels.resize(rowSize * settings.height);
+			for (int y = 0; y < settings.height; y++) {
+				memcpy(framePixels.data() + y * rowSize, pixels + y * rowBytes, rowSize);
+			}
+
+			queueFrame();
+		}
+
+		void stop() {
+			if (!active) return;
+
+			{
+				std::lock_guard<std::mutex> lock(queueMutex);
+				stopping = true;
+			}
+			queueCondition.notify_all();
+			writerThread.join();
+
+			for (Frame* frame : freeFrames) delete frame;
+			freeFrames.clear();
+
+			active = false;
+		}
+
+		double getFrameDuration() {
+			return 1.0 / settings.frameRate;
+		}
+
+		unsigned long long getWrittenFrameCount() {
+			return writtenFrameCount;
+		}
+	}
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#define CAPTURE_QUEUE_SIZE 4 // Frames that can wait to be written; when the output can't keep up, rendering waits (a video can't skip frames)
+
+// Offscreen rendering into image sequences or a raw video stream (see offscreen.h, --render).
+// Converting and writing the frames happens on a background thread. Nothing here depends on OpenGL: frames drawn by the software renderer
+// are handed over with submitFrame, and the ones drawn with OpenGL come from the readback (frame_readback.h)
+namespace renderer {
+	namespace capture {
+		enum class Output {
+			PNG, // One file per frame, the path being a printf pattern with a single %d (or %i) conversion for the frame number (e.g. "frames/%06d.png")
+			RawRGB, // 8-bit RGB frames written back to back to stdout
+			RawYUV // 8-bit planar YUV 4:2:0 frames (BT.709, limited range) written back to back to stdout
+		};
+
+		struct Settings {
+			Output output = Output::PNG;
+			std::string pathPattern; // PNG only
+			int width = 1920;
+			int height = 1080; // Both must be even for RawYUV
+			unsigned int frameRate = 60; // Only sets how fast the camera animates, the caller decides how much the simulation advances between frames
+			bool software = false; // Frames come from submitFrame instead of the OpenGL readback
+		};
+
+		// Raw outputs: keeps the original stdout for the frames and points stdout to stderr, so that nothing else printed to stdout
+		// (printf and std::cout included) ends up in the video stream. start does it if needed, but it should be called before anything is printed
+		bool takeStdout();
+
+		// Fails if the settings can't be used. Frames drawn with OpenGL also need readback::start
+		bool start(const Settings& settings);
+		bool isActive();
+		const Settings& getSettings();
+		double getFrameDuration(); // Seconds between two frames of the video
+
+		// Software rendering only: queues a frame of width * height RGB pixels (rows from top to bottom, rowBytes apart) for writing
+		void submitFrame(const uint8_t* pixels, size_t rowBytes);
+		// Lower level version of submitFrame, for the OpenGL readback: takeFrame waits until the writer is done with a frame if they are all
+		// queued (a video can't skip frames) and returns the pixels to fill (RGBA, bottom row first), which queueFrame then hands over
+		std::vector<uint8_t>& takeFrame();
+		void queueFrame();
+		// Writes every queued frame, then frees the buffers
+		void stop();
+
+		unsigned long long getWrittenFrameCount();
+	}
+}
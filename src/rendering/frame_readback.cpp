@@ -0,0 +1,112 @@
+#include "frame_readback.h"
+
+#include <iostream>
+#include <cstdint>
+#include <vector>
+
+namespace renderer {
+	namespace capture {
+		namespace readback {
+			bool active = false;
+
+			GLuint FramebufferID = 0;
+			GLuint ColorRenderbufferID = 0;
+			GLuint PixelBufferIDs[2] = { 0, 0 }; // Readback targets, used in turns
+			unsigned long long readFrameCount = 0; // Frames whose readback was started
+
+			// Maps the pixel buffer of a frame whose readback was started earlier and hands its pixels over to the writer
+			void queueFrame(unsigned long long frameIndex) {
+				const Settings& settings = getSettings();
+				std::vector<uint8_t>& framePixels = takeFrame();
+
+				size_t size = (size_t)settings.width * settings.height * 4;
+				glBindBuffer(GL_PIXEL_PACK_BUFFER, PixelBufferIDs[frameIndex % 2]);
+				const uint8_t* pixels = (const uint8_t*)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT);
+				if (pixels != nullptr) {
+					framePixels.assign(pixels, pixels + size);
+					glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+				}
+				else {
+					std::cout << "[ERROR] Couldn't map the pixels of frame " << frameIndex << "." << std::endl;
+					framePixels.assign(size, 0);
+				}
+				glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+				capture::queueFrame();
+			}
+
+			bool start() {
+				stop();
+
+				const Settings& settings = getSettings();
+
+				// Final image, after post-processing
+				glGenFramebuffers(1, &FramebufferID);
+				glBindFramebuffer(GL_FRAMEBUFFER, FramebufferID);
+				glGenRenderbuffers(1, &ColorRenderbufferID);
+				glBindRenderbuffer(GL_RENDERBUFFER, ColorRenderbufferID);
+				glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, settings.width, settings.height);
+				glBindRenderbuffer(GL_RENDERBUFFER, 0);
+				glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, ColorRenderbufferID);
+
+				bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+				glBindFramebuffer(GL_FRAMEBUFFER, 0);
+				if (!complete) {
+					std::cout << "[ERROR] The capture framebuffer is not complete." << std::endl;
+					glDeleteRenderbuffers(1, &ColorRenderbufferID);
+					glDeleteFramebuffers(1, &FramebufferID);
+					ColorRenderbufferID = 0;
+					FramebufferID = 0;
+					return false;
+				}
+
+				// RGBA is the format drivers read back without converting
+				glGenBuffers(2, PixelBufferIDs);
+				for (GLuint PixelBufferID : PixelBufferIDs) {
+					glBindBuffer(GL_PIXEL_PACK_BUFFER, PixelBufferID);
+					glBufferData(GL_PIXEL_PACK_BUFFER, (GLsizeiptr)settings.width * settings.height * 4, NULL, GL_STREAM_READ);
+				}
+				glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+				readFrameCount = 0;
+				active = true;
+				return true;
+			}
+
+			GLuint getFramebuffer() {
+				return FramebufferID;
+			}
+
+			void readFrame() {
+				if (!active) return;
+
+				const Settings& settings = getSettings();
+
+				glBindFramebuffer(GL_READ_FRAMEBUFFER, FramebufferID);
+				glReadBuffer(GL_COLOR_ATTACHMENT0);
+				glBindBuffer(GL_PIXEL_PACK_BUFFER, PixelBufferIDs[readFrameCount % 2]);
+				glReadPixels(0, 0, settings.width, settings.height, GL_RGBA, GL_UNSIGNED_BYTE, (void*)0); // Returns right away, the copy happens on the GPU
+				glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+				glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+
+				// The previous readback had a whole frame to complete
+				if (readFrameCount > 0) queueFrame(readFrameCount - 1);
+				readFrameCount++;
+			}
+
+			void stop() {
+				if (!active) return;
+
+				if (readFrameCount > 0) queueFrame(readFrameCount - 1);
+
+				glDeleteBuffers(2, PixelBufferIDs);
+				glDeleteRenderbuffers(1, &ColorRenderbufferID);
+				glDeleteFramebuffers(1, &FramebufferID);
+				PixelBufferIDs[0] = PixelBufferIDs[1] = 0;
+				ColorRenderbufferID = 0;
+				FramebufferID = 0;
+				active = false;
+			}
+		}
+	}
+}
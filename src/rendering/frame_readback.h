@@ -0,0 +1,22 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include "frame_capture.h"
+
+// OpenGL side of the capture (frame_capture.h). Every frame is drawn into the capture framebuffer instead of the window, copied into one of
+// two pixel buffers without waiting for the GPU, and mapped one frame later, when the copy is done
+namespace renderer {
+	namespace capture {
+		namespace readback {
+			// Needs the OpenGL context and a started capture
+			bool start();
+			GLuint getFramebuffer(); // Where the frame must be drawn while capturing
+
+			// Starts the readback of the frame that was just drawn and queues the previous one for writing
+			void readFrame();
+			// Queues the last frame and frees the buffers, before capture::stop
+			void stop();
+		}
+	}
+}
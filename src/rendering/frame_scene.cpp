@@ -0,0 +1,50 @@
+#include "frame_scene.h"
+
+#include <cmath>
+
+namespace renderer {
+	glm::mat4 getProjection(float fov, float aspectRatio) {
+		return glm::perspective(fov, aspectRatio, FRAME_NEAR_PLANE, FRAME_FAR_PLANE);
+	}
+
+	glm::mat4 getOrbitView(glm::vec3 focus, float distance, float angle) {
+		glm::vec3 position = focus + glm::vec3(std::sin(angle), 0.0f, std::cos(angle)) * distance;
+		return glm::lookAt(position, focus, glm::vec3(0, 1, 0));
+	}
+
+	void buildFrameScene(const simulation::Snapshot& snapshot, const glm::mat4& view, const glm::mat4& projection, FrameScene& scene) {
+		scene.snapshot = &snapshot;
+		scene.view = view;
+		scene.projection = projection;
+		scene.viewProjection = projection * view;
+		scene.stationaryView = glm::mat4(glm::mat3(view));
+		scene.cameraPosition = glm::vec3(glm::inverse(view)[3]);
+		scene.light = snapshot.GetEmissiveBody();
+
+		// Frustum planes from the rows of the view-projection matrix (Gribb & Hartmann), normalized so that they give distances
+		glm::mat4 m = glm::transpose(scene.viewProjection);
+		glm::vec4 planes[6] = { m[3] + m[0], m[3] - m[0], m[3] + m[1], m[3] - m[1], m[3] + m[2], m[3] - m[2] };
+		for (glm::vec4& plane : planes) {
+			plane /= glm::length(glm::vec3(plane));
+		}
+
+		scene.visibleBodies.clear();
+		for (unsigned int i = 0; i < snapshot.bodies.size(); i++) {
+			const MassBody& body = snapshot.bodies[i];
+
+			bool visible = true;
+			for (const glm::vec4& plane : planes) {
+				if (glm::dot(glm::vec3(plane), body.position) + plane.w < -body.radius) {
+					visible = false;
+					break;
+				}
+			}
+
+			if (visible) scene.visibleBodies.push_back(i);
+		}
+	}
+
+	float getFogVisibility(float distance) {
+		return std::fmin(std::fmax(std::exp(-std::pow(distance * FRAME_FOG_DENSITY, FRAME_FOG_GRADIENT)), 0.0f), 1.0f);
+	}
+}
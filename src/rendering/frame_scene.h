@@ -0,0 +1,40 @@
+#pragma once
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <vector>
+
+#include "../universe/simulation.h"
+
+#define FRAME_NEAR_PLANE 0.1f
+#define FRAME_FAR_PLANE 500.0f
+#define FRAME_FOG_DENSITY 0.015f // Things fade out when too far away to avoid a hard edge at the far plane (same as the default vertex shader)
+#define FRAME_FOG_GRADIENT 3.0f
+#define FRAME_MIN_LIGHT_LEVEL 0.1f // Ambient light of the lit bodies (same as the default fragment shader)
+#define FRAME_CAMERA_DISTANCE 5.0f // Distance of the camera from the focused body before it is zoomed
+
+namespace renderer {
+	// What a frame shows: the camera, the light and the bodies in view. Built the same way for the OpenGL and the software renderers
+	struct FrameScene {
+		const simulation::Snapshot* snapshot;
+
+		glm::mat4 view;
+		glm::mat4 projection;
+		glm::mat4 viewProjection;
+		glm::mat4 stationaryView; // View matrix without any translation, for the starfield
+		glm::vec3 cameraPosition;
+
+		const MassBody* light; // nullptr when there are no bodies
+
+		std::vector<unsigned int> visibleBodies; // Indices in the snapshot of the bodies that are at least partly inside the view frustum
+	};
+
+	glm::mat4 getProjection(float fov, float aspectRatio);
+	// Camera circling the focus in the horizontal plane, for views without a user to move the camera (at angle 0, the starting view of the window)
+	glm::mat4 getOrbitView(glm::vec3 focus, float distance, float angle);
+
+	// Finds what can be seen from the camera in the snapshot, which must outlive the scene
+	void buildFrameScene(const simulation::Snapshot& snapshot, const glm::mat4& view, const glm::mat4& projection, FrameScene& scene);
+
+	// How much of its color a body keeps at that distance from the camera, because of the fog
+	float getFogVisibility(float distance);
+}
@@ -0,0 +1,106 @@
+#include "geometry_batch.h"
+
+#include <cstddef>
+
+GeometryBatch::GeometryBatch() {
+	primitive = GL_TRIANGLES;
+	bufferCapacity = 0;
+	uploadedVertexCount = 0;
+	VertexArrayID = 0;
+	VertexBufferID = 0;
+}
+
+void GeometryBatch::init() {
+	glGenVertexArrays(1, &VertexArrayID);
+	glBindVertexArray(VertexArrayID);
+
+	glGenBuffers(1, &VertexBufferID);
+	glBindBuffer(GL_ARRAY_BUFFER, VertexBufferID);
+
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(BatchVertex), (void*)offsetof(BatchVertex, position));
+	glEnableVertexAttribArray(1);
+	glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(BatchVertex), (void*)offsetof(BatchVertex, color));
+	glEnableVertexAttribArray(2);
+	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(BatchVertex), (void*)offsetof(BatchVertex, uv));
+
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void GeometryBatch::dispose() {
+	if (VertexArrayID == 0) return;
+
+	glDeleteBuffers(1, &VertexBufferID);
+	glDeleteVertexArrays(1, &VertexArrayID);
+
+	VertexArrayID = 0;
+	VertexBufferID = 0;
+}
+
+void GeometryBatch::setPrimitive(GLenum primitive) {
+	if (primitive == this->primitive) return;
+
+	flush();
+	this->primitive = primitive;
+}
+
+void GeometryBatch::addVertex(glm::vec3 position, glm::vec4 color, glm::vec2 uv) {
+	vertices.push_back({ position, color, uv });
+}
+
+void GeometryBatch::addLine(glm::vec3 a, glm::vec3 b, Color color) {
+	glm::vec4 c(color.red, color.green, color.blue, 1.0f);
+	vertices.push_back({ a, c, glm::vec2(0.0f) });
+	vertices.push_back({ b, c, glm::vec2(0.0f) });
+}
+
+void GeometryBatch::addRect(float xMin, float yMin, float xMax, float yMax, Color color) {
+	addTexturedRect(xMin, yMin, xMax, yMax, 0.0f, 0.0f, 0.0f, 0.0f, color);
+}
+
+void GeometryBatch::addTexturedRect(float xMin, float yMin, float xMax, float yMax, float uMin, float vMin, float uMax, float vMax, Color color) {
+	glm::vec4 c(color.red, color.green, color.blue, 1.0f);
+
+	// Two counter-clockwise triangles (uMin/vMin is the texture coordinate of the top left corner)
+	vertices.push_back({ glm::vec3(xMin, yMax, 0.0f), c, glm::vec2(uMin, vMin) });
+	vertices.push_back({ glm::vec3(xMin, yMin, 0.0f), c, glm::vec2(uMin, vMax) });
+	vertices.push_back({ glm::vec3(xMax, yMin, 0.0f), c, glm::vec2(uMax, vMax) });
+
+	vertices.push_back({ glm::vec3(xMax, yMax, 0.0f), c, glm::vec2(uMax, vMin) });
+	vertices.push_back({ glm::vec3(xMin, yMax, 0.0f), c, glm::vec2(uMin, vMin) });
+	vertices.push_back({ glm::vec3(xMax, yMin, 0.0f), c, glm::vec2(uMax, vMax) });
+}
+
+void GeometryBatch::flush() {
+	if (vertices.empty()) return;
+
+	upload();
+	draw();
+	clear();
+}
+
+void GeometryBatch::upload() {
+	uploadedVertexCount = vertices.size();
+	if (vertices.empty()) return;
+
+	glBindBuffer(GL_ARRAY_BUFFER, VertexBufferID);
+
+	// Orphan the previous buffer so that the upload doesn't have to wait for the previous draw, growing it when needed
+	if (vertices.size() > bufferCapacity) bufferCapacity = vertices.size() * 2;
+	glBufferData(GL_ARRAY_BUFFER, bufferCapacity * sizeof(BatchVertex), NULL, GL_STREAM_DRAW);
+	glBufferSubData(GL_ARRAY_BUFFER, 0, vertices.size() * sizeof(BatchVertex), vertices.data());
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void GeometryBatch::draw() {
+	if (uploadedVertexCount == 0) return;
+
+	glBindVertexArray(VertexArrayID);
+	glDrawArrays(primitive, 0, (GLsizei)uploadedVertexCount);
+	glBindVertexArray(0);
+}
+
+void GeometryBatch::clear() {
+	vertices.clear();
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/gtc/matrix_transform.hpp>
+#include <vector>
+
+#include "color.h"
+
+// Layout of a vertex submitted to a geometry batch (matches the attribute locations of the default, overlay and UI shaders)
+struct BatchVertex {
+	glm::vec3 position; // Attribute 0
+	glm::vec4 color;    // Attribute 1
+	glm::vec2 uv;       // Attribute 2
+};
+
+// Collects geometry generated on the CPU every frame (grid, overlays, UI, text) and draws it with as few draw calls as possible.
+// Geometry is only sent to the GPU when flush() is called, so the caller must flush before changing any state the geometry depends on (program, uniforms, textures).
+class GeometryBatch
+{
+private:
+	std::vector<BatchVertex> vertices;
+	GLenum primitive;
+	size_t bufferCapacity; // In vertices
+	size_t uploadedVertexCount;
+
+	GLuint VertexArrayID;
+	GLuint VertexBufferID;
+
+public:
+	GeometryBatch();
+
+	void init();
+	void dispose();
+
+	// Sets the primitive of the following vertices (GL_TRIANGLES or GL_LINES), flushing what was added with the previous one
+	void setPrimitive(GLenum primitive);
+
+	void addVertex(glm::vec3 position, glm::vec4 color, glm::vec2 uv = glm::vec2(0.0f));
+	void addLine(glm::vec3 a, glm::vec3 b, Color color);
+	void addRect(float xMin, float yMin, float xMax, float yMax, Color color);
+	void addTexturedRect(float xMin, float yMin, float xMax, float yMax, float uMin, float vMin, float uMax, float vMax, Color color);
+
+	// Uploads and draws everything that was added since the last flush
+	void flush();
+
+	// For geometry that is kept across frames: upload() sends what was added to the GPU, draw() draws the last upload again and clear() starts over
+	void upload();
+	void draw();
+	void clear();
+};
@@ -0,0 +1,34 @@
+#include "mesh_cache.h"
+#include "baseModels/sphere.h"
+
+#include <map>
+#include <utility>
+
+namespace meshCache {
+	std::map<std::pair<MeshType, int>, RenderModel*> models;
+
+	RenderModel* get(MeshType type, int resolution) {
+		std::pair<MeshType, int> key(type, resolution);
+
+		auto cached = models.find(key);
+		if (cached != models.end()) return cached->second;
+
+		RenderModel* model = nullptr;
+		switch (type) {
+		case MeshType::Sphere:
+			model = new Sphere(resolution);
+			break;
+		}
+
+		models[key] = model;
+		return model;
+	}
+
+	void dispose() {
+		for (auto& entry : models) {
+			delete entry.second;
+		}
+
+		models.clear();
+	}
+}
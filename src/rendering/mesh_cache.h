@@ -0,0 +1,16 @@
+#pragma once
+
+#include "render_model.h"
+
+namespace meshCache {
+	enum class MeshType {
+		Sphere // Unit icosphere facing outwards (bodies)
+	};
+
+	// Returns the model of the given type and resolution (icosphere subdivisions), generating and uploading it on first use.
+	// Models are shared, so the returned pointer must not be deleted.
+	RenderModel* get(MeshType type, int resolution);
+
+	// Deletes every cached model from the GPU
+	void dispose();
+}
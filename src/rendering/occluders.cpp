@@ -0,0 +1,227 @@
+#include "occluders.h"
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <unordered_map>
+#include <iostream>
+#include <cmath>
+#include <cfloat>
+#include <cstdint>
+
+namespace renderer {
+	namespace occluders {
+		GLuint BufferID;
+		GLuint TextureID;
+		GLint maxTexelCount; // GL_MAX_TEXTURE_BUFFER_SIZE
+		bool warnedFull = false;
+
+		std::vector<glm::vec4> occluderData; // xyz = position, w = radius (one entry per occluder of every body, grouped by body)
+		std::vector<OccluderRange> ranges; // Indexed like the bodies of the last update
+
+		// Uniform grid of the bodies that are small next to its cells, each one in the cell of its center. Rebuilt by every update.
+		// The bigger bodies (planets, moons) are few and are tested against every receiver
+		struct Cell {
+			unsigned int start; // In gridBodies
+			unsigned int count;
+		};
+		glm::vec3 gridOrigin;
+		float cellSize;
+		float maxGridRadius; // Of the bodies in the grid
+		std::vector<unsigned int> gridBodies; // Grouped by cell
+		std::unordered_map<uint64_t, Cell> cells;
+		std::vector<unsigned int> largeBodies;
+		std::vector<std::pair<uint64_t, unsigned int>> sortedBodies;
+
+		// Reused for every receiver
+		struct Candidate {
+			unsigned int index;
+			float apparentSize; // Radius over distance, as seen from the receiver
+		};
+		std::vector<Candidate> candidates;
+		std::vector<uint64_t> cellKeys;
+
+		void init() {
+			glGenBuffers(1, &BufferID);
+			glGenTextures(1, &TextureID);
+
+			glBindBuffer(GL_TEXTURE_BUFFER, BufferID);
+			glBindTexture(GL_TEXTURE_BUFFER, TextureID);
+			glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, BufferID);
+			glBindTexture(GL_TEXTURE_BUFFER, 0);
+			glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+			glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &maxTexelCount);
+		}
+
+		// The coordinates are relative to the grid origin, so they always fit in 21 bits for the number of cells the grid has
+		uint64_t getCellKey(glm::ivec3 cell) {
+			return (uint64_t)(cell.x & 0x1FFFFF) | ((uint64_t)(cell.y & 0x1FFFFF) << 21) | ((uint64_t)(cell.z & 0x1FFFFF) << 42);
+		}
+
+		glm::ivec3 getCell(glm::vec3 position) {
+			return glm::ivec3(glm::floor((position - gridOrigin) / cellSize));
+		}
+
+		void buildGrid(const std::vector<MassBody>& bodies, int lightBodyIndex) {
+			gridBodies.clear();
+			cells.clear();
+			largeBodies.clear();
+			sortedBodies.clear();
+			maxGridRadius = 0.0f;
+
+			glm::vec3 boundsMin(FLT_MAX), boundsMax(-FLT_MAX);
+			for (const MassBody& body : bodies) {
+				boundsMin = glm::min(boundsMin, body.position);
+				boundsMax = glm::max(boundsMax, body.position);
+			}
+
+			// About one body per cell
+			glm::vec3 extent = boundsMax - boundsMin;
+			float largestExtent = std::max(extent.x, std::max(extent.y, extent.z));
+			cellSize = largestExtent > 0.0f ? largestExtent / std::cbrt((float)bodies.size()) : 1.0f;
+			gridOrigin = boundsMin;
+
+			for (unsigned int i = 0; i < bodies.size(); i++) {
+				if ((int)i == lightBodyIndex) continue;
+
+				if (bodies[i].radius > cellSize * 0.5f) {
+					largeBodies.push_back(i);
+				}
+				else {
+					sortedBodies.push_back({ getCellKey(getCell(bodies[i].position)), i });
+					maxGridRadius = std::max(maxGridRadius, bodies[i].radius);
+				}
+			}
+
+			std::sort(sortedBodies.begin(), sortedBodies.end());
+			for (const std::pair<uint64_t, unsigned int>& body : sortedBodies) {
+				Cell& cell = cells.emplace(body.first, Cell{ (unsigned int)gridBodies.size(), 0 }).first->second;
+				cell.count++;
+				gridBodies.push_back(body.second);
+			}
+		}
+
+		void findOccluders(const std::vector<MassBody>& bodies, int lightBodyIndex, unsigned int receiverIndex) {
+			candidates.clear();
+
+			const MassBody& lightBody = bodies[lightBodyIndex];
+			const MassBody& receiver = bodies[receiverIndex];
+
+			glm::vec3 toLight = lightBody.position - receiver.position;
+			float distanceToLight = glm::length(toLight);
+			if (distanceToLight <= 0.0f) return;
+			glm::vec3 lightDirection = toLight / distanceToLight;
+
+			// Every ray going from the receiver to the light stays within this distance of the line joining their centers
+			float coneRadius = std::max(receiver.radius, lightBody.radius);
+
+			auto test = [&](unsigned int occluderIndex) {
+				if (occluderIndex == receiverIndex) return;
+				const MassBody& occluder = bodies[occluderIndex];
+
+				glm::vec3 toOccluder = occluder.position - receiver.position;
+				float alongLine = glm::dot(toOccluder, lightDirection);
+
+				if (alongLine + occluder.radius + receiver.radius < 0.0f) return; // Behind the receiver
+				if (alongLine - occluder.radius > distanceToLight) return; // Behind the light
+
+				float distanceToLine = glm::length(toOccluder - alongLine * lightDirection);
+				if (distanceToLine > coneRadius + occluder.radius) return; // Beside the cone
+
+				candidates.push_back({ occluderIndex, occluder.radius / std::max(glm::length(toOccluder), FLT_MIN) });
+			};
+
+			for (unsigned int index : largeBodies) test(index);
+
+			// The cells around points of the segment joining the receiver and the light, one cell apart. Half a cell more covers the points between them
+			float reach = coneRadius + maxGridRadius + cellSize * 0.5f;
+			size_t steps = (size_t)std::ceil(distanceToLight / cellSize);
+			size_t side = (size_t)std::ceil(reach * 2.0f / cellSize) + 1;
+			if ((steps + 1) * side * side * side > gridBodies.size()) {
+				// Wide cone (e.g. a big light) or few bodies: looking up the cells would cost more than testing every body
+				for (unsigned int index : gridBodies) test(index);
+			}
+			else {
+				cellKeys.clear();
+				for (size_t step = 0; step <= steps; step++) {
+					glm::vec3 point = receiver.position + lightDirection * std::min(step * cellSize, distanceToLight);
+					glm::ivec3 first = getCell(point - reach), last = getCell(point + reach);
+					for (int z = first.z; z <= last.z; z++) {
+						for (int y = first.y; y <= last.y; y++) {
+							for (int x = first.x; x <= last.x; x++) {
+								cellKeys.push_back(getCellKey(glm::ivec3(x, y, z)));
+							}
+						}
+					}
+				}
+				std::sort(cellKeys.begin(), cellKeys.end());
+				cellKeys.erase(std::unique(cellKeys.begin(), cellKeys.end()), cellKeys.end());
+
+				for (uint64_t key : cellKeys) {
+					std::unordered_map<uint64_t, Cell>::const_iterator cell = cells.find(key);
+					if (cell == cells.end()) continue;
+					for (unsigned int i = 0; i < cell->second.count; i++) test(gridBodies[cell->second.start + i]);
+				}
+			}
+
+			if (candidates.size() > OCCLUDERS_MAX_PER_BODY) {
+				std::nth_element(candidates.begin(), candidates.begin() + OCCLUDERS_MAX_PER_BODY, candidates.end(),
+					[](const Candidate& a, const Candidate& b) { return a.apparentSize > b.apparentSize; });
+				candidates.resize(OCCLUDERS_MAX_PER_BODY);
+			}
+		}
+
+		void update(const std::vector<MassBody>& bodies, int lightBodyIndex, const std::vector<unsigned int>& receivers) {
+			occluderData.clear();
+			ranges.assign(bodies.size(), { 0, 0 });
+
+			if (lightBodyIndex < 0) return; // Without light, there are no shadows
+
+			buildGrid(bodies, lightBodyIndex);
+
+			for (unsigned int receiverIndex : receivers) {
+				if ((int)receiverIndex == lightBodyIndex || receiverIndex >= bodies.size()) continue; // The light source isn't shaded
+
+				findOccluders(bodies, lightBodyIndex, receiverIndex);
+
+				// The texture buffer can't be read beyond its size limit: the receivers that don't fit are drawn without shadows
+				size_t count = std::min(candidates.size(), (size_t)maxTexelCount - std::min(occluderData.size(), (size_t)maxTexelCount));
+				if (count < candidates.size() && !warnedFull) {
+					std::cout << "[WARNING] Too many occluders for the texture buffer (" << maxTexelCount << " at most), some bodies are drawn without shadows." << std::endl;
+					warnedFull = true;
+				}
+
+				ranges[receiverIndex] = { (int)occluderData.size(), (int)count };
+				for (size_t i = 0; i < count; i++) {
+					const MassBody& occluder = bodies[candidates[i].index];
+					occluderData.push_back(glm::vec4(occluder.position, occluder.radius));
+				}
+			}
+
+			// Orphan the previous buffer so that the upload doesn't have to wait for the last frame's draws
+			glBindBuffer(GL_TEXTURE_BUFFER, BufferID);
+			glBufferData(GL_TEXTURE_BUFFER, occluderData.size() * sizeof(glm::vec4), NULL, GL_STREAM_DRAW);
+			if (!occluderData.empty()) {
+				glBufferSubData(GL_TEXTURE_BUFFER, 0, occluderData.size() * sizeof(glm::vec4), occluderData.data());
+			}
+			glBindBuffer(GL_TEXTURE_BUFFER, 0);
+		}
+
+		OccluderRange get(unsigned int bodyIndex) {
+			if (bodyIndex >= ranges.size()) return { 0, 0 };
+
+			return ranges[bodyIndex];
+		}
+
+		void bind(GLenum textureUnit) {
+			glActiveTexture(textureUnit);
+			glBindTexture(GL_TEXTURE_BUFFER, TextureID);
+			glActiveTexture(GL_TEXTURE0);
+		}
+
+		void dispose() {
+			glDeleteTextures(1, &TextureID);
+			glDeleteBuffers(1, &BufferID);
+		}
+	}
+}
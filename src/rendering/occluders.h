@@ -0,0 +1,32 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <vector>
+
+#define OCCLUDERS_MAX_PER_BODY 32 // Only the occluders that look the biggest from a body are kept beyond this, so that the shader cost stays bounded
+
+#include "../universe/mass_body.h"
+
+namespace renderer {
+	namespace occluders {
+		// Part of the occluder buffer that holds the occluders of a single body
+		struct OccluderRange {
+			int offset;
+			int count;
+		};
+
+		void init();
+
+		// Finds, for every receiver (index in bodies, e.g. the visible ones), the bodies that can cast a shadow on it (the ones lying in the cone
+		// between it and the light) and uploads them to the occluder texture buffer. Must be called once per frame, before rendering the bodies
+		void update(const std::vector<MassBody>& bodies, int lightBodyIndex, const std::vector<unsigned int>& receivers);
+
+		// Returns where the occluders of the body at the given index of the last update are in the buffer (an empty range for the light and unknown bodies)
+		OccluderRange get(unsigned int bodyIndex);
+
+		// Binds the occluder buffer to the given texture unit
+		void bind(GLenum textureUnit);
+
+		void dispose();
+	}
+}
@@ -0,0 +1,722 @@
+#include "pixel_convert.h"
+
+#include <iostream>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define PIXEL_CONVERT_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define PIXEL_CONVERT_TARGET(instructionSet) // MSVC compiles every intrinsic without a flag
+#else
+#define PIXEL_CONVERT_TARGET(instructionSet) __attribute__((target(instructionSet)))
+#endif
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#define PIXEL_CONVERT_ARM
+#include <arm_neon.h>
+#endif
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+#define PIXEL_CONVERT_ALIGNMENT 32 // Size of an AVX2 register
+#define PIXEL_CONVERT_MAX_CHUNKS 4 // 16-byte chunks of a group of pixels in the widest format (16 pixels of 4 bytes)
+
+namespace pixelConvert {
+	// Rearranges the bytes of a group of pixels 16 at a time: output chunk k is the OR of every input chunk j shuffled with masks[k][j]
+	// (pshufb on x86, tbl on ARM, both giving 0 for a mask byte of 0x80). Packed pixels take consecutive chunks, planes one chunk each
+	struct Shuffle {
+		int groupPixels;
+		int inputPixelSize, outputPixelSize; // 0 for planes
+		int inputChunks, outputChunks;
+		alignas(16) uint8_t masks[PIXEL_CONVERT_MAX_CHUNKS][PIXEL_CONVERT_MAX_CHUNKS][16];
+
+		// Same, one byte at a time, for the scalar code: where every output byte comes from (-1 when it is cleared)
+		int8_t sourceChunks[PIXEL_CONVERT_MAX_CHUNKS][16];
+		uint8_t sourceBytes[PIXEL_CONVERT_MAX_CHUNKS][16];
+	};
+
+	// Output channel c of every pixel is channel sourceChannels[c] of the same input pixel
+	Shuffle makeShuffle(int groupPixels, int inputPixelSize, int inputChannels, int outputPixelSize, int outputChannels, const int* sourceChannels) {
+		Shuffle shuffle;
+		shuffle.groupPixels = groupPixels;
+		shuffle.inputPixelSize = inputPixelSize;
+		shuffle.outputPixelSize = outputPixelSize;
+		shuffle.inputChunks = inputPixelSize != 0 ? groupPixels * inputPixelSize / 16 : inputChannels;
+		shuffle.outputChunks = outputPixelSize != 0 ? groupPixels * outputPixelSize / 16 : outputChannels;
+		memset(shuffle.masks, 0x80, sizeof(shuffle.masks));
+		memset(shuffle.sourceChunks, -1, sizeof(shuffle.sourceChunks));
+		memset(shuffle.sourceBytes, 0, sizeof(shuffle.sourceBytes));
+
+		for (int pixel = 0; pixel < groupPixels; pixel++) {
+			for (int channel = 0; channel < outputChannels; channel++) {
+				int output = outputPixelSize != 0 ? pixel * outputPixelSize + channel : channel * 16 + pixel;
+				int input = inputPixelSize != 0 ? pixel * inputPixelSize + sourceChannels[channel] : sourceChannels[channel] * 16 + pixel;
+
+				shuffle.masks[output / 16][input / 16][output % 16] = (uint8_t)(input % 16);
+				shuffle.sourceChunks[output / 16][output % 16] = (int8_t)(input / 16);
+				shuffle.sourceBytes[output / 16][output % 16] = (uint8_t)(input % 16);
+			}
+		}
+
+		return shuffle;
+	}
+
+	const int sameChannels[4] = { 0, 1, 2, 3 };
+	const int swappedChannels[3] = { 2, 1, 0 };
+
+	const Shuffle packedToPlanar = makeShuffle(16, 3, 3, 0, 3, sameChannels);
+	const Shuffle planarToPacked = makeShuffle(16, 0, 3, 3, 3, sameChannels);
+	const Shuffle swapRB = makeShuffle(16, 3, 3, 3, 3, swappedChannels);
+	const Shuffle dropAlpha = makeShuffle(16, 4, 4, 3, 3, sameChannels);
+	const Shuffle packed4ToPlanar = makeShuffle(16, 4, 4, 0, 3, sameChannels); // Alpha dropped
+
+	int detectInstructionSet() {
+#if defined(PIXEL_CONVERT_ARM)
+		return PIXEL_CONVERT_NEON;
+#elif defined(PIXEL_CONVERT_X86)
+		bool ssse3, avx2;
+#ifdef _MSC_VER
+		int info[4];
+		__cpuid(info, 0);
+		int maxLeaf = info[0];
+		__cpuid(info, 1);
+		ssse3 = (info[2] & (1 << 9)) != 0;
+		bool osSavesAVX = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0 && (_xgetbv(0) & 6) == 6;
+		avx2 = false;
+		if (maxLeaf >= 7 && osSavesAVX) {
+			__cpuidex(info, 7, 0);
+			avx2 = (info[1] & (1 << 5)) != 0;
+		}
+#else
+		__builtin_cpu_init();
+		ssse3 = __builtin_cpu_supports("ssse3");
+		avx2 = __builtin_cpu_supports("avx2");
+#endif
+		if (avx2) return PIXEL_CONVERT_AVX2;
+		return ssse3 ? PIXEL_CONVERT_SSSE3 : PIXEL_CONVERT_SCALAR;
+#else
+		return PIXEL_CONVERT_SCALAR;
+#endif
+	}
+
+	const int supportedInstructionSet = detectInstructionSet();
+	int instructionSet = supportedInstructionSet;
+
+	// Groups of pixels, one byte at a time
+	void shuffleGroupsScalar(const Shuffle& shuffle, const uint8_t* const* inputs, ptrdiff_t inputGroupBytes, uint8_t* const* outputs, ptrdiff_t outputGroupBytes, int groupCount) {
+		for (int group = 0; group < groupCount; group++) {
+			for (int k = 0; k < shuffle.outputChunks; k++) {
+				uint8_t* output = outputs[k] + group * outputGroupBytes;
+				for (int i = 0; i < 16; i++) {
+					int chunk = shuffle.sourceChunks[k][i];
+					output[i] = chunk < 0 ? 0 : inputs[chunk][group * inputGroupBytes + shuffle.sourceBytes[k][i]];
+				}
+			}
+		}
+	}
+
+#ifdef PIXEL_CONVERT_X86
+	template <int InputChunks, int OutputChunks>
+	PIXEL_CONVERT_TARGET("ssse3") void shuffleGroupsSSSE3(const Shuffle& shuffle, const uint8_t* const* inputs, ptrdiff_t inputGroupBytes, uint8_t* const* outputs, ptrdiff_t outputGroupBytes, int groupCount) {
+		__m128i masks[OutputChunks][InputChunks];
+		for (int k = 0; k < OutputChunks; k++) {
+			for (int j = 0; j < InputChunks; j++) masks[k][j] = _mm_load_si128((const __m128i*)shuffle.masks[k][j]);
+		}
+
+		for (int group = 0; group < groupCount; group++) {
+			__m128i input[InputChunks];
+			for (int j = 0; j < InputChunks; j++) input[j] = _mm_loadu_si128((const __m128i*)(inputs[j] + group * inputGroupBytes));
+
+			for (int k = 0; k < OutputChunks; k++) {
+				__m128i output = _mm_shuffle_epi8(input[0], masks[k][0]);
+				for (int j = 1; j < InputChunks; j++) output = _mm_or_si128(output, _mm_shuffle_epi8(input[j], masks[k][j]));
+				_mm_storeu_si128((__m128i*)(outputs[k] + group * outputGroupBytes), output);
+			}
+		}
+	}
+
+	// Two groups at a time, one in each half of the registers (the AVX2 byte shuffle doesn't cross the halves anyway)
+	template <int InputChunks, int OutputChunks>
+	PIXEL_CONVERT_TARGET("avx2") void shuffleGroupsAVX2(const Shuffle& shuffle, const uint8_t* const* inputs, ptrdiff_t inputGroupBytes, uint8_t* const* outputs, ptrdiff_t outputGroupBytes, int groupCount) {
+		__m256i masks[OutputChunks][InputChunks];
+		for (int k = 0; k < OutputChunks; k++) {
+			for (int j = 0; j < InputChunks; j++) masks[k][j] = _mm256_broadcastsi128_si256(_mm_load_si128((const __m128i*)shuffle.masks[k][j]));
+		}
+
+		int group = 0;
+		for (; group + 2 <= groupCount; group += 2) {
+			__m256i input[InputChunks];
+			for (int j = 0; j < InputChunks; j++) {
+				const uint8_t* first = inputs[j] + group * inputGroupBytes;
+				input[j] = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)first)), _mm_loadu_si128((const __m128i*)(first + inputGroupBytes)), 1);
+			}
+
+			for (int k = 0; k < OutputChunks; k++) {
+				__m256i output = _mm256_shuffle_epi8(input[0], masks[k][0]);
+				for (int j = 1; j < InputChunks; j++) output = _mm256_or_si256(output, _mm256_shuffle_epi8(input[j], masks[k][j]));
+
+				uint8_t* first = outputs[k] + group * outputGroupBytes;
+				_mm_storeu_si128((__m128i*)first, _mm256_castsi256_si128(output));
+				_mm_storeu_si128((__m128i*)(first + outputGroupBytes), _mm256_extracti128_si256(output, 1));
+			}
+		}
+
+		if (group < groupCount) {
+			const uint8_t* lastInputs[InputChunks];
+			uint8_t* lastOutputs[OutputChunks];
+			for (int j = 0; j < InputChunks; j++) lastInputs[j] = inputs[j] + group * inputGroupBytes;
+			for (int k = 0; k < OutputChunks; k++) lastOutputs[k] = outputs[k] + group * outputGroupBytes;
+			shuffleGroupsSSSE3<InputChunks, OutputChunks>(shuffle, lastInputs, inputGroupBytes, lastOutputs, outputGroupBytes, 1);
+		}
+	}
+#endif
+
+#ifdef PIXEL_CONVERT_ARM
+	template <int InputChunks, int OutputChunks>
+	void shuffleGroupsNEON(const Shuffle& shuffle, const uint8_t* const* inputs, ptrdiff_t inputGroupBytes, uint8_t* const* outputs, ptrdiff_t outputGroupBytes, int groupCount) {
+		uint8x16_t masks[OutputChunks][InputChunks];
+		for (int k = 0; k < OutputChunks; k++) {
+			for (int j = 0; j < InputChunks; j++) masks[k][j] = vld1q_u8(shuffle.masks[k][j]);
+		}
+
+		for (int group = 0; group < groupCount; group++) {
+			uint8x16_t input[InputChunks];
+			for (int j = 0; j < InputChunks; j++) input[j] = vld1q_u8(inputs[j] + group * inputGroupBytes);
+
+			for (int k = 0; k < OutputChunks; k++) {
+				uint8x16_t output = vqtbl1q_u8(input[0], masks[k][0]);
+				for (int j = 1; j < InputChunks; j++) output = vorrq_u8(output, vqtbl1q_u8(input[j], masks[k][j]));
+				vst1q_u8(outputs[k] + group * outputGroupBytes, output);
+			}
+		}
+	}
+#endif
+
+	template <int InputChunks, int OutputChunks>
+	void shuffleGroupsWith(const Shuffle& shuffle, const uint8_t* const* inputs, ptrdiff_t inputGroupBytes, uint8_t* const* outputs, ptrdiff_t outputGroupBytes, int groupCount) {
+		switch (instructionSet) {
+#ifdef PIXEL_CONVERT_X86
+		case PIXEL_CONVERT_AVX2:
+			shuffleGroupsAVX2<InputChunks, OutputChunks>(shuffle, inputs, inputGroupBytes, outputs, outputGroupBytes, groupCount);
+			break;
+		case PIXEL_CONVERT_SSSE3:
+			shuffleGroupsSSSE3<InputChunks, OutputChunks>(shuffle, inputs, inputGroupBytes, outputs, outputGroupBytes, groupCount);
+			break;
+#endif
+#ifdef PIXEL_CONVERT_ARM
+		case PIXEL_CONVERT_NEON:
+			shuffleGroupsNEON<InputChunks, OutputChunks>(shuffle, inputs, inputGroupBytes, outputs, outputGroupBytes, groupCount);
+			break;
+#endif
+		default:
+			shuffleGroupsScalar(shuffle, inputs, inputGroupBytes, outputs, outputGroupBytes, groupCount);
+			break;
+		}
+	}
+
+	void shuffleGroups(const Shuffle& shuffle, const uint8_t* const* inputs, ptrdiff_t inputGroupBytes, uint8_t* const* outputs, ptrdiff_t outputGroupBytes, int groupCount) {
+		if (shuffle.inputChunks == 3 && shuffle.outputChunks == 3) shuffleGroupsWith<3, 3>(shuffle, inputs, inputGroupBytes, outputs, outputGroupBytes, groupCount);
+		else if (shuffle.inputChunks == 4 && shuffle.outputChunks == 3) shuffleGroupsWith<4, 3>(shuffle, inputs, inputGroupBytes, outputs, outputGroupBytes, groupCount);
+		else if (shuffle.inputChunks == 1 && shuffle.outputChunks == 1) shuffleGroupsWith<1, 1>(shuffle, inputs, inputGroupBytes, outputs, outputGroupBytes, groupCount);
+		else shuffleGroupsScalar(shuffle, inputs, inputGroupBytes, outputs, outputGroupBytes, groupCount);
+	}
+
+	// A row of width pixels. inputs and outputs are the planes, or only the first pixel for packed pixels.
+	// The pixels after the last whole group go through a zero-padded group, so nothing is read or written past the end of the row
+	void shuffleRow(const Shuffle& shuffle, const uint8_t* const* inputs, uint8_t* const* outputs, int width) {
+		const uint8_t* inputChunks[PIXEL_CONVERT_MAX_CHUNKS];
+		uint8_t* outputChunks[PIXEL_CONVERT_MAX_CHUNKS];
+		for (int j = 0; j < shuffle.inputChunks; j++) inputChunks[j] = shuffle.inputPixelSize != 0 ? inputs[0] + 16 * j : inputs[j];
+		for (int k = 0; k < shuffle.outputChunks; k++) outputChunks[k] = shuffle.outputPixelSize != 0 ? outputs[0] + 16 * k : outputs[k];
+		ptrdiff_t inputGroupBytes = shuffle.inputPixelSize != 0 ? shuffle.groupPixels * shuffle.inputPixelSize : shuffle.groupPixels;
+		ptrdiff_t outputGroupBytes = shuffle.outputPixelSize != 0 ? shuffle.groupPixels * shuffle.outputPixelSize : shuffle.groupPixels;
+
+		int groupCount = width / shuffle.groupPixels;
+		shuffleGroups(shuffle, inputChunks, inputGroupBytes, outputChunks, outputGroupBytes, groupCount);
+
+		int remaining = width - groupCount * shuffle.groupPixels;
+		if (remaining == 0) return;
+
+		uint8_t inputGroup[PIXEL_CONVERT_MAX_CHUNKS][16] = {};
+		uint8_t outputGroup[PIXEL_CONVERT_MAX_CHUNKS][16];
+		const uint8_t* groupInputs[PIXEL_CONVERT_MAX_CHUNKS];
+		uint8_t* groupOutputs[PIXEL_CONVERT_MAX_CHUNKS];
+		for (int j = 0; j < PIXEL_CONVERT_MAX_CHUNKS; j++) {
+			groupInputs[j] = inputGroup[j];
+			groupOutputs[j] = outputGroup[j];
+		}
+
+		if (shuffle.inputPixelSize != 0) memcpy(inputGroup, inputChunks[0] + groupCount * inputGroupBytes, remaining * shuffle.inputPixelSize);
+		else for (int j = 0; j < shuffle.inputChunks; j++) memcpy(inputGroup[j], inputChunks[j] + groupCount * inputGroupBytes, remaining);
+
+		shuffleGroupsScalar(shuffle, groupInputs, 0, groupOutputs, 0, 1);
+
+		if (shuffle.outputPixelSize != 0) memcpy(outputChunks[0] + groupCount * outputGroupBytes, outputGroup, remaining * shuffle.outputPixelSize);
+		else for (int k = 0; k < shuffle.outputChunks; k++) memcpy(outputChunks[k] + groupCount * outputGroupBytes, outputGroup[k], remaining);
+	}
+
+	// Packed pixels to packed pixels
+	void shufflePacked(const Shuffle& shuffle, const uint8_t* source, ptrdiff_t sourceRowBytes, uint8_t* destination, ptrdiff_t destinationRowBytes, int width, int height) {
+		for (int y = 0; y < height; y++) {
+			const uint8_t* input = source + y * sourceRowBytes;
+			uint8_t* output = destination + y * destinationRowBytes;
+			shuffleRow(shuffle, &input, &output, width);
+		}
+	}
+
+	// Y'CbCr in 8 bits: Y' = ((yRed * R + yGreen * G + yBlue * B + 128) >> 8) + yOffset, and the chroma from the sums of the 4 pixels it covers:
+	// Cb = ((cbRed * R + cbGreen * G + cbBlue * B + 512) >> 10) + 128
+	struct YpCbCrCoefficients {
+		int yRed, yGreen, yBlue, yOffset;
+		int cbRed, cbGreen, cbBlue;
+		int crRed, crGreen, crBlue;
+	};
+
+	const YpCbCrCoefficients videoRange = { 47, 157, 16, 16, -26, -86, 112, 112, -102, -10 };
+	const YpCbCrCoefficients fullRange = { 54, 183, 19, 0, -29, -99, 128, 128, -116, -12 };
+
+	// Where the Y'CbCr of a pair of rows goes (a single row for 4:2:2, given twice as the source)
+	struct YpCbCrOutput {
+		int layout;
+		uint8_t* luma[2]; // Planar and bi-planar
+		uint8_t* blue; // Planar
+		uint8_t* red;
+		uint8_t* chroma; // Bi-planar
+		uint8_t* packed; // 2vuy
+	};
+
+	uint8_t clampByte(int value) {
+		return (uint8_t)std::min(std::max(value, 0), 255);
+	}
+
+	// Pixels x and x + 1 of both rows
+	void convertYpCbCrBlock(const uint8_t* const* rows, int pixelSize, int x, const YpCbCrCoefficients& c, const YpCbCrOutput& output) {
+		uint8_t luma[2][2];
+		int redSum = 0, greenSum = 0, blueSum = 0;
+		for (int row = 0; row < 2; row++) {
+			for (int column = 0; column < 2; column++) {
+				const uint8_t* pixel = rows[row] + (x + column) * pixelSize;
+				luma[row][column] = (uint8_t)(((c.yRed * pixel[0] + c.yGreen * pixel[1] + c.yBlue * pixel[2] + 128) >> 8) + c.yOffset);
+				redSum += pixel[0];
+				greenSum += pixel[1];
+				blueSum += pixel[2];
+			}
+		}
+
+		uint8_t blue = clampByte(((c.cbRed * redSum + c.cbGreen * greenSum + c.cbBlue * blueSum + 512) >> 10) + 128);
+		uint8_t red = clampByte(((c.crRed * redSum + c.crGreen * greenSum + c.crBlue * blueSum + 512) >> 10) + 128);
+
+		if (output.layout == PIXEL_YPCBCR_422_2VUY) {
+			uint8_t* packed = output.packed + x * 2;
+			packed[0] = blue;
+			packed[1] = luma[0][0];
+			packed[2] = red;
+			packed[3] = luma[0][1];
+			return;
+		}
+
+		for (int row = 0; row < 2; row++) {
+			output.luma[row][x] = luma[row][0];
+			output.luma[row][x + 1] = luma[row][1];
+		}
+
+		if (output.layout == PIXEL_YPCBCR_420_PLANAR) {
+			output.blue[x / 2] = blue;
+			output.red[x / 2] = red;
+		}
+		else {
+			output.chroma[x] = blue;
+			output.chroma[x + 1] = red;
+		}
+	}
+
+#ifdef PIXEL_CONVERT_X86
+	// Two 16-bit coefficients, for the multiply-adds of interleaved pairs of values (pmaddwd)
+	int pairOf(int low, int high) {
+		return (int)(((uint32_t)(uint16_t)high << 16) | (uint16_t)low);
+	}
+
+	// 16 pixels of both rows at a time, starting at pixel x. Returns the first pixel left for the scalar code
+	PIXEL_CONVERT_TARGET("ssse3") int convertYpCbCrSSSE3(const uint8_t* const* rows, int pixelSize, int x, int width, const YpCbCrCoefficients& c, const YpCbCrOutput& output) {
+		const Shuffle& shuffle = pixelSize == 3 ? packedToPlanar : packed4ToPlanar;
+		__m128i masks[3][4];
+		for (int k = 0; k < 3; k++) {
+			for (int j = 0; j < 4; j++) masks[k][j] = _mm_load_si128((const __m128i*)shuffle.masks[k][j]);
+		}
+
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i ones = _mm_set1_epi16(1);
+		const __m128i lumaRed = _mm_set1_epi16((short)c.yRed), lumaGreen = _mm_set1_epi16((short)c.yGreen), lumaBlue = _mm_set1_epi16((short)c.yBlue);
+		const __m128i lumaRounding = _mm_set1_epi16(128), lumaOffset = _mm_set1_epi16((short)c.yOffset);
+		const __m128i blueRedGreen = _mm_set1_epi32(pairOf(c.cbRed, c.cbGreen)), blueBlueOne = _mm_set1_epi32(pairOf(c.cbBlue, 1));
+		const __m128i redRedGreen = _mm_set1_epi32(pairOf(c.crRed, c.crGreen)), redBlueOne = _mm_set1_epi32(pairOf(c.crBlue, 1));
+		const __m128i chromaRounding = _mm_set1_epi16(512), chromaOffset = _mm_set1_epi32(128);
+
+		for (; x + 16 <= width; x += 16) {
+			__m128i channels[2][3]; // Red, green and blue of both rows
+			__m128i luma[2];
+
+			for (int row = 0; row < 2; row++) {
+				__m128i input[4];
+				for (int j = 0; j < pixelSize; j++) input[j] = _mm_loadu_si128((const __m128i*)(rows[row] + x * pixelSize + 16 * j));
+				for (int k = 0; k < 3; k++) {
+					__m128i channel = _mm_shuffle_epi8(input[0], masks[k][0]);
+					for (int j = 1; j < pixelSize; j++) channel = _mm_or_si128(channel, _mm_shuffle_epi8(input[j], masks[k][j]));
+					channels[row][k] = channel;
+				}
+
+				__m128i halves[2];
+				for (int half = 0; half < 2; half++) {
+					__m128i red = half == 0 ? _mm_unpacklo_epi8(channels[row][0], zero) : _mm_unpackhi_epi8(channels[row][0], zero);
+					__m128i green = half == 0 ? _mm_unpacklo_epi8(channels[row][1], zero) : _mm_unpackhi_epi8(channels[row][1], zero);
+					__m128i blue = half == 0 ? _mm_unpacklo_epi8(channels[row][2], zero) : _mm_unpackhi_epi8(channels[row][2], zero);
+					__m128i sum = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(red, lumaRed), _mm_mullo_epi16(green, lumaGreen)), _mm_add_epi16(_mm_mullo_epi16(blue, lumaBlue), lumaRounding));
+					halves[half] = _mm_add_epi16(_mm_srli_epi16(sum, 8), lumaOffset);
+				}
+				luma[row] = _mm_packus_epi16(halves[0], halves[1]);
+			}
+
+			// Sums of the 2x2 pixels of every chroma sample (8 of them)
+			__m128i sums[3];
+			for (int k = 0; k < 3; k++) {
+				__m128i low = _mm_add_epi16(_mm_unpacklo_epi8(channels[0][k], zero), _mm_unpacklo_epi8(channels[1][k], zero));
+				__m128i high = _mm_add_epi16(_mm_unpackhi_epi8(channels[0][k], zero), _mm_unpackhi_epi8(channels[1][k], zero));
+				sums[k] = _mm_packs_epi32(_mm_madd_epi16(low, ones), _mm_madd_epi16(high, ones));
+			}
+
+			__m128i redGreenLow = _mm_unpacklo_epi16(sums[0], sums[1]), redGreenHigh = _mm_unpackhi_epi16(sums[0], sums[1]);
+			__m128i blueRoundingLow = _mm_unpacklo_epi16(sums[2], chromaRounding), blueRoundingHigh = _mm_unpackhi_epi16(sums[2], chromaRounding);
+
+			__m128i blueLow = _mm_add_epi32(_mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(redGreenLow, blueRedGreen), _mm_madd_epi16(blueRoundingLow, blueBlueOne)), 10), chromaOffset);
+			__m128i blueHigh = _mm_add_epi32(_mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(redGreenHigh, blueRedGreen), _mm_madd_epi16(blueRoundingHigh, blueBlueOne)), 10), chromaOffset);
+			__m128i redLow = _mm_add_epi32(_mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(redGreenLow, redRedGreen), _mm_madd_epi16(blueRoundingLow, redBlueOne)), 10), chromaOffset);
+			__m128i redHigh = _mm_add_epi32(_mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(redGreenHigh, redRedGreen), _mm_madd_epi16(blueRoundingHigh, redBlueOne)), 10), chromaOffset);
+
+			__m128i blue = _mm_packus_epi16(_mm_packs_epi32(blueLow, blueHigh), zero); // 8 bytes
+			__m128i red = _mm_packus_epi16(_mm_packs_epi32(redLow, redHigh), zero);
+
+			if (output.layout == PIXEL_YPCBCR_422_2VUY) {
+				__m128i chroma = _mm_unpacklo_epi8(blue, red);
+				_mm_storeu_si128((__m128i*)(output.packed + x * 2), _mm_unpacklo_epi8(chroma, luma[0]));
+				_mm_storeu_si128((__m128i*)(output.packed + x * 2 + 16), _mm_unpackhi_epi8(chroma, luma[0]));
+				continue;
+			}
+
+			_mm_storeu_si128((__m128i*)(output.luma[0] + x), luma[0]);
+			_mm_storeu_si128((__m128i*)(output.luma[1] + x), luma[1]);
+			if (output.layout == PIXEL_YPCBCR_420_PLANAR) {
+				_mm_storel_epi64((__m128i*)(output.blue + x / 2), blue);
+				_mm_storel_epi64((__m128i*)(output.red + x / 2), red);
+			}
+			else {
+				_mm_storeu_si128((__m128i*)(output.chroma + x), _mm_unpacklo_epi8(blue, red));
+			}
+		}
+
+		return x;
+	}
+
+	// Same as the SSSE3 version, with 16 more pixels in the upper half of the registers
+	PIXEL_CONVERT_TARGET("avx2") int convertYpCbCrAVX2(const uint8_t* const* rows, int pixelSize, int x, int width, const YpCbCrCoefficients& c, const YpCbCrOutput& output) {
+		const Shuffle& shuffle = pixelSize == 3 ? packedToPlanar : packed4ToPlanar;
+		__m256i masks[3][4];
+		for (int k = 0; k < 3; k++) {
+			for (int j = 0; j < 4; j++) masks[k][j] = _mm256_broadcastsi128_si256(_mm_load_si128((const __m128i*)shuffle.masks[k][j]));
+		}
+
+		const __m256i zero = _mm256_setzero_si256();
+		const __m256i ones = _mm256_set1_epi16(1);
+		const __m256i lumaRed = _mm256_set1_epi16((short)c.yRed), lumaGreen = _mm256_set1_epi16((short)c.yGreen), lumaBlue = _mm256_set1_epi16((short)c.yBlue);
+		const __m256i lumaRounding = _mm256_set1_epi16(128), lumaOffset = _mm256_set1_epi16((short)c.yOffset);
+		const __m256i blueRedGreen = _mm256_set1_epi32(pairOf(c.cbRed, c.cbGreen)), blueBlueOne = _mm256_set1_epi32(pairOf(c.cbBlue, 1));
+		const __m256i redRedGreen = _mm256_set1_epi32(pairOf(c.crRed, c.crGreen)), redBlueOne = _mm256_set1_epi32(pairOf(c.crBlue, 1));
+		const __m256i chromaRounding = _mm256_set1_epi16(512), chromaOffset = _mm256_set1_epi32(128);
+
+		for (; x + 32 <= width; x += 32) {
+			__m256i channels[2][3];
+			__m256i luma[2];
+
+			for (int row = 0; row < 2; row++) {
+				__m256i input[4];
+				for (int j = 0; j < pixelSize; j++) {
+					const uint8_t* first = rows[row] + x * pixelSize + 16 * j;
+					input[j] = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)first)), _mm_loadu_si128((const __m128i*)(first + 16 * pixelSize)), 1);
+				}
+				for (int k = 0; k < 3; k++) {
+					__m256i channel = _mm256_shuffle_epi8(input[0], masks[k][0]);
+					for (int j = 1; j < pixelSize; j++) channel = _mm256_or_si256(channel, _mm256_shuffle_epi8(input[j], masks[k][j]));
+					channels[row][k] = channel;
+				}
+
+				__m256i halves[2];
+				for (int half = 0; half < 2; half++) {
+					__m256i red = half == 0 ? _mm256_unpacklo_epi8(channels[row][0], zero) : _mm256_unpackhi_epi8(channels[row][0], zero);
+					__m256i green = half == 0 ? _mm256_unpacklo_epi8(channels[row][1], zero) : _mm256_unpackhi_epi8(channels[row][1], zero);
+					__m256i blue = half == 0 ? _mm256_unpacklo_epi8(channels[row][2], zero) : _mm256_unpackhi_epi8(channels[row][2], zero);
+					__m256i sum = _mm256_add_epi16(_mm256_add_epi16(_mm256_mullo_epi16(red, lumaRed), _mm256_mullo_epi16(green, lumaGreen)), _mm256_add_epi16(_mm256_mullo_epi16(blue, lumaBlue), lumaRounding));
+					halves[half] = _mm256_add_epi16(_mm256_srli_epi16(sum, 8), lumaOffset);
+				}
+				luma[row] = _mm256_packus_epi16(halves[0], halves[1]);
+			}
+
+			__m256i sums[3];
+			for (int k = 0; k < 3; k++) {
+				__m256i low = _mm256_add_epi16(_mm256_unpacklo_epi8(channels[0][k], zero), _mm256_unpacklo_epi8(channels[1][k], zero));
+				__m256i high = _mm256_add_epi16(_mm256_unpackhi_epi8(channels[0][k], zero), _mm256_unpackhi_epi8(channels[1][k], zero));
+				sums[k] = _mm256_packs_epi32(_mm256_madd_epi16(low, ones), _mm256_madd_epi16(high, ones));
+			}
+
+			__m256i redGreenLow = _mm256_unpacklo_epi16(sums[0], sums[1]), redGreenHigh = _mm256_unpackhi_epi16(sums[0], sums[1]);
+			__m256i blueRoundingLow = _mm256_unpacklo_epi16(sums[2], chromaRounding), blueRoundingHigh = _mm256_unpackhi_epi16(sums[2], chromaRounding);
+
+			__m256i blueLow = _mm256_add_epi32(_mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(redGreenLow, blueRedGreen), _mm256_madd_epi16(blueRoundingLow, blueBlueOne)), 10), chromaOffset);
+			__m256i blueHigh = _mm256_add_epi32(_mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(redGreenHigh, blueRedGreen), _mm256_madd_epi16(blueRoundingHigh, blueBlueOne)), 10), chromaOffset);
+			__m256i redLow = _mm256_add_epi32(_mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(redGreenLow, redRedGreen), _mm256_madd_epi16(blueRoundingLow, redBlueOne)), 10), chromaOffset);
+			__m256i redHigh = _mm256_add_epi32(_mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(redGreenHigh, redRedGreen), _mm256_madd_epi16(blueRoundingHigh, redBlueOne)), 10), chromaOffset);
+
+			__m256i blue = _mm256_packus_epi16(_mm256_packs_epi32(blueLow, blueHigh), zero); // 8 bytes in each half
+			__m256i red = _mm256_packus_epi16(_mm256_packs_epi32(redLow, redHigh), zero);
+
+			for (int half = 0; half < 2; half++) {
+				__m128i halfBlue = half == 0 ? _mm256_castsi256_si128(blue) : _mm256_extracti128_si256(blue, 1);
+				__m128i halfRed = half == 0 ? _mm256_castsi256_si128(red) : _mm256_extracti128_si256(red, 1);
+				__m128i halfLuma[2];
+				for (int row = 0; row < 2; row++) halfLuma[row] = half == 0 ? _mm256_castsi256_si128(luma[row]) : _mm256_extracti128_si256(luma[row], 1);
+				int halfX = x + half * 16;
+
+				if (output.layout == PIXEL_YPCBCR_422_2VUY) {
+					__m128i chroma = _mm_unpacklo_epi8(halfBlue, halfRed);
+					_mm_storeu_si128((__m128i*)(output.packed + halfX * 2), _mm_unpacklo_epi8(chroma, halfLuma[0]));
+					_mm_storeu_si128((__m128i*)(output.packed + halfX * 2 + 16), _mm_unpackhi_epi8(chroma, halfLuma[0]));
+					continue;
+				}
+
+				_mm_storeu_si128((__m128i*)(output.luma[0] + halfX), halfLuma[0]);
+				_mm_storeu_si128((__m128i*)(output.luma[1] + halfX), halfLuma[1]);
+				if (output.layout == PIXEL_YPCBCR_420_PLANAR) {
+					_mm_storel_epi64((__m128i*)(output.blue + halfX / 2), halfBlue);
+					_mm_storel_epi64((__m128i*)(output.red + halfX / 2), halfRed);
+				}
+				else {
+					_mm_storeu_si128((__m128i*)(output.chroma + halfX), _mm_unpacklo_epi8(halfBlue, halfRed));
+				}
+			}
+		}
+
+		return convertYpCbCrSSSE3(rows, pixelSize, x, width, c, output);
+	}
+#endif
+
+#ifdef PIXEL_CONVERT_ARM
+	int16x8_t pairSums(uint8x16_t first, uint8x16_t second) {
+		return vreinterpretq_s16_u16(vaddq_u16(vpaddlq_u8(first), vpaddlq_u8(second)));
+	}
+
+	uint8x8_t chromaOf(int16x8_t red, int16x8_t green, int16x8_t blue, int redCoefficient, int greenCoefficient, int blueCoefficient) {
+		int32x4_t halves[2];
+		for (int half = 0; half < 2; half++) {
+			int16x4_t r = half == 0 ? vget_low_s16(red) : vget_high_s16(red);
+			int16x4_t g = half == 0 ? vget_low_s16(green) : vget_high_s16(green);
+			int16x4_t b = half == 0 ? vget_low_s16(blue) : vget_high_s16(blue);
+			int32x4_t sum = vmlal_n_s16(vmlal_n_s16(vmull_n_s16(r, (int16_t)redCoefficient), g, (int16_t)greenCoefficient), b, (int16_t)blueCoefficient);
+			halves[half] = vaddq_s32(vshrq_n_s32(vaddq_s32(sum, vdupq_n_s32(512)), 10), vdupq_n_s32(128));
+		}
+		return vqmovun_s16(vcombine_s16(vmovn_s32(halves[0]), vmovn_s32(halves[1])));
+	}
+
+	// 16 pixels of both rows at a time, starting at pixel x. Returns the first pixel left for the scalar code
+	int convertYpCbCrNEON(const uint8_t* const* rows, int pixelSize, int x, int width, const YpCbCrCoefficients& c, const YpCbCrOutput& output) {
+		const uint8x8_t lumaRed = vdup_n_u8((uint8_t)c.yRed), lumaGreen = vdup_n_u8((uint8_t)c.yGreen), lumaBlue = vdup_n_u8((uint8_t)c.yBlue);
+		const uint16x8_t lumaRounding = vdupq_n_u16(128);
+		const uint8x16_t lumaOffset = vdupq_n_u8((uint8_t)c.yOffset);
+
+		for (; x + 16 <= width; x += 16) {
+			uint8x16_t channels[2][3];
+			uint8x16_t luma[2];
+
+			for (int row = 0; row < 2; row++) {
+				const uint8_t* pixels = rows[row] + x * pixelSize;
+				if (pixelSize == 3) {
+					uint8x16x3_t input = vld3q_u8(pixels);
+					for (int k = 0; k < 3; k++) channels[row][k] = input.val[k];
+				}
+				else {
+					uint8x16x4_t input = vld4q_u8(pixels);
+					for (int k = 0; k < 3; k++) channels[row][k] = input.val[k];
+				}
+
+				uint16x8_t low = vmull_u8(vget_low_u8(channels[row][0]), lumaRed);
+				low = vmlal_u8(low, vget_low_u8(channels[row][1]), lumaGreen);
+				low = vmlal_u8(low, vget_low_u8(channels[row][2]), lumaBlue);
+				uint16x8_t high = vmull_u8(vget_high_u8(channels[row][0]), lumaRed);
+				high = vmlal_u8(high, vget_high_u8(channels[row][1]), lumaGreen);
+				high = vmlal_u8(high, vget_high_u8(channels[row][2]), lumaBlue);
+				luma[row] = vaddq_u8(vcombine_u8(vshrn_n_u16(vaddq_u16(low, lumaRounding), 8), vshrn_n_u16(vaddq_u16(high, lumaRounding), 8)), lumaOffset);
+			}
+
+			int16x8_t redSums = pairSums(channels[0][0], channels[1][0]);
+			int16x8_t greenSums = pairSums(channels[0][1], channels[1][1]);
+			int16x8_t blueSums = pairSums(channels[0][2], channels[1][2]);
+			uint8x8_t blue = chromaOf(redSums, greenSums, blueSums, c.cbRed, c.cbGreen, c.cbBlue);
+			uint8x8_t red = chromaOf(redSums, greenSums, blueSums, c.crRed, c.crGreen, c.crBlue);
+
+			if (output.layout == PIXEL_YPCBCR_422_2VUY) {
+				uint8x8x4_t packed = { { blue, vget_low_u8(vuzp1q_u8(luma[0], luma[0])), red, vget_low_u8(vuzp2q_u8(luma[0], luma[0])) } };
+				vst4_u8(output.packed + x * 2, packed);
+				continue;
+			}
+
+			vst1q_u8(output.luma[0] + x, luma[0]);
+			vst1q_u8(output.luma[1] + x, luma[1]);
+			if (output.layout == PIXEL_YPCBCR_420_PLANAR) {
+				vst1_u8(output.blue + x / 2, blue);
+				vst1_u8(output.red + x / 2, red);
+			}
+			else {
+				uint8x8x2_t chroma = { { blue, red } };
+				vst2_u8(output.chroma + x, chroma);
+			}
+		}
+
+		return x;
+	}
+#endif
+}
+
+unsigned char* pixelBufferPoolGet(PixelBufferPool* pool, size_t size) {
+	if (size <= pool->capacity) return pool->data;
+
+	pixelBufferPoolRelease(pool);
+
+	size_t alignedSize = (size + PIXEL_CONVERT_ALIGNMENT - 1) / PIXEL_CONVERT_ALIGNMENT * PIXEL_CONVERT_ALIGNMENT;
+#ifdef _WIN32
+	pool->data = (unsigned char*)_aligned_malloc(alignedSize, PIXEL_CONVERT_ALIGNMENT);
+#else
+	void* data = nullptr;
+	pool->data = posix_memalign(&data, PIXEL_CONVERT_ALIGNMENT, alignedSize) == 0 ? (unsigned char*)data : nullptr;
+#endif
+
+	if (pool->data == nullptr) {
+		std::cout << "[ERROR] Couldn't allocate " << size << " bytes of pixels." << std::endl;
+		return nullptr;
+	}
+
+	pool->capacity = alignedSize;
+	return pool->data;
+}
+
+void pixelBufferPoolRelease(PixelBufferPool* pool) {
+#ifdef _WIN32
+	_aligned_free(pool->data);
+#else
+	free(pool->data);
+#endif
+	pool->data = nullptr;
+	pool->capacity = 0;
+}
+
+int pixelConvertGetInstructionSet(void) {
+	return pixelConvert::instructionSet;
+}
+
+int pixelConvertLimitInstructionSet(int instructionSet) {
+	// NEON is the only option on ARM, so any limit but scalar keeps it
+	if (pixelConvert::supportedInstructionSet == PIXEL_CONVERT_NEON) pixelConvert::instructionSet = instructionSet == PIXEL_CONVERT_SCALAR ? PIXEL_CONVERT_SCALAR : PIXEL_CONVERT_NEON;
+	else pixelConvert::instructionSet = std::min(std::max(instructionSet, PIXEL_CONVERT_SCALAR), pixelConvert::supportedInstructionSet);
+
+	return pixelConvert::instructionSet;
+}
+
+void pixelConvertRGB888ToPlanar8(const unsigned char* source, ptrdiff_t sourceRowBytes, unsigned char* const planes[3], size_t planeRowBytes, int width, int height) {
+	for (int y = 0; y < height; y++) {
+		const uint8_t* input = source + y * sourceRowBytes;
+		uint8_t* outputs[3] = { planes[0] + y * planeRowBytes, planes[1] + y * planeRowBytes, planes[2] + y * planeRowBytes };
+		pixelConvert::shuffleRow(pixelConvert::packedToPlanar, &input, outputs, width);
+	}
+}
+
+void pixelConvertPlanar8ToRGB888(const unsigned char* const planes[3], size_t planeRowBytes, unsigned char* destination, ptrdiff_t destinationRowBytes, int width, int height) {
+	for (int y = 0; y < height; y++) {
+		const uint8_t* inputs[3] = { planes[0] + y * planeRowBytes, planes[1] + y * planeRowBytes, planes[2] + y * planeRowBytes };
+		uint8_t* output = destination + y * destinationRowBytes;
+		pixelConvert::shuffleRow(pixelConvert::planarToPacked, inputs, &output, width);
+	}
+}
+
+void pixelConvertSwapRB888(const unsigned char* source, ptrdiff_t sourceRowBytes, unsigned char* destination, ptrdiff_t destinationRowBytes, int width, int height) {
+	pixelConvert::shufflePacked(pixelConvert::swapRB, source, sourceRowBytes, destination, destinationRowBytes, width, height);
+}
+
+void pixelConvertPermute8888(const unsigned char* source, ptrdiff_t sourceRowBytes, unsigned char* destination, ptrdiff_t destinationRowBytes, int width, int height, const unsigned char order[4]) {
+	int sourceChannels[4] = { order[0] & 3, order[1] & 3, order[2] & 3, order[3] & 3 };
+	pixelConvert::Shuffle permute = pixelConvert::makeShuffle(4, 4, 4, 4, 4, sourceChannels);
+	pixelConvert::shufflePacked(permute, source, sourceRowBytes, destination, destinationRowBytes, width, height);
+}
+
+void pixelConvertRGBA8888ToRGB888(const unsigned char* source, ptrdiff_t sourceRowBytes, unsigned char* destination, ptrdiff_t destinationRowBytes, int width, int height) {
+	pixelConvert::shufflePacked(pixelConvert::dropAlpha, source, sourceRowBytes, destination, destinationRowBytes, width, height);
+}
+
+int pixelConvertRGBToYpCbCr(const unsigned char* source, ptrdiff_t sourceRowBytes, int sourcePixelSize, int width, int height,
+	int layout, int fullRange, unsigned char* const planes[3], const size_t planeRowBytes[3]) {
+	bool subsampledRows = layout != PIXEL_YPCBCR_422_2VUY;
+	if ((sourcePixelSize != 3 && sourcePixelSize != 4) || layout < PIXEL_YPCBCR_420_PLANAR || layout > PIXEL_YPCBCR_422_2VUY
+		|| width % 2 != 0 || (subsampledRows && height % 2 != 0)) {
+		return 0;
+	}
+
+	const pixelConvert::YpCbCrCoefficients& coefficients = fullRange ? pixelConvert::fullRange : pixelConvert::videoRange;
+
+	for (int y = 0; y < height; y += subsampledRows ? 2 : 1) {
+		// 4:2:2 averages the pixels of a single row, which is the same as averaging it with itself
+		const uint8_t* rows[2] = { source + y * sourceRowBytes, source + (subsampledRows ? y + 1 : y) * sourceRowBytes };
+
+		pixelConvert::YpCbCrOutput output = {};
+		output.layout = layout;
+		if (layout == PIXEL_YPCBCR_422_2VUY) {
+			output.packed = planes[0] + y * planeRowBytes[0];
+		}
+		else {
+			output.luma[0] = planes[0] + y * planeRowBytes[0];
+			output.luma[1] = planes[0] + (y + 1) * planeRowBytes[0];
+			if (layout == PIXEL_YPCBCR_420_PLANAR) {
+				output.blue = planes[1] + y / 2 * planeRowBytes[1];
+				output.red = planes[2] + y / 2 * planeRowBytes[2];
+			}
+			else {
+				output.chroma = planes[1] + y / 2 * planeRowBytes[1];
+			}
+		}
+
+		int x = 0;
+		switch (pixelConvert::instructionSet) {
+#ifdef PIXEL_CONVERT_X86
+		case PIXEL_CONVERT_AVX2:
+			x = pixelConvert::convertYpCbCrAVX2(rows, sourcePixelSize, 0, width, coefficients, output);
+			break;
+		case PIXEL_CONVERT_SSSE3:
+			x = pixelConvert::convertYpCbCrSSSE3(rows, sourcePixelSize, 0, width, coefficients, output);
+			break;
+#endif
+#ifdef PIXEL_CONVERT_ARM
+		case PIXEL_CONVERT_NEON:
+			x = pixelConvert::convertYpCbCrNEON(rows, sourcePixelSize, 0, width, coefficients, output);
+			break;
+#endif
+		default:
+			break;
+		}
+
+		for (; x < width; x += 2) {
+			pixelConvert::convertYpCbCrBlock(rows, sourcePixelSize, x, coefficients, output);
+		}
+	}
+
+	return 1;
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <stddef.h>
+
+// Pixel format conversions of the pixel buffer path (EEPixelViewer, frame capture), in place of the macOS only vImage functions.
+// Every conversion uses the widest instruction set the CPU has (SSSE3 or AVX2 on x86, NEON on ARM64) and falls back to plain C++.
+// Row strides are in bytes; a negative source stride reads the image from the bottom row up (e.g. pixels read back from OpenGL)
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PIXEL_CONVERT_SCALAR 0
+#define PIXEL_CONVERT_SSSE3 1
+#define PIXEL_CONVERT_AVX2 2
+#define PIXEL_CONVERT_NEON 3
+
+// Layouts of the Y'CbCr conversions
+#define PIXEL_YPCBCR_420_PLANAR 0 // Y', Cb and Cr planes, chroma at half the width and height (I420)
+#define PIXEL_YPCBCR_420_BIPLANAR 1 // Y' plane and interleaved CbCr plane (kCVPixelFormatType_420YpCbCr8BiPlanar*, NV12)
+#define PIXEL_YPCBCR_422_2VUY 2 // Single plane of Cb Y'0 Cr Y'1, chroma at half the width (kCVPixelFormatType_422YpCbCr8)
+
+// Memory that is only reallocated when a bigger size is asked for, so that converting every frame doesn't allocate
+typedef struct PixelBufferPool {
+	unsigned char* data;
+	size_t capacity;
+} PixelBufferPool; // Zero-initialize before the first use
+
+// Aligned for the widest SIMD loads. The previous contents are lost when the pool grows
+unsigned char* pixelBufferPoolGet(PixelBufferPool* pool, size_t size);
+void pixelBufferPoolRelease(PixelBufferPool* pool);
+
+int pixelConvertGetInstructionSet(void);
+// Never uses more than this instruction set (to compare the kernels). Returns the one that will be used
+int pixelConvertLimitInstructionSet(int instructionSet);
+
+// Splits packed 3-byte pixels into 3 planes, planes[i] receiving the channel i of every pixel (vImageConvert_RGB888toPlanar8)
+void pixelConvertRGB888ToPlanar8(const unsigned char* source, ptrdiff_t sourceRowBytes, unsigned char* const planes[3], size_t planeRowBytes, int width, int height);
+// Interleaves 3 planes into packed 3-byte pixels
+void pixelConvertPlanar8ToRGB888(const unsigned char* const planes[3], size_t planeRowBytes, unsigned char* destination, ptrdiff_t destinationRowBytes, int width, int height);
+// RGB to BGR and back
+void pixelConvertSwapRB888(const unsigned char* source, ptrdiff_t sourceRowBytes, unsigned char* destination, ptrdiff_t destinationRowBytes, int width, int height);
+// Reorders the channels of 4-byte pixels, channel i of the destination being channel order[i] of the source (ARGB to RGBA is { 1, 2, 3, 0 })
+void pixelConvertPermute8888(const unsigned char* source, ptrdiff_t sourceRowBytes, unsigned char* destination, ptrdiff_t destinationRowBytes, int width, int height, const unsigned char order[4]);
+// Drops the fourth channel of every pixel
+void pixelConvertRGBA8888ToRGB888(const unsigned char* source, ptrdiff_t sourceRowBytes, unsigned char* destination, ptrdiff_t destinationRowBytes, int width, int height);
+
+// BT.709 Y'CbCr, in video range (Y' 16-235, CbCr 16-240) or full range. The source pixels are 3 or 4 bytes, starting with red, green and blue.
+// Every chroma sample is the average of the pixels it covers. Returns 0 if the size doesn't fit the layout (4:2:0 needs an even width and height, 4:2:2 an even width)
+int pixelConvertRGBToYpCbCr(const unsigned char* source, ptrdiff_t sourceRowBytes, int sourcePixelSize, int width, int height,
+	int layout, int fullRange, unsigned char* const planes[3], const size_t planeRowBytes[3]);
+
+#ifdef __cplusplus
+}
+#endif
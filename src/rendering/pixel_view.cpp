@@ -0,0 +1,44 @@
+#include "pixel_view.h"
+#include "software_renderer.h"
+#include "../universe/scene_loader.h"
+
+#define PIXEL_VIEW_FOV 45.0f // Degrees, same as the window's camera
+#define PIXEL_VIEW_ORBIT_SPEED 0.1f // Radians per second
+
+namespace pixelView {
+	renderer::SoftwareRenderer* softwareRenderer = nullptr;
+	renderer::FrameScene scene;
+}
+
+int pixelViewStart(const char* scenePath) {
+	pixelViewStop();
+
+	Universe* universe = loadScene(scenePath);
+	if (universe == nullptr) return 0;
+
+	pixelView::softwareRenderer = new renderer::SoftwareRenderer();
+	simulation::start(universe);
+	return 1;
+}
+
+void pixelViewRender(unsigned char* pixels, int width, int height, size_t rowBytes, double time) {
+	if (pixelView::softwareRenderer == nullptr || width <= 0 || height <= 0) return;
+
+	simulation::acquireSnapshot();
+	const simulation::Snapshot& snapshot = simulation::getSnapshot();
+
+	glm::vec3 focus = snapshot.bodies.empty() ? glm::vec3(0) : snapshot.bodies[0].position;
+	glm::mat4 view = renderer::getOrbitView(focus, FRAME_CAMERA_DISTANCE, (float)time * PIXEL_VIEW_ORBIT_SPEED);
+	glm::mat4 projection = renderer::getProjection(glm::radians(PIXEL_VIEW_FOV), (float)width / height);
+
+	renderer::buildFrameScene(snapshot, view, projection, pixelView::scene);
+	pixelView::softwareRenderer->render(pixelView::scene, pixels, width, height, rowBytes);
+}
+
+void pixelViewStop(void) {
+	if (pixelView::softwareRenderer == nullptr) return;
+
+	simulation::stop();
+	delete pixelView::softwareRenderer;
+	pixelView::softwareRenderer = nullptr;
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <stddef.h>
+
+// Software rendered view of the simulation for the pixel buffer viewer (Impl_EEPixelViewerGitHub.m), which can't include the C++ headers
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Loads the scene and starts simulating it in real time. Returns 0 if the scene couldn't be loaded
+int pixelViewStart(const char* scenePath);
+// Draws the latest state of the simulation into width * height RGB pixels (rows from top to bottom, rowBytes apart).
+// The camera slowly circles the first body, time being the seconds since the view started
+void pixelViewRender(unsigned char* pixels, int width, int height, size_t rowBytes, double time);
+void pixelViewStop(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,380 @@
+#include "plane_presenter.h"
+#include "renderer.h"
+
+#include <iostream>
+#include <cstring>
+#include <algorithm>
+
+#define PLANE_PRESENTER_PLANE_ALIGNMENT 64 // Bytes, start of every plane in the unpack buffers
+
+namespace renderer {
+	namespace planePresenter {
+		// Texture made from a plane of the pixel buffer
+		struct TextureFormat {
+			int plane;
+			int widthDivisor; // The 4:2:2 chroma texture has a pixel for every two of the plane
+			GLint internalFormat;
+			GLenum format;
+			GLenum type;
+			int bytesPerPixel;
+		};
+
+		enum class ColorRange { None, Video, Full };
+
+		// How a pixel format is uploaded and read back by the shader (same setup as EEPixelViewer setPixelFormat)
+		struct FormatDescription {
+			int planeCount;
+			int textureCount;
+			TextureFormat textures[PLANE_PRESENTER_MAX_PLANES];
+			GLint permuteMap[3];
+			ColorRange range;
+		};
+
+		GLFWwindow* window = nullptr;
+
+		GLuint ProgramID = 0;
+		GLuint TextureUniformIDs[PLANE_PRESENTER_MAX_PLANES];
+		GLuint TextureCountUniformID;
+		GLuint PermuteMapUniformID;
+		GLuint YpCbCrUniformID;
+		GLuint CoefficientMatrixUniformID;
+		GLuint YpCbCrOffsetsUniformID;
+		GLuint VertexArrayID = 0;
+
+		FormatDescription description;
+		bool hasFormat = false;
+
+		GLuint TextureIDs[PLANE_PRESENTER_MAX_PLANES] = {};
+		int textureWidths[PLANE_PRESENTER_MAX_PLANES] = {};
+		int textureHeights[PLANE_PRESENTER_MAX_PLANES] = {};
+
+		GLuint BufferIDs[PLANE_PRESENTER_BUFFER_COUNT] = {};
+		GLsync bufferFences[PLANE_PRESENTER_BUFFER_COUNT] = {}; // Signaled once the textures have been updated from the buffer
+		size_t bufferCapacity = 0;
+		unsigned long long presentedFrameCount = 0;
+
+		// BT.601, like EEPixelViewer
+		const GLfloat videoRangeMatrix[16] = {
+			1.1643f, 0.0f, 1.5958f, 0.0f,
+			1.1643f, -0.39173f, -0.81290f, 0.0f,
+			1.1643f, 2.017f, 0.0f, 0.0f,
+			0.0f, 0.0f, 0.0f, 1.0f
+		};
+		const GLfloat fullRangeMatrix[16] = {
+			1.0f, 0.0f, 1.402f, 0.0f,
+			1.0f, -0.34414f, -0.71414f, 0.0f,
+			1.0f, 1.772f, 0.0f, 0.0f,
+			0.0f, 0.0f, 0.0f, 1.0f
+		};
+
+		TextureFormat textureFormat(int plane, GLint internalFormat, GLenum format, GLenum type, int bytesPerPixel, int widthDivisor = 1) {
+			return { plane, widthDivisor, internalFormat, format, type, bytesPerPixel };
+		}
+
+		bool describe(PixelFormat format, FormatDescription& result) {
+			const TextureFormat R8 = textureFormat(0, GL_R8, GL_RED, GL_UNSIGNED_BYTE, 1);
+			const TextureFormat RGB8 = textureFormat(0, GL_RGB8, GL_RGB, GL_UNSIGNED_BYTE, 3);
+			const TextureFormat RGBA8 = textureFormat(0, GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, 4);
+
+			switch (format) {
+			case PixelFormat::RGB24: result = { 1, 1, { RGB8 }, { 0, 1, 2 }, ColorRange::None }; return true;
+			case PixelFormat::BGR24: result = { 1, 1, { RGB8 }, { 2, 1, 0 }, ColorRange::None }; return true;
+			case PixelFormat::ARGB32: result = { 1, 1, { RGBA8 }, { 1, 2, 3 }, ColorRange::None }; return true;
+			case PixelFormat::BGRA32: result = { 1, 1, { RGBA8 }, { 2, 1, 0 }, ColorRange::None }; return true;
+			case PixelFormat::ABGR32: result = { 1, 1, { RGBA8 }, { 3, 2, 1 }, ColorRange::None }; return true;
+			case PixelFormat::RGBA32: result = { 1, 1, { RGBA8 }, { 0, 1, 2 }, ColorRange::None }; return true;
+			case PixelFormat::RGB555LE:
+				result = { 1, 1, { textureFormat(0, GL_RGB5_A1, GL_BGRA, GL_UNSIGNED_SHORT_1_5_5_5_REV, 2) }, { 0, 1, 2 }, ColorRange::None };
+				return true;
+			case PixelFormat::RGB5551LE:
+				result = { 1, 1, { textureFormat(0, GL_RGB5_A1, GL_RGBA, GL_UNSIGNED_SHORT_5_5_5_1, 2) }, { 0, 1, 2 }, ColorRange::None };
+				return true;
+			case PixelFormat::RGB565LE:
+				result = { 1, 1, { textureFormat(0, GL_RGB8, GL_RGB, GL_UNSIGNED_SHORT_5_6_5, 2) }, { 0, 1, 2 }, ColorRange::None };
+				return true;
+			case PixelFormat::YpCbCr422:
+				// The plane is read twice: as pairs of bytes for Y', and as a texture of half the width for the Cb and Cr of every two pixels
+				result = { 1, 2, { textureFormat(0, GL_RG8, GL_RG, GL_UNSIGNED_BYTE, 2), textureFormat(0, GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, 4, 2) }, { 1, 0, 2 }, ColorRange::Video };
+				return true;
+			case PixelFormat::YpCbCr444: result = { 1, 1, { RGB8 }, { 1, 2, 0 }, ColorRange::Video }; return true;
+			case PixelFormat::YpCbCrA4444: result = { 1, 1, { RGBA8 }, { 1, 0, 2 }, ColorRange::Video }; return true;
+			case PixelFormat::AYpCbCr4444: result = { 1, 1, { RGBA8 }, { 1, 2, 3 }, ColorRange::Video }; return true;
+			case PixelFormat::YpCbCr420Planar:
+			case PixelFormat::YpCbCr420PlanarFullRange:
+				result = { 3, 3, { R8, textureFormat(1, GL_R8, GL_RED, GL_UNSIGNED_BYTE, 1), textureFormat(2, GL_R8, GL_RED, GL_UNSIGNED_BYTE, 1) }, { 0, 0, 0 },
+					format == PixelFormat::YpCbCr420Planar ? ColorRange::Video : ColorRange::Full };
+				return true;
+			case PixelFormat::YpCbCr420BiPlanarVideoRange:
+			case PixelFormat::YpCbCr420BiPlanarFullRange:
+				result = { 2, 2, { R8, textureFormat(1, GL_RG8, GL_RG, GL_UNSIGNED_BYTE, 2) }, { 0, 0, 1 },
+					format == PixelFormat::YpCbCr420BiPlanarVideoRange ? ColorRange::Video : ColorRange::Full };
+				return true;
+			}
+
+			return false;
+		}
+
+		// Destroys the window of a failed init, before any of the other objects are created
+		static void closeWindow() {
+			glfwDestroyWindow(window);
+			window = nullptr;
+			glfwTerminate();
+		}
+
+		bool init(int width, int height, const char* title) {
+			if (!glfwInit())
+				return false;
+
+			glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+			glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+			glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+#ifdef __APPLE__
+			glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+			window = glfwCreateWindow(width, height, title, NULL, NULL);
+			if (!window) {
+				glfwTerminate();
+				return false;
+			}
+
+			glfwMakeContextCurrent(window);
+			GLenum glewResult = glewInit();
+			if (glewResult != GLEW_OK) {
+				std::cout << "[ERROR] Could not initialize GLEW: " << glewGetErrorString(glewResult) << std::endl;
+				closeWindow();
+				return false;
+			}
+
+			// LoadShaderProgram only returns 0 when a file is missing, a program that didn't link is detected here
+			ProgramID = LoadShaderProgram("shaders/pixelbuffer/vertexShader.glsl", "shaders/pixelbuffer/fragmentShader.glsl");
+			GLint linked = GL_FALSE;
+			if (ProgramID != 0) glGetProgramiv(ProgramID, GL_LINK_STATUS, &linked);
+			if (linked != GL_TRUE) {
+				std::cout << "[ERROR] Could not load the pixel buffer shaders." << std::endl;
+				if (ProgramID != 0) glDeleteProgram(ProgramID);
+				ProgramID = 0;
+				closeWindow();
+				return false;
+			}
+
+			TextureUniformIDs[0] = glGetUniformLocation(ProgramID, "Texture1");
+			TextureUniformIDs[1] = glGetUniformLocation(ProgramID, "Texture2");
+			TextureUniformIDs[2] = glGetUniformLocation(ProgramID, "Texture3");
+			TextureCountUniformID = glGetUniformLocation(ProgramID, "TextureCount");
+			PermuteMapUniformID = glGetUniformLocation(ProgramID, "PermuteMap");
+			YpCbCrUniformID = glGetUniformLocation(ProgramID, "YpCbCr");
+			CoefficientMatrixUniformID = glGetUniformLocation(ProgramID, "CoefficientMatrix");
+			YpCbCrOffsetsUniformID = glGetUniformLocation(ProgramID, "YpCbCrOffsets");
+
+			glUseProgram(ProgramID);
+			for (int i = 0; i < PLANE_PRESENTER_MAX_PLANES; i++) glUniform1i(TextureUniformIDs[i], i);
+			glUseProgram(0);
+
+			glGenVertexArrays(1, &VertexArrayID); // Core profile draws need one, even without vertex attributes
+			glGenTextures(PLANE_PRESENTER_MAX_PLANES, TextureIDs);
+			glGenBuffers(PLANE_PRESENTER_BUFFER_COUNT, BufferIDs);
+
+			for (int i = 0; i < PLANE_PRESENTER_MAX_PLANES; i++) {
+				glBindTexture(GL_TEXTURE_2D, TextureIDs[i]);
+				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+			}
+			glBindTexture(GL_TEXTURE_2D, 0);
+
+			return true;
+		}
+
+		GLFWwindow* getWindow() {
+			return window;
+		}
+
+		bool setPixelFormat(PixelFormat format) {
+			FormatDescription newDescription;
+			if (!describe(format, newDescription)) {
+				std::cout << "[ERROR] Pixel format " << std::hex << (uint32_t)format << std::dec << " isn't supported by the plane presenter." << std::endl;
+				return false;
+			}
+
+			description = newDescription;
+			hasFormat = true;
+
+			// Reallocated by the next frame, in the new format
+			for (int i = 0; i < PLANE_PRESENTER_MAX_PLANES; i++) textureWidths[i] = textureHeights[i] = 0;
+
+			glUseProgram(ProgramID);
+			glUniform1i(TextureCountUniformID, description.textureCount);
+			glUniform3i(PermuteMapUniformID, description.permuteMap[0], description.permuteMap[1], description.permuteMap[2]);
+			glUniform1i(YpCbCrUniformID, description.range != ColorRange::None);
+			if (description.range == ColorRange::Video) {
+				glUniformMatrix4fv(CoefficientMatrixUniformID, 1, GL_FALSE, videoRangeMatrix);
+				glUniform4f(YpCbCrOffsetsUniformID, 0.0625f, 0.5f, 0.5f, 0.0f);
+			}
+			else if (description.range == ColorRange::Full) {
+				glUniformMatrix4fv(CoefficientMatrixUniformID, 1, GL_FALSE, fullRangeMatrix);
+				glUniform4f(YpCbCrOffsetsUniformID, 0.0f, 0.5f, 0.5f, 0.0f);
+			}
+			glUseProgram(0);
+
+			return true;
+		}
+
+		// Only reallocates the textures whose size changed
+		void allocateTextures(const Plane* planes) {
+			for (int i = 0; i < description.textureCount; i++) {
+				const TextureFormat& texture = description.textures[i];
+				int width = planes[texture.plane].width / texture.widthDivisor;
+				int height = planes[texture.plane].height;
+				if (width == textureWidths[i] && height == textureHeights[i]) continue;
+
+				glBindTexture(GL_TEXTURE_2D, TextureIDs[i]);
+				glTexImage2D(GL_TEXTURE_2D, 0, texture.internalFormat, width, height, 0, texture.format, texture.type, NULL);
+				textureWidths[i] = width;
+				textureHeights[i] = height;
+			}
+			glBindTexture(GL_TEXTURE_2D, 0);
+		}
+
+		// Bytes of the plane rows that are displayed (the first texture of a plane always has a pixel for every pixel of the plane)
+		size_t getRowSize(int planeIndex, const Plane& plane) {
+			for (int i = 0; i < description.textureCount; i++) {
+				const TextureFormat& texture = description.textures[i];
+				if (texture.plane == planeIndex) return (size_t)plane.width * texture.bytesPerPixel;
+			}
+			return 0;
+		}
+
+		// The rows keep the stride of the pixel buffer when the textures can be read with it, so that a plane is copied at once
+		bool canKeepStride(int planeIndex, size_t rowBytes) {
+			for (int i = 0; i < description.textureCount; i++) {
+				const TextureFormat& texture = description.textures[i];
+				if (texture.plane == planeIndex && rowBytes % texture.bytesPerPixel != 0) return false;
+			}
+			return true;
+		}
+
+		// Waits until the textures were updated from the buffer the last time it was used (almost never, with several buffers in the ring)
+		void waitForBuffer(int bufferIndex) {
+			if (bufferFences[bufferIndex] == 0) return;
+
+			while (glClientWaitSync(bufferFences[bufferIndex], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000) == GL_TIMEOUT_EXPIRED) {}
+			glDeleteSync(bufferFences[bufferIndex]);
+			bufferFences[bufferIndex] = 0;
+		}
+
+		void present(const Plane* planes, int planeCount) {
+			int framebufferWidth, framebufferHeight;
+			glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+			glViewport(0, 0, framebufferWidth, framebufferHeight);
+			glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+			glClear(GL_COLOR_BUFFER_BIT);
+
+			bool valid = hasFormat && planeCount >= description.planeCount && planes[0].width > 0 && planes[0].height > 0;
+			for (int i = 0; valid && i < description.planeCount; i++) {
+				valid = planes[i].data != nullptr && planes[i].width > 0 && planes[i].height > 0 && planes[i].rowBytes >= getRowSize(i, planes[i]);
+			}
+			if (description.textureCount > description.planeCount && planes[0].width % 2 != 0) valid = false; // 4:2:2 needs pairs of pixels
+
+			if (valid) {
+				allocateTextures(planes);
+
+				// Where every plane goes in the buffer
+				size_t offsets[PLANE_PRESENTER_MAX_PLANES];
+				size_t strides[PLANE_PRESENTER_MAX_PLANES];
+				size_t size = 0;
+				for (int i = 0; i < description.planeCount; i++) {
+					size_t rowSize = getRowSize(i, planes[i]);
+					strides[i] = canKeepStride(i, planes[i].rowBytes) ? planes[i].rowBytes : rowSize;
+					offsets[i] = size;
+					size += strides[i] * (planes[i].height - 1) + rowSize;
+					size = (size + PLANE_PRESENTER_PLANE_ALIGNMENT - 1) / PLANE_PRESENTER_PLANE_ALIGNMENT * PLANE_PRESENTER_PLANE_ALIGNMENT;
+				}
+
+				int bufferIndex = presentedFrameCount % PLANE_PRESENTER_BUFFER_COUNT;
+				if (size > bufferCapacity) {
+					for (int i = 0; i < PLANE_PRESENTER_BUFFER_COUNT; i++) {
+						waitForBuffer(i);
+						glBindBuffer(GL_PIXEL_UNPACK_BUFFER, BufferIDs[i]);
+						glBufferData(GL_PIXEL_UNPACK_BUFFER, size, NULL, GL_STREAM_DRAW);
+					}
+					bufferCapacity = size;
+				}
+				else {
+					waitForBuffer(bufferIndex);
+				}
+
+				// The fence replaces the driver's synchronization: the buffer isn't read by the GPU anymore
+				glBindBuffer(GL_PIXEL_UNPACK_BUFFER, BufferIDs[bufferIndex]);
+				uint8_t* mapped = (uint8_t*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+				if (mapped != nullptr) {
+					for (int i = 0; i < description.planeCount; i++) {
+						const uint8_t* source = (const uint8_t*)planes[i].data;
+						size_t rowSize = getRowSize(i, planes[i]);
+						if (strides[i] == planes[i].rowBytes) {
+							memcpy(mapped + offsets[i], source, strides[i] * (planes[i].height - 1) + rowSize);
+						}
+						else {
+							for (int y = 0; y < planes[i].height; y++) memcpy(mapped + offsets[i] + y * strides[i], source + y * planes[i].rowBytes, rowSize);
+						}
+					}
+
+					if (glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER)) {
+						glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+						for (int i = 0; i < description.textureCount; i++) {
+							const TextureFormat& texture = description.textures[i];
+							glPixelStorei(GL_UNPACK_ROW_LENGTH, (GLint)(strides[texture.plane] / texture.bytesPerPixel));
+							glBindTexture(GL_TEXTURE_2D, TextureIDs[i]);
+							glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, textureWidths[i], textureHeights[i], texture.format, texture.type, (const void*)offsets[texture.plane]);
+						}
+						glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+						glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+						bufferFences[bufferIndex] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+						presentedFrameCount++;
+					}
+				}
+				glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+			}
+
+			if (hasFormat && textureWidths[0] > 0) {
+				// Scaled to fit the window, keeping the aspect ratio
+				float scale = std::min((float)framebufferWidth / textureWidths[0], (float)framebufferHeight / textureHeights[0]);
+				int width = (int)(textureWidths[0] * scale), height = (int)(textureHeights[0] * scale);
+				glViewport((framebufferWidth - width) / 2, (framebufferHeight - height) / 2, width, height);
+
+				glUseProgram(ProgramID);
+				for (int i = 0; i < description.textureCount; i++) {
+					glActiveTexture(GL_TEXTURE0 + i);
+					glBindTexture(GL_TEXTURE_2D, TextureIDs[i]);
+				}
+				glBindVertexArray(VertexArrayID);
+				glDrawArrays(GL_TRIANGLES, 0, 3);
+				glBindVertexArray(0);
+				glActiveTexture(GL_TEXTURE0);
+			}
+
+			glfwSwapBuffers(window);
+			glfwPollEvents();
+		}
+
+		void terminate() {
+			if (window == nullptr) return;
+
+			for (int i = 0; i < PLANE_PRESENTER_BUFFER_COUNT; i++) {
+				if (bufferFences[i] != 0) glDeleteSync(bufferFences[i]);
+				bufferFences[i] = 0;
+			}
+			glDeleteBuffers(PLANE_PRESENTER_BUFFER_COUNT, BufferIDs);
+			glDeleteTextures(PLANE_PRESENTER_MAX_PLANES, TextureIDs);
+			glDeleteVertexArrays(1, &VertexArrayID);
+			glDeleteProgram(ProgramID);
+			bufferCapacity = 0;
+			hasFormat = false;
+
+			glfwTerminate();
+			window = nullptr;
+		}
+	}
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+#include <cstdint>
+#include <cstddef>
+
+#define PLANE_PRESENTER_BUFFER_COUNT 3 // Pixel unpack buffers the frames go through in turns
+#define PLANE_PRESENTER_MAX_PLANES 3
+
+namespace renderer {
+	// Portable version of EEPixelViewer (src/EEPixelViewer, macOS only): shows pixel buffers in a GLFW window.
+	// The textures are only allocated when the format or the size changes. Every frame is copied into the next pixel unpack buffer
+	// of a ring, from which the textures are updated, so the copy of a frame never waits for the upload of the previous one
+	namespace planePresenter {
+		// Same layout as EEPixelViewerPlane
+		struct Plane {
+			void* data;
+			int height;
+			int width;
+			size_t rowBytes;
+		};
+
+		// Same values as the CoreVideo pixel formats (kCVPixelFormatType_*), so that EEPixelViewer's pixelFormat can be passed as is
+		enum class PixelFormat : uint32_t {
+			RGB24 = 0x00000018, // kCVPixelFormatType_24RGB
+			BGR24 = 0x32344247, // '24BG'
+			ARGB32 = 0x00000020, // kCVPixelFormatType_32ARGB
+			BGRA32 = 0x42475241, // 'BGRA'
+			ABGR32 = 0x41424752, // 'ABGR'
+			RGBA32 = 0x52474241, // 'RGBA'
+			RGB555LE = 0x4C353535, // 'L555'
+			RGB5551LE = 0x35353531, // '5551'
+			RGB565LE = 0x4C353635, // 'L565'
+			YpCbCr422 = 0x32767579, // '2vuy', Cb Y'0 Cr Y'1
+			YpCbCr444 = 0x76333038, // 'v308', Cr Y' Cb
+			YpCbCrA4444 = 0x76343038, // 'v408', Cb Y' Cr A
+			AYpCbCr4444 = 0x79343038, // 'y408', A Y' Cb Cr
+			YpCbCr420Planar = 0x79343230, // 'y420'
+			YpCbCr420PlanarFullRange = 0x66343230, // 'f420'
+			YpCbCr420BiPlanarVideoRange = 0x34323076, // '420v'
+			YpCbCr420BiPlanarFullRange = 0x34323066 // '420f'
+		};
+
+		// Creates the window and its OpenGL 3.3 context. Returns false if it couldn't be created
+		bool init(int width, int height, const char* title);
+		GLFWwindow* getWindow();
+
+		// Returns false if the format isn't supported
+		bool setPixelFormat(PixelFormat format);
+		// Copies the planes (as many as the pixel format has, the first one giving the image size) and draws them to the window,
+		// scaled to fit. Swaps the buffers and polls the events
+		void present(const Plane* planes, int planeCount);
+
+		void terminate();
+	}
+}
@@ -0,0 +1,164 @@
+#include "png_writer.h"
+
+#include <iostream>
+#include <fstream>
+
+#define PNG_MAX_MATCH_LENGTH 258 // Longest match deflate can encode
+
+namespace renderer {
+	namespace png {
+		static uint32_t crcTable[256];
+		static bool crcTableReady = false;
+
+		static uint32_t crc(const uint8_t* data, size_t size, uint32_t value = 0xFFFFFFFFu) {
+			if (!crcTableReady) {
+				for (uint32_t i = 0; i < 256; i++) {
+					uint32_t c = i;
+					for (int bit = 0; bit < 8; bit++) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+					crcTable[i] = c;
+				}
+				crcTableReady = true;
+			}
+
+			for (size_t i = 0; i < size; i++) value = crcTable[(value ^ data[i]) & 0xFF] ^ (value >> 8);
+			return value;
+		}
+
+		static void writeBigEndian(std::vector<uint8_t>& output, uint32_t value) {
+			output.push_back(value >> 24);
+			output.push_back((value >> 16) & 0xFF);
+			output.push_back((value >> 8) & 0xFF);
+			output.push_back(value & 0xFF);
+		}
+
+		static void writeChunk(std::vector<uint8_t>& png, const char* type, const uint8_t* data, size_t size) {
+			writeBigEndian(png, (uint32_t)size);
+			size_t start = png.size();
+			png.insert(png.end(), type, type + 4);
+			png.insert(png.end(), data, data + size);
+			writeBigEndian(png, crc(png.data() + start, size + 4) ^ 0xFFFFFFFFu);
+		}
+
+		// Deflate bit stream (least significant bit first). Huffman codes are written from their most significant bit
+		struct BitWriter {
+			std::vector<uint8_t>& output;
+			uint64_t bits = 0;
+			int bitCount = 0;
+
+			BitWriter(std::vector<uint8_t>& output) : output(output) {}
+
+			void write(uint32_t value, int count) {
+				bits |= (uint64_t)value << bitCount;
+				bitCount += count;
+				while (bitCount >= 8) {
+					output.push_back(bits & 0xFF);
+					bits >>= 8;
+					bitCount -= 8;
+				}
+			}
+
+			void writeCode(uint32_t code, int length) {
+				uint32_t reversed = 0;
+				for (int i = 0; i < length; i++) reversed |= ((code >> i) & 1) << (length - 1 - i);
+				write(reversed, length);
+			}
+
+			void flush() {
+				if (bitCount > 0) output.push_back(bits & 0xFF);
+				bits = 0;
+				bitCount = 0;
+			}
+		};
+
+		// Fixed Huffman codes of the literal/length alphabet
+		static void writeSymbol(BitWriter& writer, int symbol) {
+			if (symbol < 144) writer.writeCode(0x30 + symbol, 8);
+			else if (symbol < 256) writer.writeCode(0x190 + symbol - 144, 9);
+			else if (symbol < 280) writer.writeCode(symbol - 256, 7);
+			else writer.writeCode(0xC0 + symbol - 280, 8);
+		}
+
+		// Repeats the previous byte (distance 1) length times
+		static void writeRun(BitWriter& writer, int length) {
+			static const int baseLengths[] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+			static const int extraBits[] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+
+			int code = 28;
+			while (baseLengths[code] > length) code--;
+
+			writeSymbol(writer, 257 + code);
+			writer.write(length - baseLengths[code], extraBits[code]);
+			writer.writeCode(0, 5); // Distance code 0 (distance 1)
+		}
+
+		void encode(const uint8_t* pixels, int width, int height, int channels, std::vector<uint8_t>& png) {
+			const uint8_t signature[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+			png.assign(signature, signature + sizeof(signature));
+
+			std::vector<uint8_t> header;
+			writeBigEndian(header, width);
+			writeBigEndian(header, height);
+			header.insert(header.end(), { 8, (uint8_t)(channels == 1 ? 0 : 2), 0, 0, 0 }); // 8 bits per channel, grayscale or RGB, deflate, adaptive filtering, no interlacing
+			writeChunk(png, "IHDR", header.data(), header.size());
+
+			// Sub filtered rows, each starting with its filter type
+			size_t rowSize = (size_t)width * channels;
+			std::vector<uint8_t> filtered((rowSize + 1) * height);
+			for (int y = 0; y < height; y++) {
+				const uint8_t* row = pixels + (size_t)y * rowSize;
+				uint8_t* filteredRow = filtered.data() + (size_t)y * (rowSize + 1);
+				filteredRow[0] = 1;
+				for (size_t x = 0; x < rowSize; x++) {
+					filteredRow[x + 1] = row[x] - (x >= (size_t)channels ? row[x - channels] : 0);
+				}
+			}
+
+			std::vector<uint8_t> compressed;
+			compressed.reserve(filtered.size() / 4);
+			compressed.push_back(0x78); // zlib header: deflate with a 32 KiB window, no dictionary
+			compressed.push_back(0x01);
+
+			BitWriter writer(compressed);
+			writer.write(1, 1); // Last block
+			writer.write(1, 2); // Fixed Huffman codes
+
+			uint32_t adlerA = 1, adlerB = 0;
+			for (size_t i = 0; i < filtered.size();) {
+				uint8_t value = filtered[i];
+				writeSymbol(writer, value);
+
+				size_t run = 1;
+				while (i + run < filtered.size() && filtered[i + run] == value && run <= PNG_MAX_MATCH_LENGTH) run++;
+				if (run >= 4) writeRun(writer, (int)(run - 1));
+				else run = 1;
+
+				for (size_t j = 0; j < run; j++) {
+					adlerA = (adlerA + value) % 65521;
+					adlerB = (adlerB + adlerA) % 65521;
+				}
+				i += run;
+			}
+
+			writeSymbol(writer, 256); // End of block
+			writer.flush();
+			writeBigEndian(compressed, (adlerB << 16) | adlerA);
+
+			writeChunk(png, "IDAT", compressed.data(), compressed.size());
+			writeChunk(png, "IEND", nullptr, 0);
+		}
+
+		bool write(const char* path, const uint8_t* pixels, int width, int height, int channels) {
+			std::vector<uint8_t> png;
+			encode(pixels, width, height, channels, png);
+
+			std::ofstream file(path, std::ios::binary);
+			file.write((const char*)png.data(), png.size());
+			if (!file.good()) {
+				std::cout << "[ERROR] Couldn't write the image '" << path << "'." << std::endl;
+				return false;
+			}
+
+			return true;
+		}
+	}
+}
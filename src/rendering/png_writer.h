@@ -0,0 +1,15 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+namespace renderer {
+	namespace png {
+		// Encodes 8-bit grayscale (1 channel) or RGB (3 channels) pixels, rows from top to bottom without padding, into a PNG file in memory.
+		// The compression is only run-length (every row is Sub filtered, so flat areas like the black sky become runs of zeros): it is fast enough for video frames.
+		// Also used by tools/sdf_font_atlas.cpp
+		void encode(const uint8_t* pixels, int width, int height, int channels, std::vector<uint8_t>& png);
+
+		bool write(const char* path, const uint8_t* pixels, int width, int height, int channels = 3);
+	}
+}
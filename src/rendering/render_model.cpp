@@ -1,6 +1,18 @@
 #include "render_model.h"
 #include <iostream>
 
+RenderModel::RenderModel() {
+	vertexCount = 0;
+	indexCount = 0;
+	VertexArrayID = 0;
+	VertexBufferID = 0;
+	IndexBufferID = 0;
+}
+
+RenderModel::~RenderModel() {
+	dispose();
+}
+
 const int RenderModel::GetVertexCount() {
 	return vertexCount;
 }
@@ -9,104 +21,74 @@ const int RenderModel::GetIndexCount() {
 	return indexCount;
 }
 
-const GLfloat* RenderModel::GetVertexData() {
-	return vertexData;
-}
+void RenderModel::upload(const std::vector<ModelVertex>& vertices, const std::vector<GLushort>& indices) {
+	if (vertices.size() > 0xFFFF) {
+		std::cout << "[ERROR] Model has " << vertices.size() << " vertices, which can't be addressed with 16-bit indices." << std::endl;
+		return;
+	}
 
-const GLuint* RenderModel::GetIndexData() {
-	return indexData;
-}
+	vertexCount = vertices.size();
+	indexCount = indices.size();
 
-glm::vec3* RenderModel::GetNormalData() {
-	return normalData;
-}
+	glGenVertexArrays(1, &VertexArrayID);
+	glBindVertexArray(VertexArrayID);
 
-void RenderModel::init() {
-	// Generate 1 buffer, put the resulting identifier in vertexbuffer
+	// Positions and normals share a single buffer
 	glGenBuffers(1, &VertexBufferID);
-	// The following commands will talk about our 'vertexbuffer' buffer
 	glBindBuffer(GL_ARRAY_BUFFER, VertexBufferID);
-	// Give our vertices to OpenGL.
-	glBufferData(GL_ARRAY_BUFFER, GetVertexDataSize(), vertexData, GL_STATIC_DRAW);
+	glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(ModelVertex), vertices.data(), GL_STATIC_DRAW);
 
+	// The index buffer binding is part of the VAO state, so it doesn't need to be bound again when drawing
 	glGenBuffers(1, &IndexBufferID);
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, IndexBufferID);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, GetIndexDataSize(), indexData, GL_STATIC_DRAW);
-
-	glGenBuffers(1, &NormalBufferID);
-	glBindBuffer(GL_ARRAY_BUFFER, NormalBufferID);
-	glBufferData(GL_ARRAY_BUFFER, GetNormalDataSize(), normalData, GL_STATIC_DRAW);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLushort), indices.data(), GL_STATIC_DRAW);
 
-	glGenVertexArrays(1, &VertexArrayID);
-	glBindVertexArray(VertexArrayID);
-	
-	// Now fill the buffer with some data
-	// 1st attribute buffer : vertices
+	// 1st attribute : vertices
 	glEnableVertexAttribArray(0);
-	glBindBuffer(GL_ARRAY_BUFFER, VertexBufferID);
 	glVertexAttribPointer(
-		0,                  // attribute 0. No particular reason for 0, but must match the layout in the shader.
-		3,                  // size
-		GL_FLOAT,           // type
-		GL_FALSE,           // normalized?
-		0,                  // stride
-		(void*)0            // array buffer offset
+		0,                                         // attribute 0. No particular reason for 0, but must match the layout in the shader.
+		3,                                         // size
+		GL_FLOAT,                                  // type
+		GL_FALSE,                                  // normalized?
+		sizeof(ModelVertex),                       // stride
+		(void*)offsetof(ModelVertex, position)     // array buffer offset
 	);
 
-	// 3rd attribute buffer : normals (2nd attribute is used for textures, but we don't use textures here)
+	// 3rd attribute : normals (2nd attribute is used for textures, but we don't use textures here)
 	glEnableVertexAttribArray(2);
-	glBindBuffer(GL_ARRAY_BUFFER, NormalBufferID);
 	glVertexAttribPointer(
-		2,                                // attribute
-		3,                                // size
-		GL_FLOAT,                         // type
-		GL_FALSE,                         // normalized?
-		0,                                // stride
-		(void*)0                          // array buffer offset
+		2,                                         // attribute
+		3,                                         // size
+		GL_FLOAT,                                  // type
+		GL_FALSE,                                  // normalized?
+		sizeof(ModelVertex),                       // stride
+		(void*)offsetof(ModelVertex, normal)       // array buffer offset
 	);
+
+	glBindVertexArray(0);
 }
 
-void RenderModel::calculateNormals() {
-	for (int triangleOffset = 0; triangleOffset < vertexCount*3; triangleOffset += 9) {
-		glm::vec3 a = glm::vec3(
-			vertexData[triangleOffset + 3] - vertexData[triangleOffset],
-			vertexData[triangleOffset + 4] - vertexData[triangleOffset + 1],
-			vertexData[triangleOffset + 5] - vertexData[triangleOffset + 2]
-		);
-
-		glm::vec3 b = glm::vec3(
-			vertexData[triangleOffset + 6] - vertexData[triangleOffset],
-			vertexData[triangleOffset + 7] - vertexData[triangleOffset + 1],
-			vertexData[triangleOffset + 8] - vertexData[triangleOffset + 2]
-		);
-
-		glm::vec3 triangleNormal = glm::vec3(
-			a.y * b.z - a.z * b.y,
-			a.z * b.x - a.x * b.z,
-			a.x * b.y - a.y * b.x
-		);
-
-		normalData[triangleOffset / 3 + 0] = triangleNormal;
-		normalData[triangleOffset / 3 + 1] = triangleNormal;
-		normalData[triangleOffset / 3 + 2] = triangleNormal;
+void RenderModel::calculateFlatNormals(std::vector<ModelVertex>& vertices) {
+	for (unsigned int triangleOffset = 0; triangleOffset + 2 < vertices.size(); triangleOffset += 3) {
+		glm::vec3 a = vertices[triangleOffset + 1].position - vertices[triangleOffset].position;
+		glm::vec3 b = vertices[triangleOffset + 2].position - vertices[triangleOffset].position;
+
+		glm::vec3 triangleNormal = glm::cross(a, b);
+
+		vertices[triangleOffset + 0].normal = triangleNormal;
+		vertices[triangleOffset + 1].normal = triangleNormal;
+		vertices[triangleOffset + 2].normal = triangleNormal;
 	}
 }
 
 void RenderModel::dispose() {
+	if (VertexArrayID == 0) return; // Never uploaded or already disposed
+
 	glDeleteBuffers(1, &VertexBufferID);
 	glDeleteBuffers(1, &IndexBufferID);
-	glDeleteBuffers(1, &NormalBufferID);
 	glDeleteVertexArrays(1, &VertexArrayID);
-}
 
-const int RenderModel::GetVertexDataSize() {
-	return vertexCount * 3 * sizeof(vertexData[0]);
+	VertexArrayID = 0;
+	VertexBufferID = 0;
+	IndexBufferID = 0;
 }
-
-const int RenderModel::GetIndexDataSize() {
-	return indexCount * sizeof(indexData[0]);
-}
-
-const int RenderModel::GetNormalDataSize() {
-	return vertexCount * sizeof(normalData[0]);
-}
\ No newline at end of file
@@ -3,34 +3,34 @@
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
 #include <glm/gtc/matrix_transform.hpp>
+#include <vector>
+
+// Layout of a single vertex in a model's vertex buffer (position and normal are interleaved so a vertex is fetched in one go)
+struct ModelVertex {
+	glm::vec3 position;
+	glm::vec3 normal;
+};
 
 class RenderModel
 {
 protected:
 	int vertexCount;
 	int indexCount;
-	const GLfloat* vertexData;
-	const GLuint* indexData;
-	glm::vec3* normalData;
 
-	void calculateNormals();
+	// Sends the geometry to the GPU. Only the GPU buffers are kept afterwards, so the given vectors can be freed by the caller.
+	void upload(const std::vector<ModelVertex>& vertices, const std::vector<GLushort>& indices);
+	static void calculateFlatNormals(std::vector<ModelVertex>& vertices);
 
 public:
+	RenderModel();
+	virtual ~RenderModel();
+
 	const int GetVertexCount();
 	const int GetIndexCount();
-	const int GetVertexDataSize();
-	const int GetIndexDataSize();
-	const int GetNormalDataSize();
-	const GLfloat* GetVertexData();
-	const GLuint* GetIndexData();
-	glm::vec3* GetNormalData();
 
 	GLuint VertexArrayID;
 	GLuint VertexBufferID;
 	GLuint IndexBufferID;
-	GLuint NormalBufferID;
 
-	void init();
 	void dispose();
 };
-
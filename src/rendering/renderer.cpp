@@ -1,10 +1,10 @@
 #include "renderer.h"
 
-Universe* renderer::loadedUniverse;
 GLFWwindow* renderer::window;
 
 renderer::Shader renderer::shader;
 renderer::StarShader renderer::starShader;
+renderer::GridShader renderer::gridShader;
 renderer::OverlayShader renderer::overlayShader;
 renderer::UIShader renderer::uiShader;
 renderer::PostProcessingShader renderer::postProcessingShader;
@@ -15,12 +15,14 @@ GLuint renderer::FramebufferID;
 GLuint renderer::ColorBufferTextureID;
 GLuint renderer::EmissionBufferTextureID;
 GLuint renderer::rbo;
+GLuint renderer::FullscreenVertexArrayID;
+GeometryBatch renderer::geometryBatch;
 
 int renderer::windowWidth;
 int renderer::windowHeight;
 
-std::vector<Sphere*> renderer::bodyLODModels;
-StarSphere* renderer::starSphereModel;
+std::vector<RenderModel*> renderer::bodyLODModels;
+GLuint renderer::StarfieldTextureID;
 
 std::vector<ui::Panel*> renderer::uiPanels;
 ui::TextFieldComponent* renderer::focusedTextField;
@@ -35,6 +37,10 @@ bool spacePressed = false;
 // Usually nullptr, but has a value when the user is currently spawning an object and settings its parameters
 MassBody* spawnedBody;
 
+unsigned int focusedUniverseId = 0; // Universe of the snapshot the camera focus was last chosen from
+
+renderer::FrameScene frameScene; // Kept between frames so that its buffers are reused
+
 // This function creates an OpenGL program from a vertex and a fragment shader and returns its ID
 GLuint LoadShaderProgram(const char* vertex_file_path, const char* fragment_file_path) {
 
@@ -128,9 +134,9 @@ GLuint LoadShaderProgram(const char* vertex_file_path, const char* fragment_file
 void abortSpawn() {
 	delete spawnedBody;
 	spawnedBody = nullptr;
-	renderer::camera.SetFocusedBody(renderer::loadedUniverse->GetBodies()->at(0));
+	renderer::camera.SetFocusedBody(simulation::getSnapshot().bodies.at(0).id);
 
-	ui::showBodyProperties(renderer::camera.focusedBody);
+	ui::showBodyProperties(renderer::camera.focusedBodyId);
 }
 
 void scrollCallback(GLFWwindow* window, double xoffset, double yoffset) {
@@ -145,7 +151,7 @@ void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods
 		}
 		else {
 			if (key == GLFW_KEY_SPACE) {
-				renderer::loadedUniverse->timeScale = 1 - renderer::loadedUniverse->timeScale;
+				simulation::queueCommand(simulation::Command::SetTimeScale(1 - simulation::getSnapshot().timeScale));
 			}
 			else if (key == GLFW_KEY_ESCAPE) {
 				if (spawnedBody != nullptr) {
@@ -154,9 +160,11 @@ void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods
 			}
 			else if (key == GLFW_KEY_DELETE || key == GLFW_KEY_X) {
 				if (spawnedBody == nullptr) {
-					if (renderer::loadedUniverse->GetBodies()->size() > 1) {
-						renderer::loadedUniverse->DeleteBody(renderer::camera.focusedBody);
-						renderer::camera.SetFocusedBody(renderer::loadedUniverse->GetBodies()->at(0));
+					const simulation::Snapshot& snapshot = simulation::getSnapshot();
+					if (snapshot.bodies.size() > 1) {
+						unsigned int deletedBodyId = renderer::camera.focusedBodyId;
+						simulation::queueCommand(simulation::Command::DeleteBody(deletedBodyId));
+						renderer::camera.SetFocusedBody(snapshot.bodies[snapshot.bodies[0].id == deletedBodyId ? 1 : 0].id);
 					}
 				}
 				else {
@@ -193,9 +201,13 @@ void framebufferSizeCallback(GLFWwindow* window, int width, int height)
 	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
 	glBindRenderbuffer(GL_RENDERBUFFER, renderer::rbo);
 	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+
+	renderer::bloom::resize(width, height);
+
+	ui::drawList::markDirty(); // The UI layout depends on the aspect ratio
 }
 
-int renderer::init() {
+int renderer::init(int offscreenWidth, int offscreenHeight) {
 	std::cout << "Init start" << std::endl;
 
 	/* Initialize the library */
@@ -211,8 +223,18 @@ int renderer::init() {
 	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
 #endif
   
+	bool offscreen = offscreenWidth > 0 && offscreenHeight > 0;
+	if (offscreen) glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE); // Only the context is needed, frames go to the capture framebuffer
+
 	/* Create a windowed mode window and its OpenGL context */
-	window = glfwCreateWindow(1280, 720, "Gravity Simulator 3D", NULL, NULL);
+	window = glfwCreateWindow(offscreen ? offscreenWidth : 1280, offscreen ? offscreenHeight : 720, "Gravity Simulator 3D", NULL, NULL);
+	if (!window && offscreen) {
+		// No display to create a window on (e.g. a render server): let Mesa render in memory instead.
+		// Without any display server at all, GLFW itself has to be built for OSMesa (GLFW_USE_OSMESA) or glfwInit() fails
+		std::cout << "[WARNING] Could not create a hidden window, trying an OSMesa context." << std::endl;
+		glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_OSMESA_CONTEXT_API);
+		window = glfwCreateWindow(offscreenWidth, offscreenHeight, "Gravity Simulator 3D", NULL, NULL);
+	}
 	if (!window) // Has the window been created?
 	{
 		glfwTerminate();
@@ -224,14 +246,20 @@ int renderer::init() {
 	//glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED); // Hide the mouse
 
 	glfwGetWindowSize(window, &windowWidth, &windowHeight);
+	if (offscreen) {
+		// The chosen resolution, whatever size the window system gave to the hidden window
+		windowWidth = offscreenWidth;
+		windowHeight = offscreenHeight;
+		glViewport(0, 0, windowWidth, windowHeight);
+	}
 	glfwSetScrollCallback(window, scrollCallback);
 	glfwSetKeyCallback(window, keyCallback);
 	glfwSetCharCallback(window, charCallback);
-	glfwSetFramebufferSizeCallback(window, framebufferSizeCallback);
+	if (!offscreen) glfwSetFramebufferSizeCallback(window, framebufferSizeCallback); // The capture keeps its resolution, whatever happens to the hidden window
 
 	glfwWindowHint(GLFW_RESIZABLE, GL_TRUE);
 	glfwSetWindowSizeCallback(window, resizeCallback);
-	glfwSetWindowAspectRatio(window, 16, 9);
+	if (!offscreen) glfwSetWindowAspectRatio(window, 16, 9);
 
 	glewInit();
 
@@ -239,49 +267,32 @@ int renderer::init() {
 
 	shader.ProgramID = LoadShaderProgram("shaders/default/vertexShader.glsl", "shaders/default/fragmentShader.glsl");
 	starShader.ProgramID = LoadShaderProgram("shaders/stars/vertexShader.glsl", "shaders/stars/fragmentShader.glsl");
+	gridShader.ProgramID = LoadShaderProgram("shaders/grid/vertexShader.glsl", "shaders/grid/fragmentShader.glsl");
 	overlayShader.ProgramID = LoadShaderProgram("shaders/overlay/vertexShader.glsl", "shaders/overlay/fragmentShader.glsl");
 	uiShader.ProgramID = LoadShaderProgram("shaders/ui/vertexShader.glsl", "shaders/ui/fragmentShader.glsl");
 	postProcessingShader.ProgramID = LoadShaderProgram("shaders/postprocessing/vertexShader.glsl", "shaders/postprocessing/fragmentShader.glsl");
 
-	shader.MatrixUniformID = glGetUniformLocation(shader.ProgramID, "MVP");
-	shader.ViewMatrixUniformID = glGetUniformLocation(shader.ProgramID, "V");
-	shader.ModelMatrixUniformID = glGetUniformLocation(shader.ProgramID, "M");
-	shader.UnlitUniformID = glGetUniformLocation(shader.ProgramID, "Unlit");
-	shader.EmissiveUniformID = glGetUniformLocation(shader.ProgramID, "Emissive");
-	shader.LightPosUniformID = glGetUniformLocation(shader.ProgramID, "LightPosition_worldspace");
-	shader.LightColorUniformID = glGetUniformLocation(shader.ProgramID, "LightColor");
-	shader.ModelColorUniformID = glGetUniformLocation(shader.ProgramID, "ModelColor");
-	shader.OccluderCountUniformID = glGetUniformLocation(shader.ProgramID, "OccluderCount");
-	shader.LightRadiusUniformID = glGetUniformLocation(shader.ProgramID, "LightRadius");
-
-	for (int i = 0; i < MAX_OCCLUDERS; i++) {
-		std::string indexStr = "[" + std::to_string(i) + "]";
+	shader.OccludersUniformID = glGetUniformLocation(shader.ProgramID, "Occluders");
 
-		std::string location1Str = "OccluderPositions" + indexStr;
-		std::string location2Str = "OccluderRadiuses" + indexStr;
-
-		shader.OccluderPositionsUniformIDs[i] = glGetUniformLocation(shader.ProgramID, location1Str.c_str());
-		shader.OccluderRadiusesUniformIDs[i] = glGetUniformLocation(shader.ProgramID, location2Str.c_str());
-	}
+	drawQueue::bindUniformBlocks(shader.ProgramID);
+	drawQueue::bindUniformBlocks(gridShader.ProgramID);
+	drawQueue::bindUniformBlocks(overlayShader.ProgramID);
 
-	starShader.MatrixUniformID = glGetUniformLocation(starShader.ProgramID, "MVP");
-	starShader.ViewMatrixUniformID = glGetUniformLocation(starShader.ProgramID, "V");
+	starShader.InverseViewProjectionMatrixUniformID = glGetUniformLocation(starShader.ProgramID, "InverseVP");
+	starShader.StarfieldTextureUniformID = glGetUniformLocation(starShader.ProgramID, "StarfieldTexture");
 
-	overlayShader.CamRightUniformID = glGetUniformLocation(overlayShader.ProgramID, "CameraRight_worldspace");
-	overlayShader.CamUpUniformID = glGetUniformLocation(overlayShader.ProgramID, "CameraUp_worldspace");
-	overlayShader.ViewProjectionMatrixUniformID = glGetUniformLocation(overlayShader.ProgramID, "VP");
 	overlayShader.OverlayPositionUniformID = glGetUniformLocation(overlayShader.ProgramID, "OverlayPos");
 	overlayShader.OverlaySizeUniformID = glGetUniformLocation(overlayShader.ProgramID, "OverlaySize");
-	overlayShader.TimeUniformID = glGetUniformLocation(overlayShader.ProgramID, "Time");
 
-	uiShader.UseTextureUniformID = glGetUniformLocation(uiShader.ProgramID, "UseTexture");
+	uiShader.DistanceFieldUniformID = glGetUniformLocation(uiShader.ProgramID, "DistanceField");
 
 	postProcessingShader.ScreenTextureUniformID = glGetUniformLocation(postProcessingShader.ProgramID, "ScreenTexture");
-	postProcessingShader.EmissionTextureUniformID = glGetUniformLocation(postProcessingShader.ProgramID, "EmissionTexture");
+	postProcessingShader.BloomTextureUniformID = glGetUniformLocation(postProcessingShader.ProgramID, "BloomTexture");
 
 	std::cout << "Shader load end" << std::endl;
 
 	ui::fontRendering::init();
+	ui::drawList::init();
 
 	std::cout << "Setting render parameters" << std::endl;
 	glEnable(GL_DEPTH_TEST); // Enable depth test
@@ -315,6 +326,8 @@ int renderer::init() {
 	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, windowWidth, windowHeight, 0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE); // The bloom downsampling reads past the edges
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 
 	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, EmissionBufferTextureID, 0);
 
@@ -333,17 +346,27 @@ int renderer::init() {
 		std::cout << "ERROR: Framebuffer is not complete!" << std::endl;
 	glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
+	bloom::init(windowWidth, windowHeight);
+	occluders::init();
+	drawQueue::init();
+
+	// Core profile requires a VAO to be bound for every draw, even when no vertex attributes are used
+	glGenVertexArrays(1, &FullscreenVertexArrayID);
+
+	geometryBatch.init();
+
 	std::cout << "Render parameters set" << std::endl;
 
-	camera = Camera(glm::vec3(0, 0, 0), glm::vec2(0, 0), 5.0f, glm::radians(45.0f), 0.5f);
+	camera = Camera(glm::vec3(0, 0, 0), glm::vec2(0, 0), FRAME_CAMERA_DISTANCE, glm::radians(45.0f), 0.5f);
 	camera.windowWidth = windowWidth;
 	camera.windowHeight = windowHeight;
 
 	for (int i = 0; i < 4; i++) {
-		bodyLODModels.push_back(new Sphere(64 / (i + 1), 1));
+		bodyLODModels.push_back(meshCache::get(meshCache::MeshType::Sphere, 4 - i));
 	}
 
-	starSphereModel = new StarSphere();
+	glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS); // Filter across the edges of the starfield's faces
+	StarfieldTextureID = starfield::generate(STARFIELD_SEED, STARFIELD_STAR_COUNT, STARFIELD_FACE_SIZE);
 
 	lastTime = glfwGetTime();
 
@@ -363,7 +386,8 @@ renderer::Camera::Camera(glm::vec3 offset, glm::vec2 orbitAngles, float distance
 	Camera::fov = fov;
 	Camera::sensitivity = sensitivity;
 
-	Camera::focusedBody = nullptr;
+	Camera::focusedBodyId = 0;
+	Camera::focusedBodyPosition = glm::vec3(0);
 	Camera::isBeingDragged = false;
 	Camera::isOrbiting = false;
 	Camera::startMouseX = 0;
@@ -390,7 +414,7 @@ renderer::Camera::Camera() : renderer::Camera::Camera(glm::vec3(0), glm::vec2(0)
 
 // Handles all camera movement. Called every frame.
 void renderer::Camera::Update(double mouseX, double mouseY, bool orbiting, bool dragging, float deltaTime) {
-	focusedPosition = ((focusedBody != nullptr) ? focusedBody->position : glm::vec3(0)) + offset + deltaOffset;
+	focusedPosition = focusedBodyPosition + offset + deltaOffset;
 
 	glm::vec3 viewDir = glm::normalize(focusedPosition - position);
 	glm::vec3 upVector = glm::vec3(0, 1, 0);
@@ -484,15 +508,15 @@ void renderer::Camera::Update(double mouseX, double mouseY, bool orbiting, bool
 	}
 }
 
-void renderer::Camera::SetFocusedBody(MassBody* focusedBody) {
-	this->focusedBody = focusedBody;
+void renderer::Camera::SetFocusedBody(unsigned int focusedBodyId) {
+	this->focusedBodyId = focusedBodyId;
 	this->previousPosition = camera.position;
 	this->previousFocusedPosition = camera.focusedPosition;
 	this->interpolating = true;
 	this->interpolationT = 0;
 	this->offset = glm::vec3(0);
 
-	ui::showBodyProperties(focusedBody);
+	ui::showBodyProperties(focusedBodyId);
 }
 
 void renderer::preRender() {
@@ -500,8 +524,6 @@ void renderer::preRender() {
 
 	GLenum drawbuffers[2] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
 	glDrawBuffers(2, drawbuffers);
-	glUniform1i(shader.UnlitUniformID, 0);
-
 	glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT); // we're not using the stencil buffer now
 	glEnable(GL_DEPTH_TEST);
@@ -511,7 +533,7 @@ void renderer::preRender() {
 double previousMouseX = 0;
 double previousMouseY = 0;
 
-void renderer::postRender(double deltaTime) {
+void renderer::postRender() {
 	// Mouse button events
 	int leftBtnState = glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT);
 	int rightBtnState = glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_RIGHT);
@@ -558,10 +580,6 @@ void renderer::postRender(double deltaTime) {
 	else if (!middleBtnState && middleMouseButtonPressed) {
 		middleMouseButtonPressed = false;
 	}
-
-	// Universe tick
-	if (renderer::loadedUniverse != nullptr)
-		renderer::loadedUniverse->tick(deltaTime);
 }
 
 void renderer::mouseDown(float mouseX, float mouseY, int button) { // mouseX and mouseY are in OpenGL Screen-space [-1;1]
@@ -584,9 +602,9 @@ void renderer::mouseDown(float mouseX, float mouseY, int button) { // mouseX and
 	if (!absorbed) {
 		if (button == GLFW_MOUSE_BUTTON_RIGHT) {
 			if (spawnedBody == nullptr) {
-				Universe::RaycastHit hitResult = loadedUniverse->Raycast(camera.position, CreateMouseRay());
+				simulation::Snapshot::RaycastHit hitResult = simulation::getSnapshot().Raycast(camera.position, CreateMouseRay());
 				if (hitResult.hit) {
-					camera.SetFocusedBody(hitResult.hitBody);
+					camera.SetFocusedBody(hitResult.hitBodyId);
 				}
 			}
 			else {
@@ -594,7 +612,9 @@ void renderer::mouseDown(float mouseX, float mouseY, int button) { // mouseX and
 			}
 		}
 		else if (button == GLFW_MOUSE_BUTTON_LEFT) {
-			MassBody* focusedBody = camera.focusedBody;
+			const MassBody* focusedBody = findBody(camera.focusedBodyId);
+			if (focusedBody == nullptr) return; // Not simulated yet
+
 			glm::vec3 mouseRay = CreateMouseRay();
 			glm::vec3 planeNormal = glm::vec3(0, 1, 0); //glm::normalize(camera.position - focusedBody->position); (uncomment if you don't want the spawn position to be contrainted to the horizontal plane)
 			glm::vec3 planeIntersection = PlaneIntersection(focusedBody->position, planeNormal, camera.position, mouseRay);
@@ -603,15 +623,16 @@ void renderer::mouseDown(float mouseX, float mouseY, int button) { // mouseX and
 				
 				// Discretely focus the new body
 				camera.offset = glm::vec3(camera.focusedPosition - spawnedBody->position);
-				camera.focusedBody = spawnedBody;
+				camera.focusedBodyId = spawnedBody->id;
 				
-				ui::showBodyProperties(spawnedBody, "Spawned body");
+				ui::showBodyProperties(spawnedBody->id, "Spawned body");
 			}
 			else {
 				glm::vec3 spawnVelocity = (planeIntersection - spawnedBody->position) * 0.5F;
 				spawnedBody->velocity = spawnVelocity;
-				loadedUniverse->AddBody(spawnedBody);
-				ui::showBodyProperties(camera.focusedBody);
+				ui::showBodyProperties(camera.focusedBodyId); // Before the body is handed over to the simulation thread, which owns it from then on
+
+				simulation::queueCommand(simulation::Command::AddBody(spawnedBody));
 
 				spawnedBody = nullptr;
 			}
@@ -619,9 +640,26 @@ void renderer::mouseDown(float mouseX, float mouseY, int button) { // mouseX and
 	}
 }
 
-void renderer::setUniverse(Universe* universe) {
-	renderer::loadedUniverse = universe;
-	camera.focusedBody = universe->GetBodies()->at(0);
+void renderer::setUniverse(Universe* universe, bool realTime) {
+	camera.focusedBodyId = universe->GetBodies()->at(0)->id;
+	camera.focusedBodyPosition = universe->GetBodies()->at(0)->position;
+
+	simulation::setUniverse(universe, realTime);
+}
+
+const MassBody* renderer::findBody(unsigned int bodyId) {
+	if (spawnedBody != nullptr && bodyId == spawnedBody->id) return spawnedBody;
+
+	return simulation::getSnapshot().FindBody(bodyId);
+}
+
+void renderer::setBodyProperty(unsigned int bodyId, simulation::BodyProperty property, simulation::PropertyValue value) {
+	if (spawnedBody != nullptr && bodyId == spawnedBody->id) {
+		simulation::setBodyProperty(spawnedBody, property, value);
+		return;
+	}
+
+	simulation::queueCommand(simulation::Command::SetProperty(bodyId, property, value));
 }
 
 // from https://stackoverflow.com/a/30005258
@@ -655,175 +693,77 @@ glm::vec3 renderer::PlaneIntersection(glm::vec3 planePoint, glm::vec3 planeNorma
 	return linePoint + (glm::normalize(lineDirection) * t);
 }
 
-// Requires the default shader to be bound
-void renderer::renderModel(RenderModel model, glm::mat4 projectionMatrix, glm::mat4 viewMatrix, glm::mat4 modelMatrix, Color color) {
-	// Our ModelViewProjection : multiplication of our 3 matrices
-	glm::mat4 mvp = projectionMatrix * viewMatrix * modelMatrix; // Remember, matrix multiplication is the other way around
-
-	MassBody* emittingBody = loadedUniverse->GetEmissiveBody();
-
-	// Send our transformation to the currently bound shader, in the "MVP" uniform
-	// This is done in the main loop since each model will have a different MVP matrix (At least for the M part)
-	glUniformMatrix4fv(shader.MatrixUniformID, 1, GL_FALSE, &mvp[0][0]);
-	glUniformMatrix4fv(shader.ModelMatrixUniformID, 1, GL_FALSE, &modelMatrix[0][0]);
-	glUniformMatrix4fv(shader.ViewMatrixUniformID, 1, GL_FALSE, &viewMatrix[0][0]);
-	glUniform3f(shader.LightColorUniformID, emittingBody->color.red, emittingBody->color.green, emittingBody->color.blue);
-	glUniform3f(shader.ModelColorUniformID, color.red, color.green, color.blue);
-
-	glUniform3f(shader.LightPosUniformID, emittingBody->position.x, emittingBody->position.y, emittingBody->position.z);
-	glUniform1f(shader.LightRadiusUniformID, emittingBody->radius);
-
-	glBindVertexArray(model.VertexArrayID);
-
-	// Bind the model index buffer
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, model.IndexBufferID);
+void renderer::renderModel(RenderModel* model, glm::mat4 modelMatrix, Color color, bool unlit) {
+	drawQueue::DrawData drawData;
+	drawData.model = modelMatrix;
+	drawData.color = glm::vec4(color.red, color.green, color.blue, 1.0f);
+	drawData.flags = glm::ivec4(unlit ? 1 : 0, 0, 0, 0);
 
-	// Draw the triangles !
-	glDrawElements(
-		GL_TRIANGLES,          // mode
-		model.GetIndexCount(), // index count
-		GL_UNSIGNED_INT,       // type
-		(void*)0               // element array buffer offset
-	);
+	drawQueue::queue(model, drawData);
 }
 
-void renderer::renderBody(MassBody* body, glm::mat4 projectionMatrix) {
+void renderer::renderBody(const MassBody& body, bool emissive, occluders::OccluderRange occluderRange) {
 	glm::mat4 modelMatrix = glm::mat4(1);
 
-	modelMatrix = glm::translate(modelMatrix, body->position);
-	modelMatrix = glm::scale(modelMatrix, glm::vec3(body->radius));
+	modelMatrix = glm::translate(modelMatrix, body.position);
+	modelMatrix = glm::scale(modelMatrix, glm::vec3(body.radius));
 
-	bool isEmissive = body == loadedUniverse->GetEmissiveBody();
+	drawQueue::DrawData drawData;
+	drawData.model = modelMatrix;
+	drawData.color = glm::vec4(body.color.red, body.color.green, body.color.blue, 1.0f);
 
-	if (isEmissive) {
-		glUniform1i(shader.OccluderCountUniformID, 0);
-		glUniform1i(shader.UnlitUniformID, 1);
-		glUniform1i(shader.EmissiveUniformID, 1);
+	if (emissive) {
+		drawData.flags = glm::ivec4(1, 1, 0, 0); // Unlit and emissive
 	}
 	else {
-		glUniform1i(shader.OccluderCountUniformID, body->occluders.size());
-		for (unsigned int i = 0; i < body->occluders.size(); i++) {
-			MassBody* occluder = body->occluders[i];
-			glUniform3f(shader.OccluderPositionsUniformIDs[i], occluder->position.x, occluder->position.y, occluder->position.z);
-			glUniform1f(shader.OccluderRadiusesUniformIDs[i], occluder->radius);
-		}
+		drawData.flags = glm::ivec4(0, 0, occluderRange.offset, occluderRange.count);
 	}
 
-	float distanceFromCamera = glm::distance(camera.position, body->position) - body->radius;
-
-	renderModel(*bodyLODModels[(int)fminf(fmaxf(distanceFromCamera / (body->radius * 8.0f), 0.0f), 3.0f)], projectionMatrix, camera.viewMatrix, modelMatrix, body->color); // The weird looking formula is for choosing the right LOD model based on distance from camera and radius. I just tried different configurations out to try to find the right balance.
+	float distanceFromCamera = glm::distance(camera.position, body.position) - body.radius;
 
-	if (isEmissive) {
-		glUniform1i(shader.UnlitUniformID, 0);
-		glUniform1i(shader.EmissiveUniformID, 0);
-	}
-	else {
-		glUniform1i(shader.OccluderCountUniformID, 0);
-	}
+	drawQueue::queue(bodyLODModels[(int)fminf(fmaxf(distanceFromCamera / (body.radius * 8.0f), 0.0f), 3.0f)], drawData); // The weird looking formula is for choosing the right LOD model based on distance from camera and radius. I just tried different configurations out to try to find the right balance.
 }
 
 // Requires the starShader
 void renderer::renderStars(glm::mat4 projectionMatrix) {
-	glm::mat4 viewMatrix = camera.stationaryViewMatrix;
-
-	// Our ModelViewProjection : multiplication of our 3 matrices
-	glm::mat4 mvp = projectionMatrix * viewMatrix; // Remember, matrix multiplication is the other way around
-
-	// Send our transformation to the currently bound shader, in the "MVP" uniform
-	// This is done in the main loop since each model will have a different MVP matrix (At least for the M part)
-	glUniformMatrix4fv(starShader.MatrixUniformID, 1, GL_FALSE, &mvp[0][0]);
-	glUniformMatrix4fv(starShader.ViewMatrixUniformID, 1, GL_FALSE, &viewMatrix[0][0]);
+	// The translation is left out so that the stars always stay infinitely far away
+	glm::mat4 inverseViewProjection = glm::inverse(projectionMatrix * camera.stationaryViewMatrix);
+	glUniformMatrix4fv(starShader.InverseViewProjectionMatrixUniformID, 1, GL_FALSE, &inverseViewProjection[0][0]);
 
-	glBindVertexArray(starSphereModel->VertexArrayID);
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_CUBE_MAP, StarfieldTextureID);
+	glUniform1i(starShader.StarfieldTextureUniformID, 0);
 
-	// Bind the model index buffer
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, starSphereModel->IndexBufferID);
+	drawFullscreenTriangle();
 
-	// Draw the triangles !
-	glDrawElements(
-		GL_TRIANGLES,          // mode
-		starSphereModel->GetIndexCount(), // index count
-		GL_UNSIGNED_INT,       // type
-		(void*)0               // element array buffer offset
-	);
+	glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
 }
 
 
-// Requires the default shader
-void renderer::renderGrid(glm::mat4 projectionMatrix, glm::mat4 viewMatrix) {
-	glm::mat4 modelMatrix = glm::mat4(1);
-
-	// Our ModelViewProjection : multiplication of our 3 matrices
-	glm::mat4 mvp = projectionMatrix * viewMatrix * modelMatrix; // Remember, matrix multiplication is the other way around
-
-	// Send our transformation to the currently bound shader, in the "MVP" uniform
-	// This is done in the main loop since each model will have a different MVP matrix (At least for the M part)
-	glUniformMatrix4fv(shader.MatrixUniformID, 1, GL_FALSE, &mvp[0][0]);
-	glUniformMatrix4fv(shader.ModelMatrixUniformID, 1, GL_FALSE, &modelMatrix[0][0]);
-	glUniformMatrix4fv(shader.ViewMatrixUniformID, 1, GL_FALSE, &viewMatrix[0][0]);
-
-	glUniform1i(shader.UnlitUniformID, 1);
-
-	glLineWidth(3);
-	glUniform3f(shader.ModelColorUniformID, 1.0f, 0.0f, 0.0f);
-	glBegin(GL_LINE_STRIP);
-	for (float j = -1000; j <= 1000; j += 100) {
-		glVertex3f(j, 0.0f, 0.0f);
-	}
-	glEnd();
-
-	glUniform3f(shader.ModelColorUniformID, 0.0f, 0.0f, 1.0f);
-	glBegin(GL_LINE_STRIP);
-	for (float j = -1000; j <= 1000; j += 100) {
-		glVertex3f(0, 0.0f, j);
-	}
-	glEnd();
-
+// Requires the gridShader
+void renderer::renderGrid() {
+	// The grid is a plane of infinite size: the lines are computed in the fragment shader from where the view ray hits it
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	glDepthMask(GL_FALSE); // Transparent, so it shouldn't hide anything drawn after it
 
-	// TODO Only render grid where the camera is (at the moment a large fixed grid is drawn at the center of the world)
-	glLineWidth(1);
-	glUniform3f(shader.ModelColorUniformID, 1.0f, 1.0f, 1.0f);
-	glBegin(GL_LINE_STRIP);
-	for (float i = -1000; i <= 1000; i += 10) {
-		for (float j = -1000; j <= 1000; j += 100) {
-			glVertex3f(i, 0.0f, j);
-		}
-		glEnd(); glBegin(GL_LINE_STRIP); //glPrimitiveRestartNV();
+	drawFullscreenTriangle();
 
-		for (float j = -1000; j <= 1000; j += 100) {
-			glVertex3f(j, 0.0f, i);
-		}
-		glEnd(); glBegin(GL_LINE_STRIP); //glPrimitiveRestartNV();
-	}
-	glEnd();
+	glDepthMask(GL_TRUE);
+	glDisable(GL_BLEND);
 }
 
 // Requires the overlayShader
-void renderer::renderFocusOverlay(glm::mat4 projectionMatrix) {
-	MassBody* focusedBody = camera.focusedBody;
-	glm::mat4 viewMatrix = camera.viewMatrix;
-
-	// http://www.opengl-tutorial.org/intermediate-tutorials/billboards-particles/billboards/
-	glUniform3f(overlayShader.CamRightUniformID, viewMatrix[0][0], viewMatrix[1][0], viewMatrix[2][0]);
-	glUniform3f(overlayShader.CamUpUniformID, viewMatrix[0][1], viewMatrix[1][1], viewMatrix[2][1]);
+void renderer::renderFocusOverlay() {
+	const MassBody* focusedBody = findBody(camera.focusedBodyId);
+	if (focusedBody == nullptr) return; // Not simulated yet
 
+	// The camera vectors, view-projection matrix and time come from the frame data
 	glUniform3f(overlayShader.OverlayPositionUniformID, focusedBody->position.x, focusedBody->position.y, focusedBody->position.z);
 	glUniform2f(overlayShader.OverlaySizeUniformID, focusedBody->radius * 1.5f, focusedBody->radius * 1.5f);
 
-	glm::mat4 viewProjectionMatrix = projectionMatrix * viewMatrix;
-	glUniformMatrix4fv(overlayShader.ViewProjectionMatrixUniformID, 1, GL_FALSE, &viewProjectionMatrix[0][0]);
-
-	glUniform1f(overlayShader.TimeUniformID, (float)glfwGetTime());
-
-	glBegin(GL_TRIANGLES);
-	glVertex3f(-1.0f, 1.0f, 0.0f);
-	glVertex3f(-1.0f, -1.0f, 0.0f);
-	glVertex3f(1.0f, -1.0f, 0.0f);
-
-	glVertex3f(1.0f, 1.0f, 0.0f);
-	glVertex3f(-1.0f, 1.0f, 0.0f);
-	glVertex3f(1.0f, -1.0f, 0.0f);
-	glEnd();
+	geometryBatch.addRect(-1.0f, -1.0f, 1.0f, 1.0f, COLOR_WHITE);
+	geometryBatch.flush();
 }
 
 // Requires the uiShader
@@ -831,9 +771,8 @@ void renderer::renderUI() {
 	// Disable depth test as the draw order should determine what fragments are above each other
 	glDisable(GL_DEPTH_TEST);
 
-	for (unsigned int i = 0; i < uiPanels.size(); i++) {
-		uiPanels[i]->draw();
-	}
+	glUniform1i(uiShader.DistanceFieldUniformID, ui::fontRendering::DistanceFieldAtlas);
+	ui::drawList::render(uiPanels);
 
 	glEnable(GL_DEPTH_TEST);
 }
@@ -841,53 +780,79 @@ void renderer::renderUI() {
 void renderer::renderAll() {
 	preRender();
 
+	// Everything this frame is drawn from the same state of the universe, however many ticks the simulation makes meanwhile
+	simulation::acquireSnapshot();
+	const simulation::Snapshot& snapshot = simulation::getSnapshot();
+
+	// Keeps the last known position while the focused body isn't in the snapshot yet (it was just added)
+	if (snapshot.universeId != focusedUniverseId) {
+		// A scene was loaded: the bodies of the previous one are gone
+		focusedUniverseId = snapshot.universeId;
+		if (!snapshot.bodies.empty()) camera.SetFocusedBody(snapshot.bodies[0].id);
+	}
+
+	const MassBody* focusedBody = findBody(camera.focusedBodyId);
+	if (focusedBody != nullptr) camera.focusedBodyPosition = focusedBody->position;
+
+	ui::updateLabels(snapshot);
+
 	double preRenderTime = glfwGetTime();
-	double deltaTime = preRenderTime - lastTime;
+	double deltaTime = capture::isActive() ? capture::getFrameDuration() : preRenderTime - lastTime; // A video plays at its own frame rate, however long the frames took to render
 
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT); // Fill the void
 
 	double mouseX, mouseY;
 	glfwGetCursorPos(window, &mouseX, &mouseY);
 
-	// Projection matrix : Camera Field of View, right aspect ratio, display range : 0.1 unit <-> 100 units
-	glm::mat4 projectionMatrix = glm::perspective(renderer::camera.fov, (float)windowWidth / (float)windowHeight, 0.1f, 500.0f);
+	// Projection matrix : Camera Field of View, right aspect ratio, display range : FRAME_NEAR_PLANE unit <-> FRAME_FAR_PLANE units
+	glm::mat4 projectionMatrix = getProjection(renderer::camera.fov, (float)windowWidth / (float)windowHeight);
 
 	bool shiftPressed = glfwGetKey(window, GLFW_KEY_LEFT_SHIFT) || glfwGetKey(window, GLFW_KEY_RIGHT_SHIFT);
 	camera.Update(mouseX, mouseY, !shiftPressed && glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_MIDDLE), shiftPressed && glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_MIDDLE), (float)deltaTime);
 
-	glEnable(GL_DEPTH_TEST);
+	buildFrameScene(snapshot, camera.viewMatrix, projectionMatrix, frameScene);
+
+	// The skybox covers the whole screen and is drawn first, so it doesn't need depth testing
+	glDisable(GL_DEPTH_TEST);
 	glUseProgram(starShader.ProgramID);
 	renderStars(projectionMatrix);
-	glClear(GL_DEPTH_BUFFER_BIT); // Clear the depth buffer so that the star sphere will be ignored in depth testing
+	glEnable(GL_DEPTH_TEST);
+
+	// Everything that is the same for every draw of this frame is uploaded once
+	const MassBody* emittingBody = frameScene.light;
+	drawQueue::FrameData frameData;
+	frameData.view = frameScene.view;
+	frameData.projection = frameScene.projection;
+	frameData.viewProjection = frameScene.viewProjection;
+	frameData.light = emittingBody != nullptr ? glm::vec4(emittingBody->position, emittingBody->radius) : glm::vec4(0);
+	frameData.lightColor = emittingBody != nullptr ? glm::vec4(emittingBody->color.red, emittingBody->color.green, emittingBody->color.blue, 1.0f) : glm::vec4(0);
+	frameData.camera = glm::vec4(camera.position, (float)glfwGetTime());
+	drawQueue::setFrameData(frameData);
 
 	glUseProgram(shader.ProgramID);
-	glUniform1i(shader.UnlitUniformID, 1);
-	renderGrid(projectionMatrix, camera.viewMatrix);
 
 	// Render the path of the spawned object
 	if (spawnedBody != nullptr) {
-		MassBody* focusedBody = camera.focusedBody;
 		glm::vec3 mouseRay = CreateMouseRay();
 		glm::vec3 planeNormal = glm::vec3(0, 1, 0); //glm::normalize(camera.position - focusedBody->position); (uncomment if you don't want the spawn position to be contrainted to the horizontal plane)
-		glm::vec3 planeIntersection = PlaneIntersection(focusedBody->position, planeNormal, camera.position, mouseRay);
+		glm::vec3 planeIntersection = PlaneIntersection(spawnedBody->position, planeNormal, camera.position, mouseRay);
 
 		glm::vec3 spawnVelocity = (planeIntersection - spawnedBody->position) * 0.5F;
 
 		glm::vec3 p = spawnedBody->position;
 		glm::vec3 velocity = spawnVelocity;
-		auto bodies = loadedUniverse->GetBodies();
+		const std::vector<MassBody>& bodies = snapshot.bodies;
 		for (int i = 0; i < 50; i++) {
 			// Step 1: calculate velocity
 			glm::vec3 totalGravitationalForce = glm::vec3(0);
 			// Loop through all bodies in the universe to calculate their gravitational pull on the object (TODO: Ignore very far away objects for better performance)
-			for (unsigned int j = 0; j < bodies->size(); j++) {
-				if (i == j) continue; // No need to calculate the gravitational pull of a body on itself as it will always be 0.
-				MassBody* otherBody = bodies->at(j);
+			for (unsigned int j = 0; j < bodies.size(); j++) {
+				const MassBody& otherBody = bodies[j]; // The spawned body isn't part of the snapshot yet, so every body pulls it
 
-				if (!otherBody->affectsOthers) continue; // Ignore this one
+				if (!otherBody.affectsOthers) continue; // Ignore this one
 
-				float force = loadedUniverse->gConstant * spawnedBody->mass * otherBody->mass / std::pow(glm::distance(p, otherBody->position), 2);
-				glm::vec3 forceDirection = glm::normalize(otherBody->position - p);
+				float force = snapshot.gConstant * spawnedBody->mass * otherBody.mass / std::pow(glm::distance(p, otherBody.position), 2);
+				glm::vec3 forceDirection = glm::normalize(otherBody.position - p);
 
 				totalGravitationalForce += forceDirection * force;
 			}
@@ -898,85 +863,106 @@ void renderer::renderAll() {
 			// Step 2: update position
 			p += velocity * 0.5f;
 
-			renderModel(*bodyLODModels[3], projectionMatrix, camera.viewMatrix, glm::scale(glm::translate(glm::mat4(1), p), glm::vec3(0.05F)), COLOR_WHITE);
+			renderModel(bodyLODModels[3], glm::scale(glm::translate(glm::mat4(1), p), glm::vec3(0.05F)), COLOR_WHITE, true);
 		}
 	}
 
-	std::vector<MassBody*> bodies = *loadedUniverse->GetBodies();
-	for (unsigned int i = 0; i < bodies.size(); i++) {
-		renderBody(bodies[i], projectionMatrix);
+	// Find which bodies can shadow the visible ones now that they have moved
+	occluders::update(snapshot.bodies, snapshot.emissiveBodyIndex, frameScene.visibleBodies);
+	occluders::bind(GL_TEXTURE0);
+	glUniform1i(shader.OccludersUniformID, 0);
+
+	for (unsigned int i : frameScene.visibleBodies) {
+		renderBody(snapshot.bodies[i], (int)i == snapshot.emissiveBodyIndex, occluders::get(i));
 	}
 
 	if (spawnedBody != nullptr) {
-		renderBody(spawnedBody, projectionMatrix);
+		renderBody(*spawnedBody, false, { 0, 0 });
 	}
 
+	// Draw the spawn path and the bodies
+	drawQueue::flush();
+
+	// The grid is blended over the bodies that are below it, so it is drawn after them
+	glUseProgram(gridShader.ProgramID);
+	renderGrid();
+
 	glDisable(GL_DEPTH_TEST); // No depth test required from here on as we won't be rendering any 3D stuff
 
+	// Blur the emission buffer into the bloom texture (renders into its own framebuffer)
+	GLuint bloomTextureID = bloom::render(EmissionBufferTextureID);
+
 	// First, let's draw the contents of the color buffer texture to the screen with post-processing. We do this now as we don't want to post-process UI and overlays
 	// Unbind framebuffer
-	glBindFramebuffer(GL_FRAMEBUFFER, 0); // back to default
+	glBindFramebuffer(GL_FRAMEBUFFER, capture::isActive() ? capture::readback::getFramebuffer() : 0); // back to default, unless the frame is captured
 	glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
 	glClear(GL_COLOR_BUFFER_BIT);
 
 	// Draw content of color buffer texture to screen
 	glUseProgram(postProcessingShader.ProgramID);
 	glUniform1i(postProcessingShader.ScreenTextureUniformID, 0);
-	glUniform1i(postProcessingShader.EmissionTextureUniformID, 1);
+	glUniform1i(postProcessingShader.BloomTextureUniformID, 1);
 	glDisable(GL_DEPTH_TEST);
 
 	glActiveTexture(GL_TEXTURE0 + 0);
 	glBindTexture(GL_TEXTURE_2D, ColorBufferTextureID);
 
 	glActiveTexture(GL_TEXTURE0 + 1);
-	glBindTexture(GL_TEXTURE_2D, EmissionBufferTextureID);
+	glBindTexture(GL_TEXTURE_2D, bloomTextureID);
 	glActiveTexture(GL_TEXTURE0 + 0);
 
-	// Draw a quad covering the entire screen (TODO GL_QUADS is depreacted and we should be using a VAO for this)
-	glBegin(GL_QUADS);
-	glVertexAttrib2f(1, 0.0F, 1.0F);
-	glVertex2f(-1.0f, 1.0f);
-	glVertexAttrib2f(1, 0.0F, 0.0F);
-	glVertex2f(-1.0f, -1.0f);
-	glVertexAttrib2f(1, 1.0F, 0.0F);
-	glVertex2f(1.0f, -1.0f);
-	glVertexAttrib2f(1, 1.0F, 1.0F);
-	glVertex2f(1.0f, 1.0f);
-	glEnd();
+	drawFullscreenTriangle();
 
 	// Let's now draw the rest (focus overlay + ui) on top of that
 	// Enable transparency
 	glEnable(GL_BLEND);
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-	glUseProgram(overlayShader.ProgramID);
-	renderFocusOverlay(projectionMatrix);
+	if (!capture::isActive()) { // Captured frames only show the simulation
+		glUseProgram(overlayShader.ProgramID);
+		renderFocusOverlay();
 
-	glUseProgram(uiShader.ProgramID);
-	renderUI();
+		glUseProgram(uiShader.ProgramID);
+		renderUI();
+	}
 
 	glDisable(GL_BLEND);
 
 	/* Swap front and back buffers */
-	glfwSwapBuffers(window);
+	if (capture::isActive()) capture::readback::readFrame();
+	else glfwSwapBuffers(window);
 
 	glfwPollEvents();
 
 	lastTime = preRenderTime;
 
-	postRender(deltaTime);
+	postRender();
+}
+
+void renderer::drawFullscreenTriangle() {
+	glBindVertexArray(FullscreenVertexArrayID);
+	glDrawArrays(GL_TRIANGLES, 0, 3);
+	glBindVertexArray(0);
 }
 
 void renderer::terminate() {
-	delete starSphereModel;
+	capture::readback::stop();
+	capture::stop();
+	simulation::stop();
 
-	for (unsigned int i = 0; i < bodyLODModels.size(); i++) {
-		delete bodyLODModels[i];
-	}
+	meshCache::dispose();
+	bloom::dispose();
+	occluders::dispose();
+	drawQueue::dispose();
+	bodyLODModels.clear();
 
 	glDeleteTextures(1, &ColorBufferTextureID);
 	glDeleteTextures(1, &EmissionBufferTextureID);
+	glDeleteTextures(1, &StarfieldTextureID);
 	glDeleteFramebuffers(1, &FramebufferID);
+	glDeleteVertexArrays(1, &FullscreenVertexArrayID);
+	geometryBatch.dispose();
+	ui::drawList::dispose();
 
 	glfwTerminate();
 }
@@ -14,70 +14,70 @@
 
 #include "../universe/universe.h"
 #include "../universe/mass_body.h"
-#include "baseModels/sphere.h"
-#include "baseModels/star_sphere.h"
+#include "../universe/simulation.h"
+#include "mesh_cache.h"
+#include "bloom.h"
+#include "starfield.h"
+#include "occluders.h"
+#include "draw_queue.h"
+#include "geometry_batch.h"
+#include "frame_readback.h"
+#include "frame_scene.h"
 #include "../ui/ui_manager.h"
 #include "../ui/panel.h"
 #include "../ui/text_field.h"
 #include "../ui/font_renderer.h"
+#include "../ui/ui_draw_list.h"
+
+// This function creates an OpenGL program from a vertex and a fragment shader and returns its ID
+GLuint LoadShaderProgram(const char* vertex_file_path, const char* fragment_file_path);
 
 namespace renderer {
 	// Default shader (used to render objects in the world with or without lighting)
+	// Everything else comes from the FrameData and DrawData uniform blocks (see draw_queue.h)
 	struct Shader {
 		GLuint ProgramID;
-		GLuint MatrixUniformID;
-		GLuint ModelMatrixUniformID;
-		GLuint ViewMatrixUniformID;
-		GLuint UnlitUniformID;
-		GLuint EmissiveUniformID;
-		GLuint LightPosUniformID;
-		GLuint LightColorUniformID;
-		GLuint ModelColorUniformID;
-
-		// Shadow marching Uniforms
-		GLuint OccluderCountUniformID;
-		GLuint OccluderPositionsUniformIDs[MAX_OCCLUDERS];
-		GLuint OccluderRadiusesUniformIDs[MAX_OCCLUDERS];
-		GLuint LightRadiusUniformID;
+		GLuint OccludersUniformID;
 	};
 
-	// Shader used to render star spheres
+	// Shader used to render the starfield skybox
 	struct StarShader {
 		GLuint ProgramID;
-		GLuint MatrixUniformID;
-		GLuint ModelMatrixUniformID;
-		GLuint ViewMatrixUniformID;
+		GLuint InverseViewProjectionMatrixUniformID;
+		GLuint StarfieldTextureUniformID;
+	};
+
+	// Shader used to render the infinite ground grid
+	struct GridShader {
+		GLuint ProgramID;
 	};
 
 	// Shader used to render overlays (currently just the focused-body indicator)
 	struct OverlayShader {
 		GLuint ProgramID;
-		GLuint CamRightUniformID;
-		GLuint CamUpUniformID;
-		GLuint ViewProjectionMatrixUniformID;
 		GLuint OverlayPositionUniformID;
 		GLuint OverlaySizeUniformID;
-		GLuint TimeUniformID;
 	};
 
 	// Shader used to render User Interface
 	struct UIShader {
 		GLuint ProgramID;
-		GLuint UseTextureUniformID;
+		GLuint DistanceFieldUniformID;
 	};
 
 	// Post processing shader
 	struct PostProcessingShader {
 		GLuint ProgramID;
 		GLuint ScreenTextureUniformID;
-		GLuint EmissionTextureUniformID;
+		GLuint BloomTextureUniformID;
 	};
 
 	struct Camera {
 		float fov;
 		float sensitivity;
 
-		MassBody* focusedBody;
+		unsigned int focusedBodyId; // Its state comes from the simulation snapshot (see renderer::findBody)
+		glm::vec3 focusedBodyPosition; // Updated every frame from the snapshot
 		glm::vec3 offset, deltaOffset;
 		float distance; // The distance between the camera and the focused position
 
@@ -105,21 +105,25 @@ namespace renderer {
 		Camera(glm::vec3 offset, glm::vec2 orbitAngles, float distance, float fov, float sensitivity);
 
 		void Update(double mouseX, double mouseY, bool orbiting, bool dragging, float deltaTime);
-		void SetFocusedBody(MassBody* focusedBody);
+		void SetFocusedBody(unsigned int focusedBodyId);
 	};
 
-	int init();
-	void renderModel(RenderModel model, glm::mat4 projectionMatrix, glm::mat4 viewMatrix, glm::mat4 modelMatrix, Color color);
-	void renderBody(MassBody* body, glm::mat4 projectionMatrix);
+	// With an offscreen resolution, the window stays hidden and everything is rendered at that resolution (see capture::start)
+	int init(int offscreenWidth = 0, int offscreenHeight = 0);
+	void drawFullscreenTriangle(); // Draws a triangle covering the whole screen with the currently bound program (the vertices are generated in the vertex shader)
+	void renderModel(RenderModel* model, glm::mat4 modelMatrix, Color color, bool unlit); // Queues the model, it is drawn by the next drawQueue::flush()
+	void renderBody(const MassBody& body, bool emissive, occluders::OccluderRange occluderRange);
 	void renderStars(glm::mat4 projectionMatrix);
-	void renderGrid(glm::mat4 projectionMatrix, glm::mat4 viewMatrix);
-	void renderFocusOverlay(glm::mat4 projectionMatrix);
+	void renderGrid();
+	void renderFocusOverlay();
 	void renderUI();
 	void renderAll();
 	void preRender();
-	void postRender(double deltaTime);
+	void postRender();
 	void mouseDown(float mouseX, float mouseY, int button); // mouseX and mouseY are in OpenGL Screen-space [-1;1]
-	void setUniverse(Universe* universe);
+	void setUniverse(Universe* universe, bool realTime = true); // Hands the universe over to the simulation (see simulation::start for realTime)
+	const MassBody* findBody(unsigned int bodyId); // Current state of a body (the body being spawned, or its copy in the snapshot), nullptr if it isn't simulated yet
+	void setBodyProperty(unsigned int bodyId, simulation::BodyProperty property, simulation::PropertyValue value); // Applied right away to the body being spawned, between two ticks to simulated ones
 	void terminate();
 
 	glm::vec3 CreateMouseRay();
@@ -128,17 +132,17 @@ namespace renderer {
 	GLFWwindow* getWindow();
 
 	extern Camera camera;
-	extern Universe* loadedUniverse;
 	extern GLFWwindow* window;
 
 	extern Shader shader;
 	extern StarShader starShader;
+	extern GridShader gridShader;
 	extern OverlayShader overlayShader;
 	extern UIShader uiShader;
 	extern PostProcessingShader postProcessingShader;
 
-	extern std::vector<Sphere*> bodyLODModels; // Array of spheres with different resolutions used to render bodies
-	extern StarSphere* starSphereModel;
+	extern std::vector<RenderModel*> bodyLODModels; // Array of spheres with different resolutions used to render bodies (owned by the mesh cache)
+	extern GLuint StarfieldTextureID; // Cubemap baked at startup
 
 	extern std::vector<ui::Panel*> uiPanels;
 	extern ui::TextFieldComponent* focusedTextField;
@@ -147,6 +151,8 @@ namespace renderer {
 	extern GLuint ColorBufferTextureID;
 	extern GLuint EmissionBufferTextureID;
 	extern GLuint rbo;
+	extern GLuint FullscreenVertexArrayID; // Empty VAO bound when drawing the fullscreen triangle
+	extern GeometryBatch geometryBatch; // Used to draw geometry generated on the CPU (grid, overlay, UI)
 
 	extern int windowWidth;
 	extern int windowHeight;
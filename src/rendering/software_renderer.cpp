@@ -0,0 +1,559 @@
+#include "software_renderer.h"
+#include "starfield_bake.h"
+#include "bloom_settings.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cfloat>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SOFTWARE_SSE2
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define SOFTWARE_NEON
+#endif
+
+#define SOFTWARE_TONE_MAP_RANGE 16.0f // Colors above this are all white after the tone mapping
+
+namespace renderer {
+	// 4 pixels of a row, processed together
+#if defined(SOFTWARE_SSE2)
+	struct Mask4 {
+		__m128 v;
+		Mask4 operator&(Mask4 other) const { return { _mm_and_ps(v, other.v) }; }
+		int bits() const { return _mm_movemask_ps(v); }
+	};
+
+	struct Float4 {
+		__m128 v;
+		Float4(__m128 v) : v(v) {}
+		Float4(float value) : v(_mm_set1_ps(value)) {}
+		Float4(float a, float b, float c, float d) : v(_mm_setr_ps(a, b, c, d)) {}
+		static Float4 load(const float* values) { return _mm_loadu_ps(values); }
+		void store(float* values) const { _mm_storeu_ps(values, v); }
+
+		Float4 operator+(Float4 other) const { return _mm_add_ps(v, other.v); }
+		Float4 operator-(Float4 other) const { return _mm_sub_ps(v, other.v); }
+		Float4 operator*(Float4 other) const { return _mm_mul_ps(v, other.v); }
+		Float4 operator/(Float4 other) const { return _mm_div_ps(v, other.v); }
+		Mask4 operator<(Float4 other) const { return { _mm_cmplt_ps(v, other.v) }; }
+		Mask4 operator>(Float4 other) const { return { _mm_cmpgt_ps(v, other.v) }; }
+		Mask4 operator>=(Float4 other) const { return { _mm_cmpge_ps(v, other.v) }; }
+	};
+
+	static Float4 sqrt(Float4 a) { return _mm_sqrt_ps(a.v); }
+	static Float4 min(Float4 a, Float4 b) { return _mm_min_ps(a.v, b.v); }
+	static Float4 max(Float4 a, Float4 b) { return _mm_max_ps(a.v, b.v); }
+	static Float4 select(Mask4 mask, Float4 a, Float4 b) { return _mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v)); }
+#elif defined(SOFTWARE_NEON)
+	struct Mask4 {
+		uint32x4_t v;
+		Mask4 operator&(Mask4 other) const { return { vandq_u32(v, other.v) }; }
+		int bits() const {
+			const uint32x4_t weights = { 1, 2, 4, 8 };
+			return (int)vaddvq_u32(vandq_u32(v, weights));
+		}
+	};
+
+	struct Float4 {
+		float32x4_t v;
+		Float4(float32x4_t v) : v(v) {}
+		Float4(float value) : v(vdupq_n_f32(value)) {}
+		Float4(float a, float b, float c, float d) { float values[4] = { a, b, c, d }; v = vld1q_f32(values); }
+		static Float4 load(const float* values) { return vld1q_f32(values); }
+		void store(float* values) const { vst1q_f32(values, v); }
+
+		Float4 operator+(Float4 other) const { return vaddq_f32(v, other.v); }
+		Float4 operator-(Float4 other) const { return vsubq_f32(v, other.v); }
+		Float4 operator*(Float4 other) const { return vmulq_f32(v, other.v); }
+		Float4 operator/(Float4 other) const { return vdivq_f32(v, other.v); }
+		Mask4 operator<(Float4 other) const { return { vcltq_f32(v, other.v) }; }
+		Mask4 operator>(Float4 other) const { return { vcgtq_f32(v, other.v) }; }
+		Mask4 operator>=(Float4 other) const { return { vcgeq_f32(v, other.v) }; }
+	};
+
+	static Float4 sqrt(Float4 a) { return vsqrtq_f32(a.v); }
+	static Float4 min(Float4 a, Float4 b) { return vminq_f32(a.v, b.v); }
+	static Float4 max(Float4 a, Float4 b) { return vmaxq_f32(a.v, b.v); }
+	static Float4 select(Mask4 mask, Float4 a, Float4 b) { return vbslq_f32(mask.v, a.v, b.v); }
+#else
+	struct Mask4 {
+		bool v[4];
+		Mask4 operator&(Mask4 other) const { return { { v[0] && other.v[0], v[1] && other.v[1], v[2] && other.v[2], v[3] && other.v[3] } }; }
+		int bits() const { return v[0] | v[1] << 1 | v[2] << 2 | v[3] << 3; }
+	};
+
+	struct Float4 {
+		float v[4];
+		Float4(float value) : v{ value, value, value, value } {}
+		Float4(float a, float b, float c, float d) : v{ a, b, c, d } {}
+		static Float4 load(const float* values) { return Float4(values[0], values[1], values[2], values[3]); }
+		void store(float* values) const { memcpy(values, v, sizeof(v)); }
+
+		Float4 operator+(Float4 o) const { return Float4(v[0] + o.v[0], v[1] + o.v[1], v[2] + o.v[2], v[3] + o.v[3]); }
+		Float4 operator-(Float4 o) const { return Float4(v[0] - o.v[0], v[1] - o.v[1], v[2] - o.v[2], v[3] - o.v[3]); }
+		Float4 operator*(Float4 o) const { return Float4(v[0] * o.v[0], v[1] * o.v[1], v[2] * o.v[2], v[3] * o.v[3]); }
+		Float4 operator/(Float4 o) const { return Float4(v[0] / o.v[0], v[1] / o.v[1], v[2] / o.v[2], v[3] / o.v[3]); }
+		Mask4 operator<(Float4 o) const { return { { v[0] < o.v[0], v[1] < o.v[1], v[2] < o.v[2], v[3] < o.v[3] } }; }
+		Mask4 operator>(Float4 o) const { return { { v[0] > o.v[0], v[1] > o.v[1], v[2] > o.v[2], v[3] > o.v[3] } }; }
+		Mask4 operator>=(Float4 o) const { return { { v[0] >= o.v[0], v[1] >= o.v[1], v[2] >= o.v[2], v[3] >= o.v[3] } }; }
+	};
+
+	static Float4 sqrt(Float4 a) { return Float4(std::sqrt(a.v[0]), std::sqrt(a.v[1]), std::sqrt(a.v[2]), std::sqrt(a.v[3])); }
+	static Float4 min(Float4 a, Float4 b) { return Float4(std::fmin(a.v[0], b.v[0]), std::fmin(a.v[1], b.v[1]), std::fmin(a.v[2], b.v[2]), std::fmin(a.v[3], b.v[3])); }
+	static Float4 max(Float4 a, Float4 b) { return Float4(std::fmax(a.v[0], b.v[0]), std::fmax(a.v[1], b.v[1]), std::fmax(a.v[2], b.v[2]), std::fmax(a.v[3], b.v[3])); }
+	static Float4 select(Mask4 mask, Float4 a, Float4 b) {
+		return Float4(mask.v[0] ? a.v[0] : b.v[0], mask.v[1] ? a.v[1] : b.v[1], mask.v[2] ? a.v[2] : b.v[2], mask.v[3] ? a.v[3] : b.v[3]);
+	}
+#endif
+
+	// Same as the bilinear filtering of a texture with clamped edges
+	static glm::vec3 sampleBilinear(const std::vector<float>& image, int width, int height, float x, float y) {
+		x = std::min(std::max(x, 0.0f), width - 1.0f);
+		y = std::min(std::max(y, 0.0f), height - 1.0f);
+		int x0 = (int)x, y0 = (int)y;
+		int x1 = std::min(x0 + 1, width - 1), y1 = std::min(y0 + 1, height - 1);
+		float tx = x - x0, ty = y - y0;
+
+		const float* p00 = &image[((size_t)y0 * width + x0) * 3];
+		const float* p10 = &image[((size_t)y0 * width + x1) * 3];
+		const float* p01 = &image[((size_t)y1 * width + x0) * 3];
+		const float* p11 = &image[((size_t)y1 * width + x1) * 3];
+
+		glm::vec3 result;
+		for (int c = 0; c < 3; c++) {
+			float top = p00[c] + (p10[c] - p00[c]) * tx;
+			float bottom = p01[c] + (p11[c] - p01[c]) * tx;
+			result[c] = top + (bottom - top) * ty;
+		}
+		return result;
+	}
+
+	SoftwareRenderer::SoftwareRenderer(unsigned int threadCount) : workers(threadCount), width(0), height(0), tileColumns(0), tileRows(0) {
+		starfield::bake(STARFIELD_SEED, STARFIELD_STAR_COUNT, STARFIELD_FACE_SIZE, starfieldFaces);
+
+		// Tone mapping and gamma correction of the post-processing shader. The table is indexed by the square root of the color,
+		// which gives more entries to the dark colors, where the gamma curve is the steepest
+		for (int i = 0; i < SOFTWARE_TONE_MAP_SIZE; i++) {
+			float root = (float)i / (SOFTWARE_TONE_MAP_SIZE - 1);
+			float color = root * root * SOFTWARE_TONE_MAP_RANGE;
+			toneMap[i] = (uint8_t)(std::pow(1.0f - std::exp(-color), 1.0f / 2.2f) * 255.0f + 0.5f);
+		}
+	}
+
+	void SoftwareRenderer::resize(int newWidth, int newHeight) {
+		if (newWidth == width && newHeight == height) return;
+
+		width = newWidth;
+		height = newHeight;
+		tileColumns = (width + SOFTWARE_TILE_SIZE - 1) / SOFTWARE_TILE_SIZE;
+		tileRows = (height + SOFTWARE_TILE_SIZE - 1) / SOFTWARE_TILE_SIZE;
+
+		colors.assign((size_t)width * height * 3, 0.0f);
+		emissions.assign((size_t)width * height * 3, 0.0f);
+		tileBodies.assign((size_t)tileColumns * tileRows, std::vector<uint32_t>());
+
+		bloomLevels.clear();
+		bloomTemporaries.clear();
+		bloomWidths.clear();
+		bloomHeights.clear();
+
+		int levelWidth = width / 2;
+		int levelHeight = height / 2;
+		while (bloomLevels.size() < BLOOM_MAX_LEVELS && levelWidth >= BLOOM_MIN_LEVEL_SIZE && levelHeight >= BLOOM_MIN_LEVEL_SIZE) {
+			bloomLevels.push_back(std::vector<float>((size_t)levelWidth * levelHeight * 3));
+			bloomTemporaries.push_back(std::vector<float>((size_t)levelWidth * levelHeight * 3));
+			bloomWidths.push_back(levelWidth);
+			bloomHeights.push_back(levelHeight);
+
+			levelWidth /= 2;
+			levelHeight /= 2;
+		}
+	}
+
+	void SoftwareRenderer::projectBodies(const FrameScene& scene) {
+		float scaleX = scene.projection[0][0], scaleY = scene.projection[1][1];
+		float pixelsPerUnit = scaleY * height * 0.5f; // At a distance of 1
+
+		projectedBodies.clear();
+		for (std::vector<uint32_t>& bodies : tileBodies) bodies.clear();
+
+		for (unsigned int index : scene.visibleBodies) {
+			const MassBody& body = scene.snapshot->bodies[index];
+
+			ProjectedBody projected;
+			projected.center = glm::vec3(scene.view * glm::vec4(body.position, 1.0f));
+			projected.radius = body.radius;
+			projected.color = glm::vec3(body.color.red, body.color.green, body.color.blue) * getFogVisibility(glm::length(projected.center));
+			projected.emissive = (int)index == scene.snapshot->emissiveBodyIndex;
+
+			float depth = -projected.center.z;
+			if (depth - body.radius <= FRAME_NEAR_PLANE) {
+				// Around the camera: could be anywhere on the screen
+				projected.point = false;
+				projected.minX = 0;
+				projected.minY = 0;
+				projected.maxX = width - 1;
+				projected.maxY = height - 1;
+			}
+			else {
+				float screenX = (projected.center.x * scaleX / depth + 1.0f) * 0.5f * width;
+				float screenY = (1.0f - projected.center.y * scaleY / depth) * 0.5f * height;
+				float pixelRadius = body.radius * pixelsPerUnit / depth;
+
+				projected.point = pixelRadius < SOFTWARE_POINT_RADIUS;
+				if (projected.point) {
+					projected.coverage = std::min(glm::pi<float>() * pixelRadius * pixelRadius, 1.0f);
+					projected.minX = projected.maxX = (int)std::floor(screenX);
+					projected.minY = projected.maxY = (int)std::floor(screenY);
+				}
+				else {
+					// The silhouette is a bit bigger than the sphere seen from its center's distance
+					float extentX = body.radius * scaleX / (depth - body.radius) * 0.5f * width;
+					float extentY = body.radius * scaleY / (depth - body.radius) * 0.5f * height;
+					projected.minX = (int)std::floor(screenX - extentX);
+					projected.maxX = (int)std::ceil(screenX + extentX);
+					projected.minY = (int)std::floor(screenY - extentY);
+					projected.maxY = (int)std::ceil(screenY + extentY);
+				}
+			}
+
+			projected.minX = std::max(projected.minX, 0);
+			projected.minY = std::max(projected.minY, 0);
+			projected.maxX = std::min(projected.maxX, width - 1);
+			projected.maxY = std::min(projected.maxY, height - 1);
+			if (projected.minX > projected.maxX || projected.minY > projected.maxY) continue;
+
+			uint32_t projectedIndex = (uint32_t)projectedBodies.size();
+			projectedBodies.push_back(projected);
+
+			for (int tileY = projected.minY / SOFTWARE_TILE_SIZE; tileY <= projected.maxY / SOFTWARE_TILE_SIZE; tileY++) {
+				for (int tileX = projected.minX / SOFTWARE_TILE_SIZE; tileX <= projected.maxX / SOFTWARE_TILE_SIZE; tileX++) {
+					tileBodies[(size_t)tileY * tileColumns + tileX].push_back(projectedIndex);
+				}
+			}
+		}
+	}
+
+	// Ray-traces the sphere over the given pixels of the tile, 4 pixels of a row at a time
+	void SoftwareRenderer::renderSpheres(const ProjectedBody& body, int x0, int y0, int x1, int y1, float* depths, int tileX0, int tileY0) {
+		const glm::vec3& c = body.center;
+		float sphereTerm = glm::dot(c, c) - body.radius * body.radius;
+		float inverseRadius = 1.0f / body.radius;
+
+		int firstX = tileX0 + ((x0 - tileX0) & ~3); // Groups of 4 start on the tile's grid, so their depths are contiguous
+		float ndcStep = 2.0f / width;
+
+		for (int y = y0; y <= y1; y++) {
+			float rayY = (1.0f - (y + 0.5f) * 2.0f / height) * rayScaleY;
+			float rowA = rayY * rayY + 1.0f;
+			float rowB = rayY * c.y - c.z;
+
+			for (int x = firstX; x <= x1; x += 4) {
+				float firstNdc = (x + 0.5f) * ndcStep - 1.0f;
+				Float4 rayX = Float4(firstNdc, firstNdc + ndcStep, firstNdc + 2 * ndcStep, firstNdc + 3 * ndcStep) * Float4(rayScaleX);
+				Float4 pixelX = Float4((float)x, (float)x + 1, (float)x + 2, (float)x + 3);
+
+				// |t * ray - c|² = r², the ray being (rayX, rayY, -1) so that t is the depth
+				Float4 a = rayX * rayX + Float4(rowA);
+				Float4 b = rayX * Float4(c.x) + Float4(rowB);
+				Float4 discriminant = b * b - a * Float4(sphereTerm);
+				Float4 t = (b - sqrt(max(discriminant, Float4(0.0f)))) / a;
+
+				float* depth = depths + (size_t)(y - tileY0) * SOFTWARE_TILE_SIZE + (x - tileX0);
+				Float4 previousDepth = Float4::load(depth);
+				Mask4 hit = (discriminant >= Float4(0.0f)) & (t > Float4(FRAME_NEAR_PLANE)) & (t < previousDepth)
+					& (pixelX >= Float4((float)x0)) & (pixelX < Float4((float)x1 + 1.0f));
+
+				int hitBits = hit.bits();
+				if (hitBits == 0) continue;
+
+				select(hit, t, previousDepth).store(depth);
+
+				float red[4], green[4], blue[4];
+				if (body.emissive) {
+					for (int lane = 0; lane < 4; lane++) {
+						red[lane] = body.color.r;
+						green[lane] = body.color.g;
+						blue[lane] = body.color.b;
+					}
+				}
+				else {
+					// Lambert lighting with an ambient floor, like the default fragment shader
+					Float4 normalX = (t * rayX - Float4(c.x)) * Float4(inverseRadius);
+					Float4 normalY = (t * Float4(rayY) - Float4(c.y)) * Float4(inverseRadius);
+					Float4 normalZ = (Float4(0.0f) - t - Float4(c.z)) * Float4(inverseRadius);
+
+					Float4 toLightX = Float4(lightPosition.x) - t * rayX;
+					Float4 toLightY = Float4(lightPosition.y) - t * Float4(rayY);
+					Float4 toLightZ = Float4(lightPosition.z) + t;
+					Float4 toLightLength = sqrt(toLightX * toLightX + toLightY * toLightY + toLightZ * toLightZ);
+					Float4 cosTheta = (normalX * toLightX + normalY * toLightY + normalZ * toLightZ) / max(toLightLength, Float4(1e-6f));
+					cosTheta = min(max(cosTheta, Float4(0.0f)), Float4(1.0f));
+
+					max(Float4(body.color.r * lightColor.r) * cosTheta, Float4(body.color.r * FRAME_MIN_LIGHT_LEVEL)).store(red);
+					max(Float4(body.color.g * lightColor.g) * cosTheta, Float4(body.color.g * FRAME_MIN_LIGHT_LEVEL)).store(green);
+					max(Float4(body.color.b * lightColor.b) * cosTheta, Float4(body.color.b * FRAME_MIN_LIGHT_LEVEL)).store(blue);
+				}
+
+				for (int lane = 0; lane < 4; lane++) {
+					if (!(hitBits & (1 << lane))) continue;
+
+					size_t pixel = ((size_t)y * width + x + lane) * 3;
+					colors[pixel + 0] = red[lane];
+					colors[pixel + 1] = green[lane];
+					colors[pixel + 2] = blue[lane];
+
+					glm::vec3 emission = body.emissive ? body.color : glm::vec3(0.0f);
+					emissions[pixel + 0] = emission.r;
+					emissions[pixel + 1] = emission.g;
+					emissions[pixel + 2] = emission.b;
+				}
+			}
+		}
+	}
+
+	void SoftwareRenderer::renderTile(int tileX, int tileY) {
+		int x0 = tileX * SOFTWARE_TILE_SIZE, y0 = tileY * SOFTWARE_TILE_SIZE;
+		int x1 = std::min(x0 + SOFTWARE_TILE_SIZE, width) - 1, y1 = std::min(y0 + SOFTWARE_TILE_SIZE, height) - 1;
+
+		// Starfield, sampled without filtering in the direction of every pixel
+		int faceSize = STARFIELD_FACE_SIZE;
+		for (int y = y0; y <= y1; y++) {
+			float rayY = (1.0f - (y + 0.5f) * 2.0f / height) * rayScaleY;
+			for (int x = x0; x <= x1; x++) {
+				float rayX = ((x + 0.5f) * 2.0f / width - 1.0f) * rayScaleX;
+
+				float s, t;
+				int face = starfield::directionToFace(cameraToWorld * glm::vec3(rayX, rayY, -1.0f), s, t);
+				int faceX = std::min((int)(s * faceSize), faceSize - 1), faceY = std::min((int)(t * faceSize), faceSize - 1);
+				float brightness = starfieldFaces[face][(size_t)faceY * faceSize + faceX] * (1.0f / 255.0f);
+
+				size_t pixel = ((size_t)y * width + x) * 3;
+				colors[pixel + 0] = colors[pixel + 1] = colors[pixel + 2] = brightness;
+				emissions[pixel + 0] = emissions[pixel + 1] = emissions[pixel + 2] = 0.0f;
+			}
+		}
+
+		float depths[SOFTWARE_TILE_SIZE * SOFTWARE_TILE_SIZE];
+		std::fill(depths, depths + SOFTWARE_TILE_SIZE * SOFTWARE_TILE_SIZE, FLT_MAX);
+
+		const std::vector<uint32_t>& bodies = tileBodies[(size_t)tileY * tileColumns + tileX];
+
+		// Spheres first, so that the points behind them are hidden whatever the order of the bodies
+		for (uint32_t index : bodies) {
+			const ProjectedBody& body = projectedBodies[index];
+			if (body.point) continue;
+
+			renderSpheres(body, std::max(body.minX, x0), std::max(body.minY, y0), std::min(body.maxX, x1), std::min(body.maxY, y1), depths, x0, y0);
+		}
+
+		// Points are blended by the part of the pixel they cover, lit by how much of their lit half faces the camera
+		for (uint32_t index : bodies) {
+			const ProjectedBody& body = projectedBodies[index];
+			if (!body.point) continue;
+
+			float depth = -body.center.z;
+			if (depth >= depths[(body.minY - y0) * SOFTWARE_TILE_SIZE + body.minX - x0]) continue;
+
+			glm::vec3 color = body.color;
+			if (!body.emissive) {
+				float litFraction = 0.5f + 0.5f * glm::dot(glm::normalize(lightPosition - body.center), glm::normalize(-body.center));
+				color = glm::max(body.color * lightColor * litFraction, body.color * FRAME_MIN_LIGHT_LEVEL);
+			}
+
+			size_t pixel = ((size_t)body.minY * width + body.minX) * 3;
+			for (int c = 0; c < 3; c++) {
+				colors[pixel + c] += (color[c] - colors[pixel + c]) * body.coverage;
+				if (body.emissive) emissions[pixel + c] += body.color[c] * body.coverage;
+			}
+		}
+	}
+
+	// The 9-tap gaussian of the bloom blur shader, horizontally then vertically, with clamped edges.
+	// A row is a flat array of floats where the neighbour of a channel is 3 floats away, so the interior is blurred 4 floats at a time
+	void SoftwareRenderer::blurLevel(int level) {
+		static const float weights[5] = { 0.2270270270f, 0.1945945946f, 0.1216216216f, 0.0540540541f, 0.0162162162f };
+		int levelWidth = bloomWidths[level], levelHeight = bloomHeights[level];
+		int rowSize = levelWidth * 3;
+		std::vector<float>& image = bloomLevels[level];
+		std::vector<float>& temporary = bloomTemporaries[level];
+
+		workers.run(levelHeight, [&](size_t y) {
+			const float* row = &image[y * rowSize];
+			float* output = &temporary[y * rowSize];
+
+			int x = 0;
+			auto blurEdge = [&](int i) {
+				int pixel = i / 3, c = i % 3;
+				float sum = row[i] * weights[0];
+				for (int tap = 1; tap < 5; tap++) {
+					sum += (row[std::max(pixel - tap, 0) * 3 + c] + row[std::min(pixel + tap, levelWidth - 1) * 3 + c]) * weights[tap];
+				}
+				output[i] = sum;
+			};
+
+			for (; x < std::min(12, rowSize); x++) blurEdge(x);
+			for (; x + 4 <= rowSize - 12; x += 4) {
+				Float4 sum = Float4::load(row + x) * Float4(weights[0]);
+				for (int tap = 1; tap < 5; tap++) {
+					sum = sum + (Float4::load(row + x - tap * 3) + Float4::load(row + x + tap * 3)) * Float4(weights[tap]);
+				}
+				sum.store(output + x);
+			}
+			for (; x < rowSize; x++) blurEdge(x);
+		});
+
+		workers.run(levelHeight, [&](size_t y) {
+			const float* rows[9];
+			for (int tap = -4; tap <= 4; tap++) {
+				rows[tap + 4] = &temporary[(size_t)std::min(std::max((int)y + tap, 0), levelHeight - 1) * rowSize];
+			}
+			float* output = &image[y * rowSize];
+
+			int x = 0;
+			for (; x + 4 <= rowSize; x += 4) {
+				Float4 sum = Float4::load(rows[4] + x) * Float4(weights[0]);
+				for (int tap = 1; tap < 5; tap++) {
+					sum = sum + (Float4::load(rows[4 - tap] + x) + Float4::load(rows[4 + tap] + x)) * Float4(weights[tap]);
+				}
+				sum.store(output + x);
+			}
+			for (; x < rowSize; x++) {
+				float sum = rows[4][x] * weights[0];
+				for (int tap = 1; tap < 5; tap++) sum += (rows[4 - tap][x] + rows[4 + tap][x]) * weights[tap];
+				output[x] = sum;
+			}
+		});
+	}
+
+	// Same steps as bloom::render: thresholded downsampling, blur of every level, then every level added to the next bigger one
+	void SoftwareRenderer::renderBloom() {
+		for (size_t level = 0; level < bloomLevels.size(); level++) {
+			const std::vector<float>& source = level == 0 ? emissions : bloomLevels[level - 1];
+			int sourceWidth = level == 0 ? width : bloomWidths[level - 1];
+			int sourceHeight = level == 0 ? height : bloomHeights[level - 1];
+			int levelWidth = bloomWidths[level];
+			std::vector<float>& destination = bloomLevels[level];
+
+			workers.run(bloomHeights[level], [&](size_t y) {
+				for (int x = 0; x < levelWidth; x++) {
+					int sourceX = std::min(x * 2, sourceWidth - 2), sourceY = std::min((int)y * 2, sourceHeight - 2);
+					glm::vec3 color(0.0f);
+					for (int dy = 0; dy < 2; dy++) {
+						for (int dx = 0; dx < 2; dx++) {
+							const float* pixel = &source[((size_t)(sourceY + dy) * sourceWidth + sourceX + dx) * 3];
+							color += glm::vec3(pixel[0], pixel[1], pixel[2]) * 0.25f;
+						}
+					}
+
+					if (level == 0) {
+						float brightness = std::max(color.r, std::max(color.g, color.b));
+						color *= std::max(brightness - BLOOM_THRESHOLD, 0.0f) / std::max(brightness, 0.0001f);
+					}
+
+					memcpy(&destination[(y * levelWidth + x) * 3], &color, sizeof(color));
+				}
+			});
+		}
+
+		for (size_t level = 0; level < bloomLevels.size(); level++) {
+			blurLevel((int)level);
+		}
+
+		for (int level = (int)bloomLevels.size() - 2; level >= 0; level--) {
+			int levelWidth = bloomWidths[level];
+			workers.run(bloomHeights[level], [&](size_t y) {
+				for (int x = 0; x < levelWidth; x++) {
+					glm::vec3 smaller = sampleBilinear(bloomLevels[level + 1], bloomWidths[level + 1], bloomHeights[level + 1], (x + 0.5f) * 0.5f - 0.5f, (y + 0.5f) * 0.5f - 0.5f);
+					float* pixel = &bloomLevels[level][(y * levelWidth + x) * 3];
+					pixel[0] += smaller.r;
+					pixel[1] += smaller.g;
+					pixel[2] += smaller.b;
+				}
+			});
+		}
+	}
+
+	// The post-processing shader: bloom added to the color, tone mapping and gamma correction
+	void SoftwareRenderer::resolve(uint8_t* pixels, size_t rowBytes) {
+		bool hasBloom = !bloomLevels.empty();
+		float toneMapScale = (SOFTWARE_TONE_MAP_SIZE - 1) / std::sqrt(SOFTWARE_TONE_MAP_RANGE);
+		int rowSize = width * 3;
+
+		// The emissions are no longer needed once the bloom is built: every row keeps its bloom, then its table indices, in its own part of them
+		workers.run(height, [&](size_t y) {
+			float* hdr = &emissions[y * rowSize];
+			const float* color = &colors[y * rowSize];
+
+			// Bloom of the row, interpolated between two rows of the half resolution level
+			if (hasBloom) {
+				int levelWidth = bloomWidths[0], levelHeight = bloomHeights[0];
+				float levelY = std::min(std::max((y + 0.5f) * 0.5f - 0.5f, 0.0f), levelHeight - 1.0f);
+				int y0 = (int)levelY, y1 = std::min(y0 + 1, levelHeight - 1);
+				float ty = levelY - y0;
+				const float* above = &bloomLevels[0][(size_t)y0 * levelWidth * 3];
+				const float* below = &bloomLevels[0][(size_t)y1 * levelWidth * 3];
+
+				for (int x = 0; x < width; x++) {
+					float levelX = std::min(std::max((x + 0.5f) * 0.5f - 0.5f, 0.0f), levelWidth - 1.0f);
+					int x0 = (int)levelX, x1 = std::min(x0 + 1, levelWidth - 1);
+					float tx = levelX - x0;
+					for (int c = 0; c < 3; c++) {
+						float top = above[x0 * 3 + c] + (above[x1 * 3 + c] - above[x0 * 3 + c]) * tx;
+						float bottom = below[x0 * 3 + c] + (below[x1 * 3 + c] - below[x0 * 3 + c]) * tx;
+						hdr[x * 3 + c] = 0.5f * (top + (bottom - top) * ty);
+					}
+				}
+			}
+			else {
+				std::fill(hdr, hdr + rowSize, 0.0f);
+			}
+
+			// Table index of every channel (the last channels, which don't fill 4 lanes, one at a time)
+			int x = 0;
+			for (; x + 4 <= rowSize; x += 4) {
+				Float4 value = min(max(Float4::load(color + x) + Float4::load(hdr + x), Float4(0.0f)), Float4(SOFTWARE_TONE_MAP_RANGE));
+				(sqrt(value) * Float4(toneMapScale) + Float4(0.5f)).store(hdr + x);
+			}
+			for (; x < rowSize; x++) {
+				float value = std::min(std::max(color[x] + hdr[x], 0.0f), SOFTWARE_TONE_MAP_RANGE);
+				hdr[x] = std::sqrt(value) * toneMapScale + 0.5f;
+			}
+
+			uint8_t* row = pixels + y * rowBytes;
+			for (x = 0; x < rowSize; x++) {
+				row[x] = toneMap[(int)hdr[x]];
+			}
+		});
+	}
+
+	void SoftwareRenderer::render(const FrameScene& scene, uint8_t* pixels, int newWidth, int newHeight, size_t rowBytes) {
+		if (newWidth <= 0 || newHeight <= 0) return;
+		resize(newWidth, newHeight);
+
+		rayScaleX = 1.0f / scene.projection[0][0];
+		rayScaleY = 1.0f / scene.projection[1][1];
+		cameraToWorld = glm::transpose(glm::mat3(scene.view));
+
+		if (scene.light != nullptr) {
+			lightPosition = glm::vec3(scene.view * glm::vec4(scene.light->position, 1.0f));
+			lightColor = glm::vec3(scene.light->color.red, scene.light->color.green, scene.light->color.blue);
+		}
+		else {
+			lightPosition = glm::vec3(0.0f);
+			lightColor = glm::vec3(0.0f);
+		}
+
+		projectBodies(scene);
+
+		workers.run((size_t)tileColumns * tileRows, [&](size_t tile) {
+			renderTile((int)(tile % tileColumns), (int)(tile / tileColumns));
+		});
+
+		renderBloom();
+		resolve(pixels, rowBytes);
+	}
+}
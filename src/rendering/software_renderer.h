@@ -0,0 +1,70 @@
+#pragma once
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include "frame_scene.h"
+#include "../universe/worker_pool.h"
+
+#define SOFTWARE_TILE_SIZE 64 // Pixels on each side of the tiles the threads render (multiple of 4, the SIMD width)
+#define SOFTWARE_POINT_RADIUS 0.75f // Bodies smaller than this on screen (in pixels) are drawn as a single pixel covered in part
+#define SOFTWARE_TONE_MAP_SIZE 4096 // Entries of the tone mapping table, indexed by the square root of the color
+
+namespace renderer {
+	// Draws frame scenes into RGB pixel buffers on the CPU, where there is no OpenGL context (the pixel buffer viewer, servers without a GPU).
+	// Follows the OpenGL path: starfield, bodies shaded like the default shader (ray-traced spheres instead of meshes, without the shadows),
+	// bloom of the emissive bodies, then the tone mapping of the post-processing shader.
+	// The screen is split into tiles rendered in parallel, each one keeping its own depth buffer
+	class SoftwareRenderer
+	{
+	private:
+		// Visible body, in camera space
+		struct ProjectedBody {
+			glm::vec3 center;
+			float radius;
+			glm::vec3 color; // Fog included
+			bool emissive;
+			bool point;
+			float coverage; // Points only: part of their pixel they cover
+			int minX, minY, maxX, maxY; // Pixels it may cover (inclusive)
+		};
+
+		WorkerPool workers;
+
+		int width, height;
+		int tileColumns, tileRows;
+		std::vector<float> colors; // HDR RGB of every pixel
+		std::vector<float> emissions; // RGB, for the bloom (then scratch memory of resolve)
+		std::vector<ProjectedBody> projectedBodies;
+		std::vector<std::vector<uint32_t>> tileBodies; // Projected bodies that touch every tile, in the scene order
+
+		std::vector<std::vector<float>> bloomLevels; // RGB, half the screen resolution and smaller (like bloom.cpp)
+		std::vector<std::vector<float>> bloomTemporaries;
+		std::vector<int> bloomWidths, bloomHeights;
+
+		std::vector<std::vector<unsigned char>> starfieldFaces;
+		uint8_t toneMap[SOFTWARE_TONE_MAP_SIZE];
+
+		// Per frame
+		glm::vec3 lightPosition; // Camera space
+		glm::vec3 lightColor;
+		float rayScaleX, rayScaleY; // Direction of the ray through a pixel: (ndcX * rayScaleX, ndcY * rayScaleY, -1)
+		glm::mat3 cameraToWorld; // Rotation only, for the starfield
+
+		void resize(int width, int height);
+		void projectBodies(const FrameScene& scene);
+		void renderTile(int tileX, int tileY);
+		void renderSpheres(const ProjectedBody& body, int x0, int y0, int x1, int y1, float* depths, int tileX0, int tileY0);
+		void renderBloom();
+		void blurLevel(int level);
+		void resolve(uint8_t* pixels, size_t rowBytes);
+
+	public:
+		SoftwareRenderer(unsigned int threadCount = 0); // See WorkerPool for threadCount
+
+		// Fills width * height RGB pixels (rows from top to bottom, rowBytes apart)
+		void render(const FrameScene& scene, uint8_t* pixels, int width, int height, size_t rowBytes);
+	};
+}
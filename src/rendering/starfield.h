@@ -0,0 +1,13 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include "starfield_bake.h"
+
+namespace renderer {
+	namespace starfield {
+		// Bakes a random starfield into a cubemap texture once, so that the background only costs a single texture lookup per pixel.
+		// Returns the ID of the cubemap (owned by the caller)
+		GLuint generate(unsigned int seed, int starCount, int faceSize);
+	}
+}
@@ -0,0 +1,83 @@
+#include "starfield_bake.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace renderer {
+	namespace starfield {
+		int directionToFace(glm::vec3 d, float& s, float& t) {
+			glm::vec3 a = glm::abs(d);
+			int face;
+			float sc, tc, ma;
+
+			if (a.x >= a.y && a.x >= a.z) {
+				face = d.x > 0 ? 0 : 1;
+				ma = a.x;
+				sc = d.x > 0 ? -d.z : d.z;
+				tc = -d.y;
+			}
+			else if (a.y >= a.z) {
+				face = d.y > 0 ? 2 : 3;
+				ma = a.y;
+				sc = d.x;
+				tc = d.y > 0 ? d.z : -d.z;
+			}
+			else {
+				face = d.z > 0 ? 4 : 5;
+				ma = a.z;
+				sc = d.z > 0 ? d.x : -d.x;
+				tc = -d.y;
+			}
+
+			s = (sc / ma + 1.0f) * 0.5f;
+			t = (tc / ma + 1.0f) * 0.5f;
+			return face;
+		}
+
+		void bake(unsigned int seed, int starCount, int faceSize, std::vector<std::vector<unsigned char>>& faces) {
+			std::vector<std::vector<float>> brightnesses(6, std::vector<float>((size_t)faceSize * faceSize, 0.0f));
+
+			std::mt19937 random(seed);
+			std::normal_distribution<float> normal(0.0f, 1.0f);
+			std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+
+			for (int i = 0; i < starCount; i++) {
+				// Normalizing a vector of normally distributed components gives a direction uniformly distributed on the sphere
+				glm::vec3 direction(normal(random), normal(random), normal(random));
+				if (glm::length(direction) < 0.0001f) continue;
+				direction = glm::normalize(direction);
+
+				// Most stars are faint, only a few of them are bright
+				float brightness = 0.2f + 0.8f * std::pow(uniform(random), 3.0f);
+				float radius = 0.5f + 1.0f * uniform(random) * brightness; // In pixels
+
+				float s, t;
+				int face = directionToFace(direction, s, t);
+				float centerX = s * faceSize - 0.5f;
+				float centerY = t * faceSize - 0.5f;
+
+				// Splat a small gaussian around the star's center (stars crossing a face's edge are just cut)
+				int extent = (int)std::ceil(radius * 2.0f);
+				int minX = std::max(0, (int)centerX - extent), maxX = std::min(faceSize - 1, (int)centerX + extent + 1);
+				int minY = std::max(0, (int)centerY - extent), maxY = std::min(faceSize - 1, (int)centerY + extent + 1);
+				for (int y = minY; y <= maxY; y++) {
+					for (int x = minX; x <= maxX; x++) {
+						float dx = x - centerX, dy = y - centerY;
+						float value = brightness * std::exp(-(dx * dx + dy * dy) / (2.0f * radius * radius));
+
+						float& pixel = brightnesses[face][(size_t)y * faceSize + x];
+						pixel = std::min(1.0f, pixel + value);
+					}
+				}
+			}
+
+			faces.assign(6, std::vector<unsigned char>((size_t)faceSize * faceSize));
+			for (int face = 0; face < 6; face++) {
+				for (size_t i = 0; i < faces[face].size(); i++) {
+					faces[face][i] = (unsigned char)(brightnesses[face][i] * 255.0f + 0.5f);
+				}
+			}
+		}
+	}
+}
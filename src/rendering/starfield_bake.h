@@ -0,0 +1,18 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <vector>
+
+#define STARFIELD_SEED 1337 // Seed of the random generator, the same seed always gives the same sky
+#define STARFIELD_STAR_COUNT 4000 // Number of stars on the whole sky
+#define STARFIELD_FACE_SIZE 1024 // Resolution of each face of the cubemap (in pixels)
+
+// The CPU part of the starfield, without any OpenGL dependency so that the software renderer can use it on machines without a GPU
+namespace renderer {
+	namespace starfield {
+		// The brightness of every pixel of the 6 faces (in the OpenGL cubemap order), for the renderers that don't use textures
+		void bake(unsigned int seed, int starCount, int faceSize, std::vector<std::vector<unsigned char>>& faces);
+		// Finds the cubemap face a direction points to and the (s, t) coordinates in [0;1] on that face (following the OpenGL cubemap conventions)
+		int directionToFace(glm::vec3 d, float& s, float& t);
+	}
+}
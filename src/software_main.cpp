@@ -0,0 +1,38 @@
+#include "headless.h"
+#include "offscreen.h"
+
+#include <iostream>
+#include <cstring>
+
+// Entry point of the software build ("make software"): same command line as the simulator's --software --render mode, without any
+// OpenGL dependency, so that videos can be rendered on machines without a GPU
+int main(int argc, char** argv) {
+	headless::Options runOptions;
+	offscreen::Options options;
+	options.capture.software = true;
+
+	bool valid = true;
+	for (int i = 1; i < argc && valid; i++) {
+		if (headless::parseArgument(argc, argv, i, runOptions)) continue;
+		if (offscreen::parseArgument(argc, argv, i, options, valid)) continue;
+		if (strcmp(argv[i], "--software") == 0) continue; // Implied
+
+		std::cout << "[ERROR] Unknown or incomplete option '" << argv[i] << "'." << std::endl;
+		valid = false;
+	}
+	if (valid && !options.enabled) {
+		std::cout << "[ERROR] The software build only renders offscreen, --render or --render-raw is needed." << std::endl;
+		valid = false;
+	}
+
+	if (!valid) {
+		std::cout << "Usage: " << argv[0] << " [options]" << std::endl;
+		headless::printUsage();
+		offscreen::printUsage();
+		return 1;
+	}
+
+	if (options.capture.output != renderer::capture::Output::PNG && !renderer::capture::takeStdout()) return 1; // stdout carries the frames, messages go to stderr
+
+	return offscreen::runSoftware(runOptions, options);
+}
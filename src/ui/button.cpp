@@ -1,5 +1,6 @@
 #include "button.h"
 #include "font_renderer.h"
+#include "ui_draw_list.h"
 #include "ui_palette.h"
 #include "../rendering/renderer.h"
 #include <GL/glew.h>
@@ -20,7 +21,9 @@ namespace ui {
 	}
 
 	void ButtonComponent::SetLabel(std::string label) {
+		if (this->label == label) return; // Called every frame for labels that follow the simulation (see ui::updateLabels)
 		this->label = label;
+		drawList::markDirty();
 	}
 
 	void ButtonComponent::draw(Rectangle rect) {
@@ -29,17 +32,7 @@ namespace ui {
 		// Create margin and account for aspect ratio
 		rect = Rectangle(0.15f / aspectRatio, 0.15f, 1.0f - 0.15f / aspectRatio, 0.85f, rect);
 
-		glBegin(GL_TRIANGLES);
-		if (hovered) glVertexAttrib3f(1, btnHoveredColor.red, btnHoveredColor.green, btnHoveredColor.blue);
-		else glVertexAttrib3f(1, btnBackgroundColor.red, btnBackgroundColor.green, btnBackgroundColor.blue);
-		glVertex2f(rect.xMin, rect.yMax);
-		glVertex2f(rect.xMin, rect.yMin);
-		glVertex2f(rect.xMax, rect.yMin);
-
-		glVertex2f(rect.xMax, rect.yMax);
-		glVertex2f(rect.xMin, rect.yMax);
-		glVertex2f(rect.xMax, rect.yMin);
-		glEnd();
+		drawList::addRect(rect.xMin, rect.yMin, rect.xMax, rect.yMax, hovered ? btnHoveredColor : btnBackgroundColor);
 
 		fontRendering::drawText(label, (rect.xMin + rect.xMax) / 2, (rect.yMin + rect.yMax) / 2, rect.GetWidth() * 0.35f, btnLabelColor, true, true);
 	}
@@ -50,9 +43,11 @@ namespace ui {
 
 	void ButtonComponent::onMouseEnter() {
 		hovered = true;
+		drawList::markDirty();
 	}
 
 	void ButtonComponent::onMouseExit() {
 		hovered = false;
+		drawList::markDirty();
 	}
 }
\ No newline at end of file
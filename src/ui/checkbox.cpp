@@ -2,6 +2,7 @@
 #include "ui_palette.h"
 #include "../rendering/renderer.h"
 #include "font_renderer.h"
+#include "ui_draw_list.h"
 
 #include <GL/glew.h>
 
@@ -21,26 +22,8 @@ namespace ui {
 		Rectangle outerRect = Rectangle(0.2f / aspectRatio, 0.2f, 0.8f / aspectRatio, 0.8f, rect);
 		Rectangle innerRect = Rectangle(0.25f / aspectRatio, 0.25f, 0.75f / aspectRatio, 0.75f, rect);
 
-		glBegin(GL_TRIANGLES);
-
-		glVertexAttrib3f(1, borderColor.red, borderColor.green, borderColor.blue);
-		glVertex2f(outerRect.xMin, outerRect.yMax);
-		glVertex2f(outerRect.xMin, outerRect.yMin);
-		glVertex2f(outerRect.xMax, outerRect.yMin);
-		glVertex2f(outerRect.xMax, outerRect.yMax);
-		glVertex2f(outerRect.xMin, outerRect.yMax);
-		glVertex2f(outerRect.xMax, outerRect.yMin);
-
-		if (checked) glVertexAttrib3f(1, checkedColor.red, checkedColor.green, checkedColor.blue);
-		else glVertexAttrib3f(1, uncheckedColor.red, uncheckedColor.green, uncheckedColor.blue);
-		glVertex2f(innerRect.xMin, innerRect.yMax);
-		glVertex2f(innerRect.xMin, innerRect.yMin);
-		glVertex2f(innerRect.xMax, innerRect.yMin);
-		glVertex2f(innerRect.xMax, innerRect.yMax);
-		glVertex2f(innerRect.xMin, innerRect.yMax);
-		glVertex2f(innerRect.xMax, innerRect.yMin);
-
-		glEnd();
+		drawList::addRect(outerRect.xMin, outerRect.yMin, outerRect.xMax, outerRect.yMax, borderColor);
+		drawList::addRect(innerRect.xMin, innerRect.yMin, innerRect.xMax, innerRect.yMax, checked ? checkedColor : uncheckedColor);
 
 		fontRendering::drawText(label, (rect.xMin + rect.xMax) / 2, (rect.yMin + rect.yMax) / 2, rect.GetWidth() * 0.4f, CHECKBOX_LABEL_COLOR, true, true);
 	}
@@ -48,6 +31,7 @@ namespace ui {
 	void CheckBoxComponent::onMouseDown(float mouseX, float mouseY, int button) {
 		if (button == GLFW_MOUSE_BUTTON_LEFT) {
 			checked = !checked;
+			drawList::markDirty();
 
 			if (this->toggleCallback != NULL) this->toggleCallback(checked);
 		}
@@ -55,6 +39,7 @@ namespace ui {
 
 	void CheckBoxComponent::setChecked(bool newChecked) {
 		this->checked = newChecked;
+		drawList::markDirty();
 	}
 
 	bool CheckBoxComponent::isChecked() {
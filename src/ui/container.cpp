@@ -1,5 +1,6 @@
 #include "container.h"
 #include "GL/glew.h"
+#include "ui_draw_list.h"
 
 #include <iostream>
 
@@ -8,73 +9,90 @@ namespace ui {
 		this->label = label;
 		this->totalVerticalCellSize = 0;
 		this->hoveredComponentIndex = -1;
+		this->layoutDirty = true;
 	}
 
 	int Container::GetVerticalCellSize() {
 		return totalVerticalCellSize;
 	}
 
-	void Container::draw(Rectangle rect) {
-		float cellHeight = rect.GetHeight() / totalVerticalCellSize;
+	void Container::SetBounds(Rectangle bounds) {
+		this->bounds = bounds;
 
-		float yOffset = rect.yMin;
+		float cellHeight = bounds.GetHeight() / totalVerticalCellSize;
+
+		// Components are stacked from the bottom, the last one being the lowest
+		componentBounds.resize(components.size());
+		float yOffset = bounds.yMin;
 		for (int i = components.size() - 1; i >= 0; i--) {
-			Component* comp = components.at(i);
-			float componentHeight = cellHeight * comp->GetVerticalCellSize();
-			comp->draw(Rectangle(rect.xMin, yOffset, rect.xMax, yOffset+componentHeight));
+			float componentHeight = cellHeight * components.at(i)->GetVerticalCellSize();
+			componentBounds[i] = Rectangle(bounds.xMin, yOffset, bounds.xMax, yOffset + componentHeight);
 
 			yOffset += componentHeight;
 		}
+
+		layoutDirty = false;
+	}
+
+	Rectangle Container::GetBounds() {
+		return bounds;
+	}
+
+	bool Container::IsLayoutDirty() {
+		return layoutDirty;
+	}
+
+	void Container::draw() {
+		for (int i = componentBounds.size() - 1; i >= 0; i--) { // Components added after the last layout aren't drawn until the next one
+			components.at(i)->draw(componentBounds[i]);
+		}
 	}
 
 	void Container::AddComponent(Component* component) {
 		components.push_back(component);
 		totalVerticalCellSize += component->GetVerticalCellSize();
+		layoutDirty = true;
+		drawList::markDirty();
 	}
 
 	std::vector<Component*>* Container::GetComponents() {
 		return &components;
 	}
 
-	void Container::onMouseDown(Rectangle containerBounds, float mouseX, float mouseY, int button) {
-		float cellHeight = containerBounds.GetHeight() / totalVerticalCellSize;
+	int Container::GetComponentIndexAt(float x, float y) {
+		for (unsigned int i = 0; i < componentBounds.size(); i++) {
+			if (componentBounds[i].Contains(x, y)) return i;
+		}
 
-		float yOffset = containerBounds.yMin;
-		for (int i = components.size() - 1; i >= 0; i--) {
-			Component* comp = components.at(i);
-			float componentHeight = cellHeight * comp->GetVerticalCellSize();
-			Rectangle componentBounds = Rectangle(containerBounds.xMin, yOffset, containerBounds.xMax, yOffset + componentHeight);
-			if (componentBounds.Contains(mouseX, mouseY)) {
-				comp->onMouseDown(mouseX, mouseY, button);
-			}
+		return -1;
+	}
 
-			yOffset += componentHeight;
+	void Container::onMouseDown(float mouseX, float mouseY, int button) {
+		int index = GetComponentIndexAt(mouseX, mouseY);
+		if (index >= 0) {
+			components.at(index)->onMouseDown(mouseX, mouseY, button);
 		}
 	}
 
-	void Container::onMouseMoved(Rectangle containerBounds, float mouseX, float mouseY) {
-		float cellHeight = containerBounds.GetHeight() / totalVerticalCellSize;
+	void Container::onMouseMoved(float mouseX, float mouseY) {
+		int index = GetComponentIndexAt(mouseX, mouseY);
+		if (index == hoveredComponentIndex) return;
 
-		float yOffset = containerBounds.yMin;
-		for (int i = components.size() - 1; i >= 0; i--) {
-			Component* comp = components.at(i);
-			float componentHeight = cellHeight * comp->GetVerticalCellSize();
-			Rectangle componentBounds = Rectangle(containerBounds.xMin, yOffset, containerBounds.xMax, yOffset + componentHeight);
-			bool containsMouse = componentBounds.Contains(mouseX, mouseY);
-			if (containsMouse && hoveredComponentIndex != i) {
-				if (hoveredComponentIndex >= 0) {
-					components.at(hoveredComponentIndex)->onMouseExit();
-				}
-
-				comp->onMouseEnter();
-				hoveredComponentIndex = i;
-			}
-			else if (!containsMouse && hoveredComponentIndex == i) {
-				comp->onMouseExit();
-				hoveredComponentIndex = -i;
-			}
+		if (hoveredComponentIndex >= 0) {
+			components.at(hoveredComponentIndex)->onMouseExit();
+		}
 
-			yOffset += componentHeight;
+		if (index >= 0) {
+			components.at(index)->onMouseEnter();
+		}
+
+		hoveredComponentIndex = index;
+	}
+
+	void Container::onMouseExit() {
+		if (hoveredComponentIndex >= 0) {
+			components.at(hoveredComponentIndex)->onMouseExit();
+			hoveredComponentIndex = -1;
 		}
 	}
-}
\ No newline at end of file
+}
@@ -17,13 +17,23 @@ namespace ui {
 		void AddComponent(Component* component);
 		std::vector<Component*>* GetComponents();
 
-		void onMouseDown(Rectangle containerBounds, float mouseX, float mouseY, int button);
-		void onMouseMoved(Rectangle containerBounds, float mouseX, float mouseY);
-		void draw(Rectangle rect);
+		// Lays out the components inside the given bounds. The result is kept until the next call, so this is only called when the layout changes
+		void SetBounds(Rectangle bounds);
+		Rectangle GetBounds();
+		bool IsLayoutDirty(); // A component was added since the last SetBounds, the panel has to lay its containers out again
+
+		void onMouseDown(float mouseX, float mouseY, int button);
+		void onMouseMoved(float mouseX, float mouseY);
+		void onMouseExit(); // The mouse left the container, so no component is hovered anymore
+		void draw();
 	private:
 		std::vector<Component*> components;
+		std::vector<Rectangle> componentBounds; // Cached layout, same order as components
+		bool layoutDirty;
+		Rectangle bounds;
 		int totalVerticalCellSize;
 		int hoveredComponentIndex;
+
+		int GetComponentIndexAt(float x, float y);
 	};
 }
-
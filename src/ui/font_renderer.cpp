@@ -1,5 +1,13 @@
 #include "font_renderer.h"
 
+#include "ui_draw_list.h"
+
+#include <cstdint>
+#include <cstring>
+#include <sstream>
+#include <cmath>
+#include <unordered_map>
+
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
 
@@ -7,141 +15,293 @@ namespace ui {
 	namespace fontRendering {
 		GLuint FontTextureID;
 		short int* FontData;
+		Glyph Glyphs[FONT_CHAR_COUNT];
 
 		int AtlasWidth, AtlasHeight;
+		float WhiteTexelU, WhiteTexelV;
+		bool DistanceFieldAtlas;
+
+		// Finds a fully transparent 4x4 block in the atlas (searching from the bottom right where glyphs are the least likely to be) and makes it white,
+		// so that solid UI rectangles can sample the same texture as the text. The last channel is the coverage (alpha or distance).
+		void addWhiteTexel(unsigned char* data, int channels) {
+			const int blockSize = 4;
+			int blockX = AtlasWidth - blockSize, blockY = AtlasHeight - blockSize;
+			bool found = false;
+
+			for (int y = AtlasHeight - blockSize; y >= 0 && !found; y -= blockSize) {
+				for (int x = AtlasWidth - blockSize; x >= 0 && !found; x -= blockSize) {
+					bool empty = true;
+					for (int i = 0; i < blockSize * blockSize && empty; i++) {
+						empty = data[((y + i / blockSize) * AtlasWidth + x + i % blockSize) * channels + channels - 1] == 0;
+					}
+
+					if (empty) {
+						blockX = x;
+						blockY = y;
+						found = true;
+					}
+				}
+			}
+
+			if (!found) std::cout << "[WARNING] No free space for the white texel in the font atlas, a glyph may be overwritten." << std::endl;
+
+			for (int i = 0; i < blockSize * blockSize; i++) {
+				unsigned char* pixel = &data[((blockY + i / blockSize) * AtlasWidth + blockX + i % blockSize) * channels];
+				for (int channel = 0; channel < channels; channel++) pixel[channel] = 255;
+			}
+
+			// Sample the center of the block so that linear filtering never reaches its neighbours
+			WhiteTexelU = (blockX + blockSize * 0.5f) / AtlasWidth;
+			WhiteTexelV = (blockY + blockSize * 0.5f) / AtlasHeight;
+		}
 
 		void init() {
-			// Load the font atlas as texture
+			// Load the font atlas as texture, preferring the distance field atlas (generated by tools/sdf_font_atlas) as it stays sharp at any scale
 			std::cout << "Loading font atlas..." << std::endl;
 			int nrChannels;
-			unsigned char* data = stbi_load("fonts/Comfortaa.png", &AtlasWidth, &AtlasHeight, &nrChannels, 0);
+			unsigned char* data = stbi_load(FONT_SDF_ATLAS_PATH, &AtlasWidth, &AtlasHeight, &nrChannels, 1);
+			DistanceFieldAtlas = data != NULL;
+			if (!DistanceFieldAtlas) {
+				std::cout << "[WARNING] Could not load the distance field font atlas, falling back to " << FONT_ATLAS_PATH << "." << std::endl;
+				data = stbi_load(FONT_ATLAS_PATH, &AtlasWidth, &AtlasHeight, &nrChannels, 4);
+			}
+			if (data == NULL) {
+				std::cout << "[ERROR] Could not load the font atlas." << std::endl;
+				return;
+			}
+
+			int channels = DistanceFieldAtlas ? 1 : 4;
+			addWhiteTexel(data, channels);
 
 			glGenTextures(1, &FontTextureID);
 			glBindTexture(GL_TEXTURE_2D, FontTextureID);
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, AtlasWidth, AtlasHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+			if (DistanceFieldAtlas) {
+				// Single channel holding the distance, read as the alpha of a white texture so the shader doesn't care which atlas is used.
+				// It takes a quarter of the GPU memory of the RGBA bitmap atlas (on disk, the smooth distance field compresses worse than the bitmap)
+				const GLint swizzle[] = { GL_ONE, GL_ONE, GL_ONE, GL_RED };
+				glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+				glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, AtlasWidth, AtlasHeight, 0, GL_RED, GL_UNSIGNED_BYTE, data);
+				glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+				glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+			}
+			else {
+				glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, AtlasWidth, AtlasHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+			}
 			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
 			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 
 			stbi_image_free(data);
 			std::cout << "Font atlas loaded." << std::endl;
 
-			// Load font data
+			// Load font metrics (from the precompiled binary file if there is one, which only takes a single read)
 			std::cout << "Loading font data..." << std::endl;
-			std::ifstream file("fonts\\Comfortaa.fnt");
-			FontData = new short int[128*7];
+			FontData = new short int[FONT_CHAR_COUNT * 7]();
+
+			if (!loadBinaryMetrics(FONT_BINARY_METRICS_PATH)) {
+				std::cout << "No precompiled font metrics, parsing " << FONT_METRICS_PATH << " instead." << std::endl;
+				parseTextMetrics(FONT_METRICS_PATH);
+				saveBinaryMetrics(FONT_BINARY_METRICS_PATH);
+			}
+
+			computeGlyphs();
+		}
+
+		// Binary metrics layout: magic, version and character count (3 x 32-bit), followed by FontData as is (16-bit values).
+		// Everything is in native byte order: the file is only a cache, one written by a machine with another byte order fails the magic check and is rebuilt
+		const uint32_t BINARY_METRICS_MAGIC = 0x42544E46; // "FNTB"
+		const uint32_t BINARY_METRICS_VERSION = 1;
+
+		bool loadBinaryMetrics(const char* path) {
+			std::ifstream file(path, std::ios::binary | std::ios::ate);
+			if (!file.is_open()) return false;
+
+			const size_t expectedSize = 3 * sizeof(uint32_t) + FONT_CHAR_COUNT * 7 * sizeof(short int);
+			if ((size_t)file.tellg() != expectedSize) {
+				std::cout << "[WARNING] " << path << " has an unexpected size, ignoring it." << std::endl;
+				return false;
+			}
+
+			std::vector<char> buffer(expectedSize);
+			file.seekg(0);
+			file.read(buffer.data(), expectedSize);
+			if (!file) return false;
+
+			uint32_t header[3];
+			memcpy(header, buffer.data(), sizeof(header));
+			if (header[0] != BINARY_METRICS_MAGIC || header[1] != BINARY_METRICS_VERSION || header[2] != FONT_CHAR_COUNT) {
+				std::cout << "[WARNING] " << path << " isn't a supported font metrics file, ignoring it." << std::endl;
+				return false;
+			}
+
+			memcpy(FontData, buffer.data() + sizeof(header), FONT_CHAR_COUNT * 7 * sizeof(short int));
+			return true;
+		}
+
+		void saveBinaryMetrics(const char* path) {
+			std::ofstream file(path, std::ios::binary);
+			if (!file.is_open()) {
+				std::cout << "[ERROR] Could not write " << path << "." << std::endl;
+				return;
+			}
+
+			uint32_t header[3] = { BINARY_METRICS_MAGIC, BINARY_METRICS_VERSION, FONT_CHAR_COUNT };
+			file.write((const char*)header, sizeof(header));
+			file.write((const char*)FontData, FONT_CHAR_COUNT * 7 * sizeof(short int));
+		}
+
+		void parseTextMetrics(const char* path) {
+			std::ifstream file(path);
+			if (!file.is_open()) {
+				std::cout << "[ERROR] Could not open " << path << "." << std::endl;
+				return;
+			}
 
 			std::string line;
 			while (std::getline(file, line)) {
-				if (line.rfind("chars count=") == 0) {
-					int charCount = std::stoi(line.substr(12, 3));
+				if (line.rfind("chars count=", 0) == 0) {
+					int charCount = std::stoi(line.substr(12));
 					std::cout << "Font contains " << charCount << " characters." << std::endl;
 				}
-				else if (line.rfind("char id=") == 0) {
-					int charId = std::stoi(line.substr(8, 3));
-					
-					int x = std::stoi(line.substr(line.rfind("x=") + 2, 3));
-					int y = std::stoi(line.substr(line.rfind("y=") + 2, 3));
-					int width = std::stoi(line.substr(line.rfind("width=") + 6, 3));
-					int height = std::stoi(line.substr(line.rfind("height=") + 7, 3));
-					int xoffset = std::stoi(line.substr(line.rfind("xoffset=") + 8, 3));
-					int yoffset = std::stoi(line.substr(line.rfind("yoffset=") + 8, 3));
-					int xadvance = std::stoi(line.substr(line.rfind("xadvance=") + 9, 3));
-
-					FontData[charId * 7 + 0] = x;
-					FontData[charId * 7 + 1] = y;
-					FontData[charId * 7 + 2] = width;
-					FontData[charId * 7 + 3] = height;
-					FontData[charId * 7 + 4] = xoffset;
-					FontData[charId * 7 + 5] = yoffset;
-					FontData[charId * 7 + 6] = xadvance;
+				else if (line.rfind("char id=", 0) == 0) {
+					// Every field of the line is a key=value pair
+					int values[8] = { 0 }; // id, x, y, width, height, xoffset, yoffset, xadvance
+					const char* keys[8] = { "id", "x", "y", "width", "height", "xoffset", "yoffset", "xadvance" };
+
+					std::istringstream fields(line.substr(5));
+					std::string field;
+					while (fields >> field) {
+						size_t separator = field.find('=');
+						if (separator == std::string::npos) continue;
+
+						std::string key = field.substr(0, separator);
+						for (int i = 0; i < 8; i++) {
+							if (key == keys[i]) values[i] = std::atoi(field.c_str() + separator + 1);
+						}
+					}
+
+					int charId = values[0];
+					if (charId < 0 || charId >= FONT_CHAR_COUNT) continue;
+
+					for (int i = 0; i < 7; i++) {
+						FontData[charId * 7 + i] = values[i + 1];
+					}
 				}
 			}
 		}
 
-		void drawText(std::string text, float x, float y, float scale, Color color, bool centerHorizontally, bool centerVertically) {
-			int strLength = text.length();
-			float aspectRatio = (float)renderer::windowWidth / renderer::windowHeight;
-			int cursorX = 0;
-
-			if (centerHorizontally || centerVertically) {
-				// Calculate the dimensions of the text
-				float width = 0;
-				float highest = -1;
-				float lowest = 1;
-
-				for (int c = 0; c < strLength; c++) {
-					char chr = text.at(c);
-
-					// Extract character data from font
-					int chrX = FontData[chr * 7 + 0];
-					int chrY = FontData[chr * 7 + 1];
-					int chrWidth = FontData[chr * 7 + 2];
-					int chrHeight = FontData[chr * 7 + 3];
-					int chrXOffset = FontData[chr * 7 + 4];
-					int chrYOffset = FontData[chr * 7 + 5];
-					int chrXAdvance = FontData[chr * 7 + 6];
-					
-					width += (float)chrXAdvance / AtlasWidth * scale;
-
-					float vertexOffsetY = (float)chrYOffset / -AtlasHeight * aspectRatio;
-					float relativeHeight = (float)chrHeight / AtlasHeight;
-
-					highest = std::fmaxf(highest, vertexOffsetY * scale);
-					lowest = std::fminf(lowest, (float)(vertexOffsetY - relativeHeight * aspectRatio) * scale);
-				}
+		void computeGlyphs() {
+			for (int chr = 0; chr < FONT_CHAR_COUNT; chr++) {
+				Glyph& glyph = Glyphs[chr];
+				glyph.u = (float)FontData[chr * 7 + 0] / AtlasWidth;
+				glyph.v = (float)FontData[chr * 7 + 1] / AtlasHeight;
+				glyph.width = (float)FontData[chr * 7 + 2] / AtlasWidth;
+				glyph.height = (float)FontData[chr * 7 + 3] / AtlasHeight;
+				glyph.xOffset = (float)FontData[chr * 7 + 4] / AtlasWidth;
+				glyph.yOffset = (float)FontData[chr * 7 + 5] / -AtlasHeight;
+				glyph.xAdvance = (float)FontData[chr * 7 + 6] / AtlasWidth;
+			}
+		}
 
-				if (centerHorizontally) x -= width / 2;
-				if (centerVertically) y -= (highest + lowest) / 2;
+		// Glyph quads of a string laid out at (0, 0), reused as long as the string is drawn with the same parameters
+		struct TextLayoutKey {
+			std::string text;
+			float scale;
+			float aspectRatio;
+			bool centerHorizontally;
+			bool centerVertically;
 
+			bool operator==(const TextLayoutKey& other) const {
+				return text == other.text && scale == other.scale && aspectRatio == other.aspectRatio
+					&& centerHorizontally == other.centerHorizontally && centerVertically == other.centerVertically;
 			}
+		};
 
-			glBindTexture(GL_TEXTURE_2D, FontTextureID);
-			glUniform1i(renderer::uiShader.UseTextureUniformID, 1);
-			glBegin(GL_QUADS); // WARNING GL_QUADS IS DEPREACTED AND SHOULD NOT BE USED. TODO: Use GL_TRIANGLES instead
-			glVertexAttrib3d(1, color.red, color.green, color.blue);
+		struct TextLayoutKeyHash {
+			size_t operator()(const TextLayoutKey& key) const {
+				size_t hash = std::hash<std::string>()(key.text);
+				hash ^= std::hash<float>()(key.scale) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+				hash ^= std::hash<float>()(key.aspectRatio) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+				return hash ^ (key.centerHorizontally ? 1 : 0) ^ (key.centerVertically ? 2 : 0);
+			}
+		};
+
+		struct GlyphQuad {
+			float xMin, yMin, xMax, yMax;
+			float uMin, vMin, uMax, vMax;
+		};
+
+		std::unordered_map<TextLayoutKey, std::vector<GlyphQuad>, TextLayoutKeyHash> layoutCache;
+
+		const std::vector<GlyphQuad>& layoutText(const TextLayoutKey& key) {
+			auto cached = layoutCache.find(key);
+			if (cached != layoutCache.end()) return cached->second;
 
-			for (int c = 0; c < strLength; c++) {
-				char chr = text.at(c);
+			if (layoutCache.size() >= TEXT_LAYOUT_CACHE_SIZE) layoutCache.clear(); // Text that changes often (e.g. while typing) shouldn't grow the cache forever
 
-				// Extract character data from font
-				int chrX = FontData[chr * 7 + 0];
-				int chrY = FontData[chr * 7 + 1];
-				int chrWidth = FontData[chr * 7 + 2];
-				int chrHeight = FontData[chr * 7 + 3];
-				int chrXOffset = FontData[chr * 7 + 4];
-				int chrYOffset = FontData[chr * 7 + 5];
-				int chrXAdvance = FontData[chr * 7 + 6];
+			const std::string& text = key.text;
+			float scale = key.scale;
+			float aspectRatio = key.aspectRatio;
 
-				float relativeX = (float)chrX / AtlasWidth;
-				float relativeY = (float)chrY / AtlasHeight;
-				float relativeWidth = (float)chrWidth / AtlasWidth;
-				float relativeHeight = (float)chrHeight / AtlasHeight;
+			std::vector<GlyphQuad>& quads = layoutCache[key];
+			quads.reserve(text.length());
 
-				float vertexOffsetX = (float)(cursorX + chrXOffset) / AtlasWidth;
-				float vertexOffsetY = (float)chrYOffset / -AtlasHeight * aspectRatio;
+			float cursorX = 0;
+			float width = 0;
+			float highest = -1;
+			float lowest = 1;
 
-				glVertexAttrib2f(2, relativeX, relativeY);
-				glVertex2f(vertexOffsetX * scale + x, vertexOffsetY * scale + y);
+			for (unsigned int c = 0; c < text.length(); c++) {
+				unsigned char chr = text.at(c);
+				if (chr >= FONT_CHAR_COUNT) continue;
+				const Glyph& glyph = Glyphs[chr];
 
-				glVertexAttrib2f(2, relativeX, relativeY + relativeHeight);
-				glVertex2f(vertexOffsetX * scale + x, (vertexOffsetY-relativeHeight * aspectRatio) * scale + y);
+				float vertexOffsetX = cursorX + glyph.xOffset;
+				float vertexOffsetY = glyph.yOffset * aspectRatio;
 
-				glVertexAttrib2f(2, relativeX + relativeWidth, relativeY + relativeHeight);
-				glVertex2f((vertexOffsetX+relativeWidth) * scale + x, (vertexOffsetY - relativeHeight * aspectRatio) * scale + y);
+				GlyphQuad quad;
+				quad.xMin = vertexOffsetX * scale;
+				quad.yMin = (vertexOffsetY - glyph.height * aspectRatio) * scale;
+				quad.xMax = (vertexOffsetX + glyph.width) * scale;
+				quad.yMax = vertexOffsetY * scale;
+				quad.uMin = glyph.u;
+				quad.vMin = glyph.v;
+				quad.uMax = glyph.u + glyph.width;
+				quad.vMax = glyph.v + glyph.height;
+				quads.push_back(quad);
 
-				glVertexAttrib2f(2, relativeX + relativeWidth, relativeY);
-				glVertex2f((vertexOffsetX+relativeWidth) * scale + x, vertexOffsetY * scale + y);
+				width += glyph.xAdvance * scale;
+				highest = std::fmax(highest, quad.yMax);
+				lowest = std::fmin(lowest, quad.yMin);
 
-				cursorX += chrXAdvance;
+				cursorX += glyph.xAdvance;
 			}
 
-			glEnd();
-			glUniform1i(renderer::uiShader.UseTextureUniformID, 0);
+			float offsetX = key.centerHorizontally ? -width / 2 : 0.0f;
+			float offsetY = key.centerVertically ? -(highest + lowest) / 2 : 0.0f;
+			for (GlyphQuad& quad : quads) {
+				quad.xMin += offsetX;
+				quad.xMax += offsetX;
+				quad.yMin += offsetY;
+				quad.yMax += offsetY;
+			}
+
+			return quads;
+		}
+
+		void drawText(std::string text, float x, float y, float scale, Color color, bool centerHorizontally, bool centerVertically) {
+			TextLayoutKey key = { text, scale, (float)renderer::windowWidth / renderer::windowHeight, centerHorizontally, centerVertically };
+
+			for (const GlyphQuad& quad : layoutText(key)) {
+				drawList::batch.addTexturedRect(quad.xMin + x, quad.yMin + y, quad.xMax + x, quad.yMax + y, quad.uMin, quad.vMin, quad.uMax, quad.vMax, color);
+			}
 		}
 
 		void dispose() {
 			glDeleteTextures(1, &FontTextureID);
 			delete[] FontData;
+			layoutCache.clear();
 		}
 	}
-}
+}
\ No newline at end of file
@@ -4,18 +4,40 @@
 #include <string>
 #include <iostream>
 #include <fstream>
+#include <vector>
 
 #include "../rendering/renderer.h"
 
+#define FONT_CHAR_COUNT 128 // Only ASCII characters are supported
+#define FONT_ATLAS_PATH "fonts/Comfortaa.png"
+#define FONT_SDF_ATLAS_PATH "fonts/Comfortaa_sdf.png" // Distance field version of FONT_ATLAS_PATH (same layout), see tools/sdf_font_atlas.cpp
+#define FONT_METRICS_PATH "fonts/Comfortaa.fnt"
+#define FONT_BINARY_METRICS_PATH "fonts/Comfortaa.fntb" // Precompiled version of the .fnt file (written after parsing the .fnt file if missing)
+#define TEXT_LAYOUT_CACHE_SIZE 512 // Maximum number of laid out strings kept in the cache
+
 namespace ui {
 	namespace fontRendering {
+		// Metrics of a character, relative to the atlas size
+		struct Glyph {
+			float u, v, width, height;
+			float xOffset, yOffset, xAdvance;
+		};
+
 		extern GLuint FontTextureID;
 		extern int AtlasWidth, AtlasHeight;
+		extern float WhiteTexelU, WhiteTexelV; // Texture coordinates of a white area of the atlas (used to draw solid rectangles)
+		extern bool DistanceFieldAtlas; // Whether the atlas alpha is a signed distance (0.5 at the glyph edges) instead of a coverage
 
 		extern short int* FontData; // Array containing the font data of every character from the .fnt file
+		extern Glyph Glyphs[FONT_CHAR_COUNT]; // FontData converted once to atlas-relative units
 
 		void init();
 		void dispose();
 		void drawText(std::string text, float x, float y, float scale, Color color, bool centerHorizontally= false, bool centerVertically=false);
+
+		bool loadBinaryMetrics(const char* path);
+		void saveBinaryMetrics(const char* path);
+		void parseTextMetrics(const char* path);
+		void computeGlyphs();
 	}
-}
\ No newline at end of file
+}
@@ -2,6 +2,7 @@
 #include "GL/glew.h"
 #include "ui_palette.h"
 #include "font_renderer.h"
+#include "ui_draw_list.h"
 
 #define CONTAINER_SPACING 0.01
 
@@ -13,82 +14,87 @@ namespace ui {
 		this->label = label;
 		this->bounds = bounds;
 		this->totalVerticalCellSize = 0;
+		this->layoutDirty = true;
+		this->cellHeight = 0;
+		this->hoveredContainerIndex = -1;
 	}
 
 	void Panel::AddContainer(Container container) {
 		containers.push_back(container);
-		totalVerticalCellSize += container.GetVerticalCellSize();
+		layoutDirty = true;
+		drawList::markDirty();
 	}
 
-	Container* Panel::GetContainerAt(float x, float y, Rectangle* out_containerBounds) {
-		float cellHeight = bounds.GetHeight() / (totalVerticalCellSize + 1); // We add 1 to make up for the panel head
-		float yOffset = bounds.yMax - cellHeight;
+	void Panel::updateLayout() {
+		// Adding a component to a container changes its height, and so the place of every container
+		for (unsigned int i = 0; i < containers.size(); i++) {
+			if (containers.at(i).IsLayoutDirty()) layoutDirty = true;
+		}
+		if (!layoutDirty) return;
+
+		totalVerticalCellSize = 0;
+		for (unsigned int i = 0; i < containers.size(); i++) {
+			totalVerticalCellSize += containers.at(i).GetVerticalCellSize();
+		}
+		cellHeight = bounds.GetHeight() / (totalVerticalCellSize + 1); // We add 1 to make up for the panel head
 
+		float yOffset = bounds.yMax - cellHeight;
 		for (unsigned int i = 0; i < containers.size(); i++) {
 			Container* container = &containers.at(i);
-			Rectangle containerBounds = Rectangle(bounds.xMin, yOffset - container->GetVerticalCellSize() * cellHeight, bounds.xMax, yOffset);
-			if (containerBounds.Contains(x, y)) {
-				*out_containerBounds = containerBounds;
-				return container;
-			}
+			container->SetBounds(Rectangle(bounds.xMin, yOffset - container->GetVerticalCellSize() * cellHeight, bounds.xMax, yOffset));
+			yOffset -= container->GetVerticalCellSize() * cellHeight;
+		}
+
+		layoutDirty = false;
+	}
+
+	Container* Panel::GetContainerAt(float x, float y) {
+		updateLayout();
 
-			yOffset -= containerBounds.GetHeight();
+		if (!bounds.Contains(x, y)) return nullptr;
+
+		for (unsigned int i = 0; i < containers.size(); i++) {
+			if (containers.at(i).GetBounds().Contains(x, y)) return &containers.at(i);
 		}
 
 		return nullptr;
 	}
 
 	void Panel::draw() {
-		float cellHeight = bounds.GetHeight() / (totalVerticalCellSize + 1); // We add 1 to make up for the panel head
+		updateLayout();
 
-		glBegin(GL_TRIANGLES);
 		// Background
-		glVertexAttrib3f(1, backgroundColor.red, backgroundColor.green, backgroundColor.blue);
-		glVertex2f(bounds.xMin, bounds.yMin);
-		glVertex2f(bounds.xMax, bounds.yMin);
-		glVertex2f(bounds.xMax, bounds.yMax);
-		glVertex2f(bounds.xMin, bounds.yMax);
-		glVertex2f(bounds.xMin, bounds.yMin);
-		glVertex2f(bounds.xMax, bounds.yMax);
+		drawList::addRect(bounds.xMin, bounds.yMin, bounds.xMax, bounds.yMax, backgroundColor);
 
 		// Head
-		glVertexAttrib3f(1, headColor.red, headColor.green, headColor.blue);
-		glVertex2f(bounds.xMin, bounds.yMax);
-		glVertex2f(bounds.xMin, bounds.yMax - cellHeight);
-		glVertex2f(bounds.xMax, bounds.yMax - cellHeight);
-		glVertex2f(bounds.xMax, bounds.yMax);
-		glVertex2f(bounds.xMin, bounds.yMax);
-		glVertex2f(bounds.xMax, bounds.yMax - cellHeight);
-		glEnd();
+		drawList::addRect(bounds.xMin, bounds.yMax - cellHeight, bounds.xMax, bounds.yMax, headColor);
 
 		fontRendering::drawText(label, (bounds.xMin + bounds.xMax) / 2, (2 * bounds.yMax - cellHeight) / 2, bounds.GetWidth() * 0.5F, PANEL_TITLE_COLOR, true, true);
 
-		float yOffset = bounds.yMax - cellHeight;
 		for (unsigned int i = 0; i < containers.size(); i++) {
-			Container* container = &containers.at(i);
-			container->draw(Rectangle(bounds.xMin, yOffset - container->GetVerticalCellSize() * cellHeight, bounds.xMax, yOffset));
-			yOffset -= container->GetVerticalCellSize() * cellHeight;
+			containers.at(i).draw();
 		}
 	}
 
 	void Panel::onMouseDown(float mouseX, float mouseY, int button) {
-		Rectangle containerBounds;
-		Container* container = GetContainerAt(mouseX, mouseY, &containerBounds);
+		Container* container = GetContainerAt(mouseX, mouseY);
 		if (container != nullptr) {
-			container->onMouseDown(containerBounds, mouseX, mouseY, button);
+			container->onMouseDown(mouseX, mouseY, button);
 		}
 	}
 
 	void Panel::onMouseMoved(float mouseX, float mouseY) {
-		float cellHeight = bounds.GetHeight() / (totalVerticalCellSize + 1); // We add 1 to make up for the panel head
-		float yOffset = bounds.yMax - cellHeight;
+		Container* container = GetContainerAt(mouseX, mouseY);
+		int index = container != nullptr ? (int)(container - &containers.at(0)) : -1;
 
-		for (unsigned int i = 0; i < containers.size(); i++) {
-			Container* container = &containers.at(i);
-			Rectangle containerBounds = Rectangle(bounds.xMin, yOffset - container->GetVerticalCellSize() * cellHeight, bounds.xMax, yOffset);
-			container->onMouseMoved(containerBounds, mouseX, mouseY);
-			
-			yOffset -= containerBounds.GetHeight();
+		// Only the container under the mouse and the one it just left need to know about it
+		if (index != hoveredContainerIndex && hoveredContainerIndex >= 0) {
+			containers.at(hoveredContainerIndex).onMouseExit();
+		}
+		hoveredContainerIndex = index;
+
+		if (container != nullptr) {
+			container->onMouseMoved(mouseX, mouseY);
 		}
 	}
 
@@ -105,5 +111,6 @@ namespace ui {
 	}
 	void Panel::SetLabel(std::string newLabel) {
 		this->label = newLabel;
+		drawList::markDirty();
 	}
 }
\ No newline at end of file
@@ -15,13 +15,20 @@ namespace ui {
 		Rectangle bounds;
 		std::vector<Container> containers;
 		int totalVerticalCellSize;
+
+		// Cached layout, recomputed by updateLayout() only after it was invalidated
+		bool layoutDirty;
+		float cellHeight;
+		int hoveredContainerIndex;
+
+		void updateLayout();
 		
 	public:
 		Panel(std::string label, Rectangle bounds);
 
 		Rectangle GetBounds();
 		void AddContainer(Container container);
-		Container* GetContainerAt(float x, float y, Rectangle* out_containerBounds);
+		Container* GetContainerAt(float x, float y);
 		std::vector<Container>* GetContainers();
 
 		std::string GetLabel();
@@ -1,6 +1,7 @@
 #include "text_field.h"
 #include "../rendering/renderer.h"
 #include "font_renderer.h"
+#include "ui_draw_list.h"
 #include <ctype.h>
 
 namespace ui {
@@ -15,6 +16,7 @@ namespace ui {
 
 	void TextFieldComponent::setFocused(bool focused) {
 		this->focused = focused;
+		drawList::markDirty();
 
 		if (focused) {
 			renderer::focusedTextField = this;
@@ -30,26 +32,8 @@ namespace ui {
 		Rectangle outerRect = Rectangle((labelVisible ? (longLabel ? 2.3f : 1.7f) : 0.25f) / aspectRatio, 0.15f, 1.0f - 0.25f / aspectRatio, 0.85f, rect);
 		Rectangle innerRect = Rectangle((labelVisible ? (longLabel ? 2.35f : 1.75f) : 0.3f) / aspectRatio, 0.20f, 1.0f - 0.30f / aspectRatio, 0.80f, rect);
 
-		glBegin(GL_TRIANGLES);
-
-		if (focused) glVertexAttrib3f(1, 1, 1, 1);
-		else glVertexAttrib3f(1, 0.5, 0.5, 0.5);
-		glVertex2f(outerRect.xMin, outerRect.yMax);
-		glVertex2f(outerRect.xMin, outerRect.yMin);
-		glVertex2f(outerRect.xMax, outerRect.yMin);
-		glVertex2f(outerRect.xMax, outerRect.yMax);
-		glVertex2f(outerRect.xMin, outerRect.yMax);
-		glVertex2f(outerRect.xMax, outerRect.yMin);
-
-		glVertexAttrib3f(1, 0, 0, 0);
-		glVertex2f(innerRect.xMin, innerRect.yMax);
-		glVertex2f(innerRect.xMin, innerRect.yMin);
-		glVertex2f(innerRect.xMax, innerRect.yMin);
-		glVertex2f(innerRect.xMax, innerRect.yMax);
-		glVertex2f(innerRect.xMin, innerRect.yMax);
-		glVertex2f(innerRect.xMax, innerRect.yMin);
-
-		glEnd();
+		drawList::addRect(outerRect.xMin, outerRect.yMin, outerRect.xMax, outerRect.yMax, focused ? Color(1.0f, 1.0f, 1.0f) : Color(0.5f, 0.5f, 0.5f));
+		drawList::addRect(innerRect.xMin, innerRect.yMin, innerRect.xMax, innerRect.yMax, COLOR_BLACK);
 
 		if (labelVisible) {
 			fontRendering::drawText(label, rect.xMin+rect.GetWidth()*0.075F, (innerRect.yMin + innerRect.yMax) / 2, rect.GetWidth() * 0.4f, COLOR_WHITE, false, true);
@@ -72,6 +56,8 @@ namespace ui {
 		} else if (keyCode == GLFW_KEY_V && glfwGetKey(renderer::window, GLFW_KEY_LEFT_CONTROL)) {
 			this->text = glfwGetClipboardString(renderer::window);
 		}
+
+		drawList::markDirty();
 	}
 
 	// TODO This is definitely not the cleanest way to do this
@@ -95,10 +81,13 @@ namespace ui {
 				this->text += tolower(pressedChar);
 			}
 		}
+
+		drawList::markDirty();
 	}
 
 	void TextFieldComponent::setText(std::string newText) {
 		this->text = newText;
+		drawList::markDirty();
 	}
 
 	std::string TextFieldComponent::getText() {
@@ -0,0 +1,44 @@
+#include "ui_draw_list.h"
+#include "panel.h"
+#include "font_renderer.h"
+
+namespace ui {
+	namespace drawList {
+		GeometryBatch batch;
+		bool dirty = true;
+
+		void init() {
+			batch.init();
+			dirty = true;
+		}
+
+		void dispose() {
+			batch.dispose();
+		}
+
+		void markDirty() {
+			dirty = true;
+		}
+
+		void addRect(float xMin, float yMin, float xMax, float yMax, Color color) {
+			float u = fontRendering::WhiteTexelU, v = fontRendering::WhiteTexelV;
+			batch.addTexturedRect(xMin, yMin, xMax, yMax, u, v, u, v, color);
+		}
+
+		void render(const std::vector<Panel*>& panels) {
+			if (dirty) {
+				batch.clear();
+				for (unsigned int i = 0; i < panels.size(); i++) {
+					panels[i]->draw();
+				}
+				batch.upload();
+
+				dirty = false;
+			}
+
+			glActiveTexture(GL_TEXTURE0);
+			glBindTexture(GL_TEXTURE_2D, fontRendering::FontTextureID);
+			batch.draw();
+		}
+	}
+}
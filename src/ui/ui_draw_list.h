@@ -0,0 +1,27 @@
+#pragma once
+
+#include <vector>
+
+#include "../rendering/geometry_batch.h"
+#include "../rendering/color.h"
+
+namespace ui {
+	class Panel;
+
+	// Collects the rectangles and glyphs of every panel into a single vertex buffer that is drawn in one call.
+	// The buffer is only rebuilt after markDirty() was called, so anything that changes how the UI looks must call it.
+	namespace drawList {
+		extern GeometryBatch batch;
+
+		void init();
+		void dispose();
+
+		void markDirty();
+
+		// Solid rectangles sample the white texel of the font atlas, so that they can be drawn together with the text
+		void addRect(float xMin, float yMin, float xMax, float yMax, Color color);
+
+		// Rebuilds the buffer if needed and draws it (requires the uiShader)
+		void render(const std::vector<Panel*>& panels);
+	}
+}
@@ -1,11 +1,11 @@
 #include "ui_manager.h"
-#include "../universe/scene_loader.h"
 
 namespace ui {
 	Panel* objectPanel;
 	BodyPropertyComponents bodyPropertyComponents;
 	SceneSettingsComponents sceneSettingsComponents;
-	MassBody* selectedBody;
+	PlaybackComponents playbackComponents;
+	unsigned int selectedBodyId;
 
 	// DEPRECATED FUNCTION TODO: REMOVE (just left here in case i need to copy something from it)
 	Universe* generateUniverse(unsigned int id) {
@@ -69,27 +69,21 @@ namespace ui {
 
 	void setupUIPanels() {
 		bodyPropertyComponents.btnApplyProperties = new ButtonComponent("Apply", []() {
-			Universe* universe = renderer::loadedUniverse;
-			if (universe != nullptr) {
-				std::string massInput = bodyPropertyComponents.massInput->getText();
-				std::string sizeInput = bodyPropertyComponents.sizeInput->getText();
-				if (massInput.length() > 0) selectedBody->mass = std::stof(massInput);
-				if (sizeInput.length() > 0) selectedBody->radius = std::stof(sizeInput);
-
-				std::stringstream hexStream;
-				unsigned int hexRGB;
-				hexStream << std::hex << bodyPropertyComponents.colorInput->getText();
-				hexStream >> hexRGB;
-				selectedBody->color = Color(hexRGB);
-			}
+			std::string massInput = bodyPropertyComponents.massInput->getText();
+			std::string sizeInput = bodyPropertyComponents.sizeInput->getText();
+
+			std::stringstream hexStream;
+			unsigned int hexRGB;
+			hexStream << std::hex << bodyPropertyComponents.colorInput->getText();
+			hexStream >> hexRGB;
+
+			if (massInput.length() > 0) renderer::setBodyProperty(selectedBodyId, simulation::BodyProperty::Mass, std::stof(massInput));
+			if (sizeInput.length() > 0) renderer::setBodyProperty(selectedBodyId, simulation::BodyProperty::Radius, std::stof(sizeInput));
+			renderer::setBodyProperty(selectedBodyId, simulation::BodyProperty::Color, Color(hexRGB));
 		});
 
 		bodyPropertyComponents.btnSetEmissive = new ButtonComponent("Make Emissive", []() {
-			Universe* universe = renderer::loadedUniverse;
-			if (universe != nullptr) {
-				int bodyIndex = universe->GetBodyIndex(selectedBody);
-				if (bodyIndex >= 0) universe->SetEmissiveBody(bodyIndex);
-			}
+			simulation::queueCommand(simulation::Command::SetEmissive(selectedBodyId));
 		});
 
 		bodyPropertyComponents.massInput = new TextFieldComponent("Mass", "", TFF_DECIMAL_NUMBER);
@@ -99,43 +93,69 @@ namespace ui {
 		bodyPropertyComponents.affectsOthersCB = new CheckBoxComponent("Affects others");
 
 		bodyPropertyComponents.affectedByGravityCB->setToggleCallback([](bool checked) {
-			Universe* universe = renderer::loadedUniverse;
-			if (universe != nullptr) {
-				selectedBody->affectedByGravity = checked;
-			}
+			renderer::setBodyProperty(selectedBodyId, simulation::BodyProperty::AffectedByGravity, checked);
 		});
 
 		bodyPropertyComponents.affectsOthersCB->setToggleCallback([](bool checked) {
-			Universe* universe = renderer::loadedUniverse;
-			if (universe != nullptr) {
-				selectedBody->affectsOthers = checked;
-			}
+			renderer::setBodyProperty(selectedBodyId, simulation::BodyProperty::AffectsOthers, checked);
 		});
 
-		sceneSettingsComponents.timeScaleInput = new TextFieldComponent("Timescale", std::to_string(renderer::loadedUniverse->timeScale), TFF_DECIMAL_NUMBER);
-		sceneSettingsComponents.gravityConstantInput = new TextFieldComponent("G-Constant", std::to_string(renderer::loadedUniverse->gConstant), TFF_DECIMAL_NUMBER);
+		const simulation::Snapshot& snapshot = simulation::getSnapshot();
+		sceneSettingsComponents.timeScaleInput = new TextFieldComponent("Timescale", std::to_string(snapshot.timeScale), TFF_DECIMAL_NUMBER);
+		sceneSettingsComponents.gravityConstantInput = new TextFieldComponent("G-Constant", std::to_string(snapshot.gConstant), TFF_DECIMAL_NUMBER);
 		sceneSettingsComponents.applySettingsBtn = new ButtonComponent("Apply", []() {
-			Universe* universe = renderer::loadedUniverse;
-			if (universe != nullptr) {
-				universe->timeScale = std::stof(sceneSettingsComponents.timeScaleInput->getText());
-				universe->gConstant = std::stof(sceneSettingsComponents.gravityConstantInput->getText());
-			}
+			simulation::queueCommand(simulation::Command::SetTimeScale(std::stof(sceneSettingsComponents.timeScaleInput->getText())));
+			simulation::queueCommand(simulation::Command::SetGravityConstant(std::stof(sceneSettingsComponents.gravityConstantInput->getText())));
 		});
 
 		sceneSettingsComponents.sceneNameInput = new TextFieldComponent("Scene name", "");
 
 		sceneSettingsComponents.saveButton = new ButtonComponent("Save", []() {
-			saveScene(renderer::loadedUniverse, std::string("Scenes/"+sceneSettingsComponents.sceneNameInput->getText()+".scene").c_str());
+			simulation::queueCommand(simulation::Command::SaveScene("Scenes/" + sceneSettingsComponents.sceneNameInput->getText() + ".scene"));
 		});
 		sceneSettingsComponents.loadButton = new ButtonComponent("Load", []() {
 			std::string sceneName = sceneSettingsComponents.sceneNameInput->getText();
 			if (sceneName.length() > 0) {
-				Universe* universe = loadScene(std::string("Scenes/" + sceneName + ".scene").c_str());
-				if (universe != nullptr) {
-					if (renderer::loadedUniverse != nullptr) delete renderer::loadedUniverse;
-					renderer::setUniverse(universe);
-				}
+				simulation::queueCommand(simulation::Command::LoadScene("Scenes/" + sceneName + ".scene")); // The camera focuses the new scene once its first snapshot is rendered
+			}
+		});
+		sceneSettingsComponents.recordButton = new ButtonComponent("Record", []() {
+			if (simulation::getSnapshot().recording) {
+				simulation::queueCommand(simulation::Command::StopRecording());
+				return;
+			}
+
+			std::string sceneName = sceneSettingsComponents.sceneNameInput->getText();
+			if (sceneName.length() == 0) sceneName = "recording";
+
+			simulation::queueCommand(simulation::Command::StartRecording("Scenes/" + sceneName + ".rec", recorder::Settings()));
+		});
+
+		// Plays the recording named in the scene name field back
+		playbackComponents.speedInput = new TextFieldComponent("Speed", "1.0", TFF_DECIMAL_NUMBER);
+		playbackComponents.openButton = new ButtonComponent("Play recording", []() {
+			if (simulation::getSnapshot().playingBack) {
+				simulation::queueCommand(simulation::Command::StopPlayback());
+				return;
 			}
+
+			std::string sceneName = sceneSettingsComponents.sceneNameInput->getText();
+			if (sceneName.length() == 0) sceneName = "recording";
+
+			simulation::queueCommand(simulation::Command::StartPlayback("Scenes/" + sceneName + ".rec"));
+		});
+		playbackComponents.pauseButton = new ButtonComponent("Pause", []() {
+			simulation::queueCommand(simulation::Command::SetPlaybackPaused(!simulation::getSnapshot().playbackPaused));
+		});
+		playbackComponents.rewindButton = new ButtonComponent("-5 s", []() {
+			simulation::queueCommand(simulation::Command::SeekPlayback(simulation::getSnapshot().playbackTime - 5.0f));
+		});
+		playbackComponents.forwardButton = new ButtonComponent("+5 s", []() {
+			simulation::queueCommand(simulation::Command::SeekPlayback(simulation::getSnapshot().playbackTime + 5.0f));
+		});
+		playbackComponents.applySpeedButton = new ButtonComponent("Apply speed", []() {
+			std::string speedInput = playbackComponents.speedInput->getText();
+			if (speedInput.length() > 0) simulation::queueCommand(simulation::Command::SetPlaybackSpeed(std::stof(speedInput)));
 		});
 
 		Container bodyPropertiesContainer = Container("Properties");
@@ -158,19 +178,37 @@ namespace ui {
 		sceneSettingsContainer.AddComponent(sceneSettingsComponents.sceneNameInput);
 		sceneSettingsContainer.AddComponent(sceneSettingsComponents.saveButton);
 		sceneSettingsContainer.AddComponent(sceneSettingsComponents.loadButton);
+		sceneSettingsContainer.AddComponent(sceneSettingsComponents.recordButton);
+
+		Container playbackContainer = Container("Playback");
+		playbackContainer.AddComponent(playbackComponents.openButton);
+		playbackContainer.AddComponent(playbackComponents.pauseButton);
+		playbackContainer.AddComponent(playbackComponents.rewindButton);
+		playbackContainer.AddComponent(playbackComponents.forwardButton);
+		playbackContainer.AddComponent(playbackComponents.speedInput);
+		playbackContainer.AddComponent(playbackComponents.applySpeedButton);
 
 		objectPanel = new Panel("Object", Rectangle(0.8f, 0.45f, 0.99f, 0.98f, Rectangle(-1.0f, -1.0f, 1.0f, 1.0f)));
 		objectPanel->AddContainer(bodyPropertiesContainer);
 		objectPanel->AddContainer(gravitySettingsContainer);
 
-		Panel* universePanel = new Panel("Scene settings", Rectangle(0.02f, 0.02f, 0.2f, 0.5f, Rectangle(-1.0f, -1.0f, 1.0f, 1.0f)));
+		Panel* universePanel = new Panel("Scene settings", Rectangle(0.02f, 0.02f, 0.2f, 0.75f, Rectangle(-1.0f, -1.0f, 1.0f, 1.0f)));
 		universePanel->AddContainer(universeSettingsContainer);
 		universePanel->AddContainer(sceneSettingsContainer);
+		universePanel->AddContainer(playbackContainer);
 
 		renderer::uiPanels.push_back(objectPanel);
 		renderer::uiPanels.push_back(universePanel);
 
-		showBodyProperties(renderer::camera.focusedBody);
+		showBodyProperties(renderer::camera.focusedBodyId);
+	}
+
+	void updateLabels(const simulation::Snapshot& snapshot) {
+		if (sceneSettingsComponents.recordButton == nullptr) return; // No UI (offscreen runs)
+
+		sceneSettingsComponents.recordButton->SetLabel(snapshot.recording ? "Stop recording" : "Record");
+		playbackComponents.openButton->SetLabel(snapshot.playingBack ? "Stop playback" : "Play recording");
+		playbackComponents.pauseButton->SetLabel(snapshot.playingBack && snapshot.playbackPaused ? "Resume" : "Pause");
 	}
 
 	// Delete all components from memory
@@ -187,13 +225,16 @@ namespace ui {
 		}
 	}
 
-	void showBodyProperties(MassBody* body, std::string label) {
-		selectedBody = body;
+	void showBodyProperties(unsigned int bodyId, std::string label) {
+		selectedBodyId = bodyId;
 
 		objectPanel->SetLabel(label);
 
-		std::string massStr = std::to_string(body->mass);
-		std::string sizeStr = std::to_string(body->radius);
+		const MassBody* properties = renderer::findBody(bodyId);
+		if (properties == nullptr) return; // Not simulated yet, the fields keep their values until it is shown again
+
+		std::string massStr = std::to_string(properties->mass);
+		std::string sizeStr = std::to_string(properties->radius);
 
 		// Remove unecessary zeros
 		massStr.erase(massStr.find_last_not_of('0') + (massStr.at(massStr.find_last_not_of('0')) == '.' ? 0 : 1), std::string::npos);
@@ -201,11 +242,11 @@ namespace ui {
 
 		bodyPropertyComponents.massInput->setText(massStr);
 		bodyPropertyComponents.sizeInput->setText(sizeStr);
-		bodyPropertyComponents.affectedByGravityCB->setChecked(body->affectedByGravity);
-		bodyPropertyComponents.affectsOthersCB->setChecked(body->affectsOthers);
+		bodyPropertyComponents.affectedByGravityCB->setChecked(properties->affectedByGravity);
+		bodyPropertyComponents.affectsOthersCB->setChecked(properties->affectsOthers);
 
 		std::stringstream colorHexStr;
-		colorHexStr << std::hex << body->color.toHex();
+		colorHexStr << std::hex << properties->color.toHex();
 		bodyPropertyComponents.colorInput->setText(colorHexStr.str());
 	}
 }
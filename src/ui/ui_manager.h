@@ -30,16 +30,29 @@ namespace ui {
 		TextFieldComponent* sceneNameInput;
 		ButtonComponent* saveButton;
 		ButtonComponent* loadButton;
+		ButtonComponent* recordButton;
+	};
+
+	struct PlaybackComponents {
+		TextFieldComponent* speedInput;
+		ButtonComponent* openButton;
+		ButtonComponent* pauseButton;
+		ButtonComponent* rewindButton;
+		ButtonComponent* forwardButton;
+		ButtonComponent* applySpeedButton;
 	};
 
 	extern Panel* objectPanel;
 
 	extern BodyPropertyComponents bodyPropertyComponents;
 	extern SceneSettingsComponents sceneSettingsComponents;
-	extern MassBody* selectedBody; // Can be different from the focused body (currently just during the spawn process)
+	extern PlaybackComponents playbackComponents;
+	extern unsigned int selectedBodyId; // Can be different from the focused body (currently just during the spawn process)
 
 	void setupUIPanels();
-	void showBodyProperties(MassBody* body, std::string label="Selected body");
+	void showBodyProperties(unsigned int bodyId, std::string label="Selected body");
+	// Every frame: buttons whose label shows the state of the simulation (recording, playback) only change once their command has been applied
+	void updateLabels(const simulation::Snapshot& snapshot);
 
 	Universe* generateUniverse(unsigned int id); // Depreacated and should be removed
 
@@ -0,0 +1,130 @@
+#include "checkpoint.h"
+#include "scene_loader.h"
+#include "simulation.h"
+#include "mapped_file.h"
+
+#include <iostream>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+static_assert(sizeof(checkpoint::CheckpointState) == 16, "The checkpoint state must keep its size");
+
+namespace checkpoint {
+	std::thread writerThread;
+	std::atomic<bool> writing(false);
+	std::vector<char> buffer; // Owned by the writer thread while it runs
+
+	static double millisecondsSince(std::chrono::steady_clock::time_point start) {
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	// Writes and flushes the whole buffer to a temporary file, then swaps it with the previous checkpoint
+	static bool writeFile(const std::string& filePath) {
+		std::string temporaryPath = filePath + ".tmp";
+
+		FILE* file = fopen(temporaryPath.c_str(), "wb");
+		if (file == nullptr) {
+			std::cout << "[ERROR] Could not create the checkpoint file '" << temporaryPath << "'." << std::endl;
+			return false;
+		}
+
+		bool written = fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size() && fflush(file) == 0;
+#ifdef _WIN32
+		written = written && _commit(_fileno(file)) == 0;
+#else
+		written = written && fsync(fileno(file)) == 0; // The rename must not reach the disk before the data
+#endif
+		fclose(file);
+
+		if (!written) {
+			std::cout << "[ERROR] Could not write the checkpoint file '" << temporaryPath << "'." << std::endl;
+			remove(temporaryPath.c_str());
+			return false;
+		}
+
+#ifdef _WIN32
+		bool renamed = MoveFileExA(temporaryPath.c_str(), filePath.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+		bool renamed = rename(temporaryPath.c_str(), filePath.c_str()) == 0;
+#endif
+		if (!renamed) {
+			std::cout << "[ERROR] Could not replace the checkpoint file '" << filePath << "'." << std::endl;
+			return false;
+		}
+
+		return true;
+	}
+
+	bool save(Universe* universe, unsigned long long tick, const std::string& filePath) {
+		if (writing) {
+			std::cout << "[WARNING] Checkpoint of tick " << tick << " skipped, the previous one is still being written." << std::endl;
+			return false;
+		}
+		wait(); // Only one checkpoint is ever in flight, which bounds the memory and disk bandwidth they take
+
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+		CheckpointState state = {};
+		state.tick = tick;
+		state.tickRate = SIMULATION_TICK_RATE;
+
+		serializeScene(universe, buffer);
+		appendSceneSection(buffer, CHECKPOINT_SECTION_SIMULATION, sizeof(state), &state, sizeof(state));
+
+		double copyTime = millisecondsSince(start);
+
+		writing = true;
+		writerThread = std::thread([filePath, tick, copyTime]() {
+			std::chrono::steady_clock::time_point writeStart = std::chrono::steady_clock::now();
+			if (writeFile(filePath)) {
+				std::cout << "Checkpoint of tick " << tick << " saved to '" << filePath << "' (" << buffer.size() / (1024.0 * 1024.0) << " MB, "
+					<< copyTime << " ms copying the universe, " << millisecondsSince(writeStart) << " ms writing in the background)." << std::endl;
+			}
+			writing = false;
+		});
+
+		return true;
+	}
+
+	void wait() {
+		if (writerThread.joinable()) writerThread.join();
+	}
+
+	Universe* load(const std::string& filePath, unsigned long long& tick) {
+		MappedFile file;
+		if (!file.open(filePath.c_str())) {
+			std::cout << "[ERROR] Could not open the checkpoint '" << filePath << "'." << std::endl;
+			return nullptr;
+		}
+
+		uint64_t stateSize = 0;
+		const char* stateData = findSceneSection(file.getData(), file.getSize(), CHECKPOINT_SECTION_SIMULATION, stateSize);
+		if (stateData == nullptr || stateSize < sizeof(CheckpointState)) {
+			std::cout << "[ERROR] '" << filePath << "' is not a checkpoint." << std::endl;
+			return nullptr;
+		}
+
+		CheckpointState state;
+		memcpy(&state, stateData, sizeof(state));
+		if (state.tickRate != SIMULATION_TICK_RATE) {
+			std::cout << "[WARNING] The checkpoint was made at " << state.tickRate << " ticks per second instead of " << SIMULATION_TICK_RATE << ", the run won't continue identically." << std::endl;
+		}
+
+		Universe* universe = parseScene(file.getData(), file.getSize());
+		if (universe != nullptr) tick = state.tick;
+
+		return universe;
+	}
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+
+#include "universe.h"
+
+#define CHECKPOINT_SECTION_SIMULATION 0x554D4953 // "SIMU": one CheckpointState, added to the scene file of the checkpoint
+
+// A checkpoint is a version 2 scene file (so it can also be opened as a scene) with the state of the simulation run added to it.
+// Saving copies the universe on the calling thread, the file is written by a background thread into a temporary file that
+// then replaces the previous checkpoint, so a run killed at any moment always leaves a complete checkpoint behind
+namespace checkpoint {
+	struct CheckpointState {
+		uint64_t tick; // Ticks simulated before the checkpoint
+		uint32_t tickRate; // SIMULATION_TICK_RATE of the run
+		uint32_t reserved;
+	};
+
+	// Returns false, without saving anything, while the previous checkpoint is still being written
+	bool save(Universe* universe, unsigned long long tick, const std::string& filePath);
+	// Waits until the checkpoint being written (if any) is on disk
+	void wait();
+	// nullptr if the file isn't a valid checkpoint
+	Universe* load(const std::string& filePath, unsigned long long& tick);
+}
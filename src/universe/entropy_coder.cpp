@@ -0,0 +1,197 @@
+#include "entropy_coder.h"
+
+#include <cstring>
+
+#define ENTROPY_MODE_STORED 0
+#define ENTROPY_MODE_CONSTANT 1 // Every byte is the same, only that byte is stored
+#define ENTROPY_MODE_RANS 2
+
+#define RANS_LOWER_BOUND (1u << 23) // The state is kept in [RANS_LOWER_BOUND, RANS_LOWER_BOUND << 8)
+
+namespace entropy {
+	const uint32_t probabilityScale = 1 << ENTROPY_PROBABILITY_BITS;
+
+	// Scales the byte counts so that they add up to probabilityScale, keeping every byte that appears at a frequency of at least 1
+	static void normalizeFrequencies(const uint32_t counts[256], size_t size, uint32_t frequencies[256]) {
+		uint32_t total = 0;
+		for (int symbol = 0; symbol < 256; symbol++) {
+			if (counts[symbol] == 0) {
+				frequencies[symbol] = 0;
+				continue;
+			}
+
+			frequencies[symbol] = (uint32_t)((uint64_t)counts[symbol] * probabilityScale / size);
+			if (frequencies[symbol] == 0) frequencies[symbol] = 1;
+			total += frequencies[symbol];
+		}
+
+		// Rounding leaves the total a bit off, which is taken from (or given to) the most frequent bytes where it matters least
+		while (total != probabilityScale) {
+			int largest = 0;
+			for (int symbol = 1; symbol < 256; symbol++) {
+				if (frequencies[symbol] > frequencies[largest]) largest = symbol;
+			}
+
+			if (total < probabilityScale) {
+				frequencies[largest] += probabilityScale - total;
+				total = probabilityScale;
+			}
+			else {
+				uint32_t excess = total - probabilityScale;
+				uint32_t removed = excess < frequencies[largest] - 1 ? excess : frequencies[largest] - 1;
+				frequencies[largest] -= removed;
+				total -= removed;
+			}
+		}
+	}
+
+	void compress(const uint8_t* data, size_t size, std::vector<uint8_t>& output) {
+		size_t start = output.size();
+
+		uint32_t counts[256] = {};
+		for (size_t i = 0; i < size; i++) counts[data[i]]++;
+
+		int usedSymbols = 0;
+		for (int symbol = 0; symbol < 256; symbol++) {
+			if (counts[symbol] > 0) usedSymbols++;
+		}
+
+		if (usedSymbols <= 1) {
+			output.push_back(ENTROPY_MODE_CONSTANT);
+			output.push_back(size > 0 ? data[0] : 0);
+			return;
+		}
+
+		uint32_t frequencies[256];
+		uint32_t cumulative[256];
+		normalizeFrequencies(counts, size, frequencies);
+
+		uint32_t sum = 0;
+		for (int symbol = 0; symbol < 256; symbol++) {
+			cumulative[symbol] = sum;
+			sum += frequencies[symbol];
+		}
+
+		// Header: mode, bitmask of the bytes that appear, then their frequencies
+		output.push_back(ENTROPY_MODE_RANS);
+		uint8_t presence[32] = {};
+		for (int symbol = 0; symbol < 256; symbol++) {
+			if (frequencies[symbol] > 0) presence[symbol >> 3] |= 1 << (symbol & 7);
+		}
+		output.insert(output.end(), presence, presence + 32);
+		for (int symbol = 0; symbol < 256; symbol++) {
+			if (frequencies[symbol] == 0) continue;
+			output.push_back((uint8_t)frequencies[symbol]);
+			output.push_back((uint8_t)(frequencies[symbol] >> 8));
+		}
+
+		// rANS is last in first out, so the bytes are encoded backwards from the end of a buffer large enough for the worst case
+		size_t headerEnd = output.size();
+		size_t capacity = size + size / 4 + 16;
+		output.resize(headerEnd + 4 + capacity);
+		uint8_t* bufferEnd = output.data() + output.size();
+		uint8_t* cursor = bufferEnd;
+		uint8_t* limit = output.data() + headerEnd + 4 + 4; // Leaves room for the flushed state
+
+		uint32_t state = RANS_LOWER_BOUND;
+		for (size_t i = size; i > 0; i--) {
+			uint8_t symbol = data[i - 1];
+			uint32_t frequency = frequencies[symbol];
+
+			uint32_t maxState = ((RANS_LOWER_BOUND >> ENTROPY_PROBABILITY_BITS) << 8) * frequency;
+			while (state >= maxState) {
+				*--cursor = (uint8_t)state;
+				state >>= 8;
+			}
+			state = ((state / frequency) << ENTROPY_PROBABILITY_BITS) + (state % frequency) + cumulative[symbol];
+
+			if (cursor < limit) break; // Not worth it, stored below
+		}
+
+		cursor -= 4;
+		memcpy(cursor, &state, 4);
+
+		size_t encodedSize = bufferEnd - cursor;
+		if (cursor < output.data() + headerEnd + 4 || headerEnd - start + 4 + encodedSize >= size + 1) {
+			output.resize(start);
+			output.push_back(ENTROPY_MODE_STORED);
+			output.insert(output.end(), data, data + size);
+			return;
+		}
+
+		// Encoded size, then the encoded bytes moved right after it
+		uint32_t encodedSize32 = (uint32_t)encodedSize;
+		memcpy(output.data() + headerEnd, &encodedSize32, 4);
+		memmove(output.data() + headerEnd + 4, cursor, encodedSize);
+		output.resize(headerEnd + 4 + encodedSize);
+	}
+
+	size_t decompress(const uint8_t* data, size_t dataSize, uint8_t* output, size_t size) {
+		if (dataSize < 1) return 0;
+		const uint8_t* cursor = data + 1;
+		const uint8_t* end = data + dataSize;
+
+		switch (data[0]) {
+		case ENTROPY_MODE_STORED:
+			if ((size_t)(end - cursor) < size) return 0;
+			memcpy(output, cursor, size);
+			return 1 + size;
+		case ENTROPY_MODE_CONSTANT:
+			if (end - cursor < 1) return 0;
+			memset(output, *cursor, size);
+			return 2;
+		case ENTROPY_MODE_RANS:
+			break;
+		default:
+			return 0;
+		}
+
+		if (end - cursor < 32) return 0;
+		const uint8_t* presence = cursor;
+		cursor += 32;
+
+		// Slot to byte table, so that decoding a byte doesn't need a search
+		uint8_t symbols[probabilityScale];
+		uint32_t frequencies[256] = {};
+		uint32_t cumulative[256] = {};
+		uint32_t sum = 0;
+		for (int symbol = 0; symbol < 256; symbol++) {
+			if ((presence[symbol >> 3] & (1 << (symbol & 7))) == 0) continue;
+
+			if (end - cursor < 2) return 0;
+			frequencies[symbol] = cursor[0] | (cursor[1] << 8);
+			cursor += 2;
+
+			if (frequencies[symbol] == 0 || sum + frequencies[symbol] > probabilityScale) return 0;
+			cumulative[symbol] = sum;
+			memset(symbols + sum, symbol, frequencies[symbol]);
+			sum += frequencies[symbol];
+		}
+		if (sum != probabilityScale) return 0;
+
+		uint32_t encodedSize;
+		if (end - cursor < 4) return 0;
+		memcpy(&encodedSize, cursor, 4);
+		cursor += 4;
+		if (encodedSize < 4 || (size_t)(end - cursor) < encodedSize) return 0;
+
+		const uint8_t* encodedEnd = cursor + encodedSize;
+		uint32_t state;
+		memcpy(&state, cursor, 4);
+		cursor += 4;
+
+		const uint32_t mask = probabilityScale - 1;
+		for (size_t i = 0; i < size; i++) {
+			uint8_t symbol = symbols[state & mask];
+			output[i] = symbol;
+
+			state = frequencies[symbol] * (state >> ENTROPY_PROBABILITY_BITS) + (state & mask) - cumulative[symbol];
+			while (state < RANS_LOWER_BOUND) {
+				if (cursor >= encodedEnd) return 0;
+				state = (state << 8) | *cursor++;
+			}
+		}
+
+		return encodedEnd - data;
+	}
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+// Order-0 rANS byte coder: each byte costs about as many bits as its frequency in the block calls for.
+// Works best on blocks whose bytes have a skewed distribution, e.g. one byte plane of small deltas.
+#define ENTROPY_PROBABILITY_BITS 12 // Frequencies are scaled to add up to 1 << ENTROPY_PROBABILITY_BITS
+
+namespace entropy {
+	// Appends the compressed block to output. Falls back to storing the bytes when they can't be compressed
+	void compress(const uint8_t* data, size_t size, std::vector<uint8_t>& output);
+	// The size of the original block must be known. Returns the number of compressed bytes read, 0 if the data is invalid
+	size_t decompress(const uint8_t* data, size_t dataSize, uint8_t* output, size_t size);
+}
@@ -0,0 +1,296 @@
+#include "frame_codec.h"
+#include "entropy_coder.h"
+
+#include <cstring>
+#include <atomic>
+#include <algorithm>
+
+static_assert(sizeof(recording::QuantizedFrameHeader) == 64, "Recording headers must keep their size");
+
+#define STREAM_COUNT 9 // Position x, y, z, velocity x, y, z, mass, radius, color
+
+namespace recording {
+	// Maps floats between min and max to integers between 0 and 2^bits - 1
+	struct Quantizer {
+		float min;
+		double scale;
+		uint32_t maxValue;
+
+		Quantizer(float min, float max, uint32_t bits) : min(min) {
+			maxValue = bits >= 32 ? 0xFFFFFFFF : (1u << bits) - 1;
+			scale = max > min ? maxValue / ((double)max - min) : 0.0;
+		}
+
+		uint32_t quantize(float value) const {
+			double scaled = (value - (double)min) * scale + 0.5;
+			if (!(scaled > 0.0)) return 0; // Also catches NaN
+			if (scaled >= maxValue) return maxValue;
+			return (uint32_t)scaled;
+		}
+
+		float dequantize(uint32_t value) const {
+			return scale > 0.0 ? (float)(min + value / scale) : min;
+		}
+	};
+
+	static uint32_t floatBits(float value) {
+		uint32_t bits;
+		memcpy(&bits, &value, sizeof(bits));
+		return bits;
+	}
+
+	static float bitsFloat(uint32_t bits) {
+		float value;
+		memcpy(&value, &bits, sizeof(value));
+		return value;
+	}
+
+	// Small differences, positive or negative, become small unsigned numbers (0, -1, 1, -2... => 0, 1, 2, 3...)
+	static uint32_t zigzag(uint32_t difference) {
+		return (difference << 1) ^ (uint32_t)((int32_t)difference >> 31);
+	}
+
+	static uint32_t unzigzag(uint32_t value) {
+		return (value >> 1) ^ (0u - (value & 1));
+	}
+
+	FrameEncoder::FrameEncoder(uint32_t encoding, uint32_t positionBits, uint32_t velocityBits) {
+		this->encoding = encoding;
+		this->positionBits = std::min<uint32_t>(std::max<uint32_t>(positionBits, 1), 32);
+		this->velocityBits = std::min<uint32_t>(std::max<uint32_t>(velocityBits, 1), 32);
+		if (encoding == RECORDING_ENCODING_QUANTIZED) workers.reset(new WorkerPool());
+
+		framesSinceKeyframe = RECORDING_KEYFRAME_INTERVAL; // The first frame is a keyframe
+		previousBodyCount = 0;
+	}
+
+	bool FrameEncoder::fitsGrid(const Frame& frame) {
+		for (size_t i = 0; i < frame.getBodyCount(); i++) {
+			const glm::vec3& position = frame.positions[i];
+			const glm::vec3& velocity = frame.velocities[i];
+			for (int axis = 0; axis < 3; axis++) {
+				if (position[axis] < positionMin[axis] || position[axis] > positionMax[axis]) return false;
+				if (velocity[axis] < velocityMin[axis] || velocity[axis] > velocityMax[axis]) return false;
+			}
+		}
+
+		return true;
+	}
+
+	static void boundingBox(const std::vector<glm::vec3>& vectors, glm::vec3& min, glm::vec3& max) {
+		min = max = vectors.empty() ? glm::vec3(0.0f) : vectors[0];
+		for (const glm::vec3& vector : vectors) {
+			min = glm::min(min, vector);
+			max = glm::max(max, vector);
+		}
+
+		glm::vec3 size = max - min;
+		float margin = std::max(std::max(size.x, size.y), size.z) * RECORDING_GRID_MARGIN;
+		if (!(margin > 0.0f)) margin = 1.0f;
+
+		min -= glm::vec3(margin);
+		max += glm::vec3(margin);
+	}
+
+	void FrameEncoder::placeGrid(const Frame& frame) {
+		boundingBox(frame.positions, positionMin, positionMax);
+		boundingBox(frame.velocities, velocityMin, velocityMax);
+	}
+
+	uint32_t FrameEncoder::encode(const Frame& frame, std::vector<char>& output) {
+		if (encoding != RECORDING_ENCODING_QUANTIZED) {
+			encodeFrame(frame, encoding, output);
+			return RECORDING_FRAME_KEYFRAME;
+		}
+
+		size_t bodyCount = frame.getBodyCount();
+
+		bool keyframe = framesSinceKeyframe + 1 >= RECORDING_KEYFRAME_INTERVAL || bodyCount != previousBodyCount || !fitsGrid(frame);
+		if (keyframe) {
+			placeGrid(frame);
+			previousValues.resize(bodyCount * STREAM_COUNT);
+			framesSinceKeyframe = 0;
+		}
+		else {
+			framesSinceKeyframe++;
+		}
+		previousBodyCount = bodyCount;
+
+		const Quantizer positionQuantizers[3] = {
+			Quantizer(positionMin.x, positionMax.x, positionBits), Quantizer(positionMin.y, positionMax.y, positionBits), Quantizer(positionMin.z, positionMax.z, positionBits)
+		};
+		const Quantizer velocityQuantizers[3] = {
+			Quantizer(velocityMin.x, velocityMax.x, velocityBits), Quantizer(velocityMin.y, velocityMax.y, velocityBits), Quantizer(velocityMin.z, velocityMax.z, velocityBits)
+		};
+
+		size_t blockCount = (bodyCount + RECORDING_BLOCK_SIZE - 1) / RECORDING_BLOCK_SIZE;
+		size_t jobCount = blockCount * STREAM_COUNT;
+		if (blockOutputs.size() < jobCount) blockOutputs.resize(jobCount);
+
+		workers->run(jobCount, [&](size_t jobIndex) {
+			static thread_local std::vector<uint8_t> planes;
+
+			int stream = jobIndex / blockCount;
+			size_t begin = (jobIndex % blockCount) * RECORDING_BLOCK_SIZE;
+			size_t count = std::min<size_t>(RECORDING_BLOCK_SIZE, bodyCount - begin);
+			uint32_t* previous = previousValues.data() + stream * bodyCount + begin;
+
+			planes.resize(count * 4);
+			for (size_t i = 0; i < count; i++) {
+				size_t bodyIndex = begin + i;
+				uint32_t value;
+				if (stream < 3) value = positionQuantizers[stream].quantize(frame.positions[bodyIndex][stream]);
+				else if (stream < 6) value = velocityQuantizers[stream - 3].quantize(frame.velocities[bodyIndex][stream - 3]);
+				else if (stream == 6) value = floatBits(frame.masses[bodyIndex]);
+				else if (stream == 7) value = floatBits(frame.radii[bodyIndex]);
+				else value = frame.colors[bodyIndex];
+
+				uint32_t stored = keyframe ? value : zigzag(value - previous[i]);
+				previous[i] = value;
+
+				// Byte planes: the high bytes of small differences are all zeros, which compresses to almost nothing
+				planes[i] = (uint8_t)stored;
+				planes[count + i] = (uint8_t)(stored >> 8);
+				planes[count * 2 + i] = (uint8_t)(stored >> 16);
+				planes[count * 3 + i] = (uint8_t)(stored >> 24);
+			}
+
+			std::vector<uint8_t>& blockOutput = blockOutputs[jobIndex];
+			blockOutput.clear();
+			for (int plane = 0; plane < 4; plane++) {
+				entropy::compress(planes.data() + count * plane, count, blockOutput);
+			}
+		});
+
+		QuantizedFrameHeader header = {};
+		header.positionBits = positionBits;
+		header.velocityBits = velocityBits;
+		header.blockSize = RECORDING_BLOCK_SIZE;
+		header.positionMin = positionMin;
+		header.positionMax = positionMax;
+		header.velocityMin = velocityMin;
+		header.velocityMax = velocityMax;
+
+		size_t dataSize = sizeof(header) + jobCount * sizeof(uint32_t);
+		for (size_t jobIndex = 0; jobIndex < jobCount; jobIndex++) dataSize += blockOutputs[jobIndex].size();
+
+		size_t offset = output.size();
+		output.resize(offset + dataSize);
+		char* cursor = output.data() + offset;
+
+		memcpy(cursor, &header, sizeof(header));
+		cursor += sizeof(header);
+		for (size_t jobIndex = 0; jobIndex < jobCount; jobIndex++) {
+			uint32_t blockSize = (uint32_t)blockOutputs[jobIndex].size();
+			memcpy(cursor, &blockSize, sizeof(blockSize));
+			cursor += sizeof(blockSize);
+		}
+		for (size_t jobIndex = 0; jobIndex < jobCount; jobIndex++) {
+			memcpy(cursor, blockOutputs[jobIndex].data(), blockOutputs[jobIndex].size());
+			cursor += blockOutputs[jobIndex].size();
+		}
+
+		return keyframe ? RECORDING_FRAME_KEYFRAME : 0;
+	}
+
+	FrameDecoder::FrameDecoder(uint32_t encoding) {
+		this->encoding = encoding;
+		if (encoding == RECORDING_ENCODING_QUANTIZED) workers.reset(new WorkerPool());
+
+		hasPrevious = false;
+		previousFrameIndex = 0;
+	}
+
+	void FrameDecoder::reset() {
+		hasPrevious = false;
+	}
+
+	bool FrameDecoder::decode(const FrameHeader& header, const char* data, Frame& frame) {
+		frame.tick = header.tick;
+		frame.emissiveBodyIndex = header.emissiveBodyIndex;
+		frame.timeScale = header.timeScale;
+
+		if (encoding != RECORDING_ENCODING_QUANTIZED) {
+			return decodeFrame(data, header.dataSize, encoding, header.bodyCount, frame);
+		}
+
+		size_t bodyCount = header.bodyCount;
+		bool keyframe = (header.flags & RECORDING_FRAME_KEYFRAME) != 0;
+		if (!keyframe && (!hasPrevious || header.frameIndex != previousFrameIndex + 1 || previousValues.size() != bodyCount * STREAM_COUNT)) return false;
+
+		QuantizedFrameHeader quantizedHeader;
+		if (header.dataSize < sizeof(quantizedHeader)) return false;
+		memcpy(&quantizedHeader, data, sizeof(quantizedHeader));
+		if (quantizedHeader.blockSize == 0) return false;
+
+		size_t blockSize = quantizedHeader.blockSize;
+		size_t blockCount = (bodyCount + blockSize - 1) / blockSize;
+		size_t jobCount = blockCount * STREAM_COUNT;
+
+		// Where every block starts
+		size_t offset = sizeof(quantizedHeader) + jobCount * sizeof(uint32_t);
+		if (header.dataSize < offset) return false;
+		blockOffsets.resize(jobCount + 1);
+		for (size_t jobIndex = 0; jobIndex < jobCount; jobIndex++) {
+			uint32_t compressedSize;
+			memcpy(&compressedSize, data + sizeof(quantizedHeader) + jobIndex * sizeof(uint32_t), sizeof(compressedSize));
+			blockOffsets[jobIndex] = offset;
+			offset += compressedSize;
+		}
+		blockOffsets[jobCount] = offset;
+		if (header.dataSize < offset) return false;
+
+		const Quantizer positionQuantizers[3] = {
+			Quantizer(quantizedHeader.positionMin.x, quantizedHeader.positionMax.x, quantizedHeader.positionBits),
+			Quantizer(quantizedHeader.positionMin.y, quantizedHeader.positionMax.y, quantizedHeader.positionBits),
+			Quantizer(quantizedHeader.positionMin.z, quantizedHeader.positionMax.z, quantizedHeader.positionBits)
+		};
+		const Quantizer velocityQuantizers[3] = {
+			Quantizer(quantizedHeader.velocityMin.x, quantizedHeader.velocityMax.x, quantizedHeader.velocityBits),
+			Quantizer(quantizedHeader.velocityMin.y, quantizedHeader.velocityMax.y, quantizedHeader.velocityBits),
+			Quantizer(quantizedHeader.velocityMin.z, quantizedHeader.velocityMax.z, quantizedHeader.velocityBits)
+		};
+
+		if (keyframe) previousValues.resize(bodyCount * STREAM_COUNT);
+		frame.resize(bodyCount);
+
+		std::atomic<bool> valid(true);
+		workers->run(jobCount, [&](size_t jobIndex) {
+			static thread_local std::vector<uint8_t> planes;
+
+			int stream = jobIndex / blockCount;
+			size_t begin = (jobIndex % blockCount) * blockSize;
+			size_t count = std::min<size_t>(blockSize, bodyCount - begin);
+			uint32_t* previous = previousValues.data() + stream * bodyCount + begin;
+
+			planes.resize(count * 4);
+			const uint8_t* compressed = (const uint8_t*)data + blockOffsets[jobIndex];
+			const uint8_t* compressedEnd = (const uint8_t*)data + blockOffsets[jobIndex + 1];
+			for (int plane = 0; plane < 4; plane++) {
+				size_t read = entropy::decompress(compressed, compressedEnd - compressed, planes.data() + count * plane, count);
+				if (read == 0) {
+					valid = false;
+					return;
+				}
+				compressed += read;
+			}
+
+			for (size_t i = 0; i < count; i++) {
+				size_t bodyIndex = begin + i;
+				uint32_t stored = planes[i] | (planes[count + i] << 8) | (planes[count * 2 + i] << 16) | ((uint32_t)planes[count * 3 + i] << 24);
+				uint32_t value = keyframe ? stored : previous[i] + unzigzag(stored);
+				previous[i] = value;
+
+				if (stream < 3) frame.positions[bodyIndex][stream] = positionQuantizers[stream].dequantize(value);
+				else if (stream < 6) frame.velocities[bodyIndex][stream - 3] = velocityQuantizers[stream - 3].dequantize(value);
+				else if (stream == 6) frame.masses[bodyIndex] = bitsFloat(value);
+				else if (stream == 7) frame.radii[bodyIndex] = bitsFloat(value);
+				else frame.colors[bodyIndex] = value;
+			}
+		});
+
+		hasPrevious = valid;
+		previousFrameIndex = header.frameIndex;
+		return valid;
+	}
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <memory>
+
+#include "recording.h"
+#include "worker_pool.h"
+
+// RECORDING_ENCODING_QUANTIZED frames. Every property is a stream of one 32-bit value per body:
+// positions and velocities are quantized on a grid (a box around the bodies, split into 2^bits steps per axis),
+// masses, radii and colors are kept as their raw bits.
+// Keyframes store the values, the other frames store the difference with the previous frame, which is small when bodies move little between frames.
+// The streams are split into blocks of bodies; every block is split into byte planes that are compressed on their own by the entropy coder,
+// all blocks being encoded (and decoded) in parallel.
+#define RECORDING_BLOCK_SIZE 65536 // Bodies per block
+#define RECORDING_KEYFRAME_INTERVAL 60 // Maximum frames between two keyframes, so that seeking never needs to decode more than that
+#define RECORDING_GRID_MARGIN 0.25f // Part of the size of the bodies' box added around it on keyframes, so that the next frames still fit on the grid
+#define RECORDING_DEFAULT_POSITION_BITS 20
+#define RECORDING_DEFAULT_VELOCITY_BITS 16
+
+namespace recording {
+	// Start of the data of a RECORDING_ENCODING_QUANTIZED frame, followed by the compressed size of every block (uint32) and the blocks
+	struct QuantizedFrameHeader {
+		uint32_t positionBits;
+		uint32_t velocityBits;
+		uint32_t blockSize;
+		uint32_t reserved;
+		glm::vec3 positionMin, positionMax; // Position grid
+		glm::vec3 velocityMin, velocityMax; // Velocity grid
+	};
+
+	// Encodes the frames of one recording, in order
+	class FrameEncoder
+	{
+	private:
+		uint32_t encoding;
+		uint32_t positionBits;
+		uint32_t velocityBits;
+		std::unique_ptr<WorkerPool> workers;
+
+		// State of the previous frame
+		unsigned int framesSinceKeyframe;
+		size_t previousBodyCount;
+		glm::vec3 positionMin, positionMax;
+		glm::vec3 velocityMin, velocityMax;
+		std::vector<uint32_t> previousValues; // Streams of the previous frame, one after the other
+
+		std::vector<std::vector<uint8_t>> blockOutputs;
+
+		bool fitsGrid(const Frame& frame);
+		void placeGrid(const Frame& frame);
+
+	public:
+		// The bits are only used by RECORDING_ENCODING_QUANTIZED
+		FrameEncoder(uint32_t encoding, uint32_t positionBits = RECORDING_DEFAULT_POSITION_BITS, uint32_t velocityBits = RECORDING_DEFAULT_VELOCITY_BITS);
+
+		// Appends the encoded frame to output and returns its RECORDING_FRAME_* flags
+		uint32_t encode(const Frame& frame, std::vector<char>& output);
+	};
+
+	// Decodes the frames of one recording. Frames that aren't keyframes can only be decoded right after the frame before them
+	class FrameDecoder
+	{
+	private:
+		uint32_t encoding;
+		std::unique_ptr<WorkerPool> workers;
+
+		bool hasPrevious;
+		uint32_t previousFrameIndex;
+		std::vector<uint32_t> previousValues;
+
+		std::vector<size_t> blockOffsets;
+
+	public:
+		FrameDecoder(uint32_t encoding);
+
+		// Returns false if the data is invalid or the frame depends on a frame that wasn't the last one decoded
+		bool decode(const FrameHeader& header, const char* data, Frame& frame);
+		// Forgets the previous frame, so that the next frame decoded must be a keyframe
+		void reset();
+	};
+}
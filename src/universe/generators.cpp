@@ -0,0 +1,395 @@
+#include "generators.h"
+#include "worker_pool.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <iostream>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+
+#define SCENE_V1_HEADER_SIZE 8
+#define SCENE_V1_BODY_SIZE 35
+
+#define PROFILE_TABLE_SIZE 4096
+#define PROFILE_MIN_RADIUS 0.0001 // In scale radii, where the profile tables start
+#define PLUMMER_TRUNCATION 20.0 // Radii beyond this many scale radii are drawn again
+#define HERNQUIST_TRUNCATION 100.0 // Holds 98% of the mass of the untruncated halo
+#define DISK_TRUNCATION 10.0 // In scale lengths
+#define DISK_THICKNESS 0.05 // Scale height of the sech² vertical profile, in scale lengths
+#define DISK_VELOCITY_DISPERSION 0.05 // Random velocity added to the circular velocity, as a part of it
+#define MERGER_TILT 60.0f // Degrees between the planes of the two galaxies
+#define MERGER_APPROACH_ANGLE 30.0f // Degrees between the relative velocity of the galaxies and the line joining them
+
+namespace generators {
+	const double pi = 3.14159265358979323846;
+
+	// xoshiro256** seeded with splitmix64. The standard distributions don't give the same numbers on every platform, so they aren't used
+	class Random
+	{
+	private:
+		uint64_t state[4];
+
+		static uint64_t rotate(uint64_t x, int k) {
+			return (x << k) | (x >> (64 - k));
+		}
+
+	public:
+		Random(uint64_t seed, uint64_t stream) {
+			uint64_t x = seed ^ (stream * 0x9E3779B97F4A7C15ull);
+			for (int i = 0; i < 4; i++) {
+				uint64_t z = (x += 0x9E3779B97F4A7C15ull);
+				z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+				z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+				state[i] = z ^ (z >> 31);
+			}
+		}
+
+		uint64_t next() {
+			uint64_t result = rotate(state[1] * 5, 7) * 9;
+			uint64_t t = state[1] << 17;
+			state[2] ^= state[0];
+			state[3] ^= state[1];
+			state[1] ^= state[2];
+			state[0] ^= state[3];
+			state[2] ^= t;
+			state[3] = rotate(state[3], 45);
+			return result;
+		}
+
+		// In ]0; 1[, so that it can go through log() and atanh()
+		double uniform() {
+			return ((next() >> 11) + 0.5) * (1.0 / 9007199254740992.0);
+		}
+
+		double normal() {
+			return std::sqrt(-2.0 * std::log(uniform())) * std::cos(2.0 * pi * uniform());
+		}
+
+		glm::dvec3 direction() {
+			double z = 2.0 * uniform() - 1.0;
+			double angle = 2.0 * pi * uniform();
+			double radius = std::sqrt(1.0 - z * z);
+			return glm::dvec3(radius * std::cos(angle), z, radius * std::sin(angle));
+		}
+	};
+
+	// Spherical halo in units where the scale radius and G * total mass are 1, tabulated on radii spaced logarithmically
+	struct SphericalProfile {
+		double maxRadius;
+		double logStep;
+		std::vector<double> masses; // Part of the mass inside every radius
+		std::vector<double> dispersions; // Radial velocity dispersion, from the Jeans equation of an isotropic halo
+		std::vector<double> escapeSpeeds;
+
+		double radiusAt(size_t index) const {
+			return PROFILE_MIN_RADIUS * std::exp(index * logStep);
+		}
+
+		double sampleRadius(double massFraction) const {
+			if (massFraction <= masses[0]) return PROFILE_MIN_RADIUS * std::sqrt(massFraction / masses[0]); // The mass grows like r² near the center
+
+			size_t index = std::upper_bound(masses.begin(), masses.end(), massFraction) - masses.begin();
+			if (index >= masses.size()) return maxRadius;
+
+			double t = (massFraction - masses[index - 1]) / (masses[index] - masses[index - 1]);
+			return radiusAt(index - 1) * std::exp(t * logStep);
+		}
+
+		double interpolate(const std::vector<double>& table, double radius) const {
+			double position = std::log(std::max(radius, PROFILE_MIN_RADIUS) / PROFILE_MIN_RADIUS) / logStep;
+			size_t index = std::min((size_t)position, table.size() - 2);
+			double t = std::min(position - index, 1.0);
+			return table[index] + (table[index + 1] - table[index]) * t;
+		}
+	};
+
+	// Mass inside a radius and its derivative, up to a constant factor
+	static double enclosedMass(Model model, double radius) {
+		if (model == Model::Hernquist) return radius * radius / ((1 + radius) * (1 + radius));
+		return std::log(1 + radius) - radius / (1 + radius); // NFW
+	}
+
+	static double enclosedMassDerivative(Model model, double radius) {
+		if (model == Model::Hernquist) return 2 * radius / ((1 + radius) * (1 + radius) * (1 + radius));
+		return radius / ((1 + radius) * (1 + radius));
+	}
+
+	static void buildProfile(Model model, double maxRadius, SphericalProfile& profile) {
+		profile.maxRadius = maxRadius;
+		profile.logStep = std::log(maxRadius / PROFILE_MIN_RADIUS) / (PROFILE_TABLE_SIZE - 1);
+		profile.masses.resize(PROFILE_TABLE_SIZE);
+		profile.dispersions.resize(PROFILE_TABLE_SIZE);
+		profile.escapeSpeeds.resize(PROFILE_TABLE_SIZE);
+
+		double totalMass = enclosedMass(model, maxRadius);
+		std::vector<double> densities(PROFILE_TABLE_SIZE);
+		for (size_t i = 0; i < PROFILE_TABLE_SIZE; i++) {
+			double radius = profile.radiusAt(i);
+			profile.masses[i] = enclosedMass(model, radius) / totalMass;
+			densities[i] = enclosedMassDerivative(model, radius) / totalMass / (4 * pi * radius * radius);
+		}
+		profile.masses.back() = 1.0;
+
+		// Integrals from every radius to the edge (trapezoids over ln(r), so every integrand is multiplied by r)
+		double pressure = 0.0; // Integral of density * G * M(r) / r² (the Jeans equation gives density * dispersion²)
+		double outerPotential = 0.0; // Integral of G * dM / r
+		for (size_t i = PROFILE_TABLE_SIZE; i-- > 0;) {
+			double radius = profile.radiusAt(i);
+			if (i + 1 < PROFILE_TABLE_SIZE) {
+				double nextRadius = profile.radiusAt(i + 1);
+				pressure += 0.5 * profile.logStep * (densities[i] * profile.masses[i] / radius + densities[i + 1] * profile.masses[i + 1] / nextRadius);
+				outerPotential += 0.5 * profile.logStep * (enclosedMassDerivative(model, radius) + enclosedMassDerivative(model, nextRadius)) / totalMass;
+			}
+
+			profile.dispersions[i] = std::sqrt(pressure / densities[i]);
+			profile.escapeSpeeds[i] = std::sqrt(2.0 * (profile.masses[i] / radius + outerPotential));
+		}
+	}
+
+	// Group of bodies generated around its own center of mass, then rotated and moved into place
+	struct Component {
+		Model model;
+		size_t firstBody;
+		size_t bodyCount;
+		double mass;
+		double centralMass; // Disks only, first body of the component
+		glm::dmat3 rotation;
+		glm::dvec3 position;
+		glm::dvec3 velocity;
+		unsigned char color[3];
+	};
+
+	// Chunk of bodies of a component, with its own random sequence
+	struct Job {
+		size_t component;
+		size_t firstBody; // In the scene
+		size_t bodyCount;
+		uint64_t stream;
+
+		// Mass weighted sums of the generated bodies, for the center of mass of the component
+		glm::dvec3 positionSum;
+		glm::dvec3 velocitySum;
+		double massSum;
+	};
+
+	static void writeBody(char* record, const unsigned char color[3], float mass, float radius, glm::vec3 position, glm::vec3 velocity) {
+		memcpy(record, color, 3);
+		memcpy(record + 3, &mass, 4);
+		memcpy(record + 7, &radius, 4);
+		memcpy(record + 11, &position, 12);
+		memcpy(record + 23, &velocity, 12);
+	}
+
+	bool parseModel(const std::string& name, Model& model) {
+		if (name == "plummer") model = Model::Plummer;
+		else if (name == "hernquist") model = Model::Hernquist;
+		else if (name == "nfw") model = Model::NFW;
+		else if (name == "disk") model = Model::ExponentialDisk;
+		else if (name == "merger") model = Model::Merger;
+		else return false;
+
+		return true;
+	}
+
+	bool generate(const Settings& settings, std::vector<char>& scene) {
+		size_t minBodyCount = settings.model == Model::Merger ? 2 : 1;
+		if (settings.bodyCount < minBodyCount || settings.totalMass <= 0 || settings.scaleRadius <= 0 || settings.gConstant <= 0) {
+			std::cout << "[ERROR] The generator needs at least " << minBodyCount << " bodies and a positive mass, scale radius and G-constant." << std::endl;
+			return false;
+		}
+		if (settings.model == Model::NFW && settings.concentration <= 1) {
+			std::cout << "[ERROR] The NFW concentration must be larger than 1." << std::endl;
+			return false;
+		}
+
+		const unsigned char haloColor[3] = { 255, 200, 150 };
+		const unsigned char diskColor[3] = { 170, 200, 255 };
+		const unsigned char secondDiskColor[3] = { 255, 180, 140 };
+
+		std::vector<Component> components;
+		Component component = {};
+		component.model = settings.model;
+		component.bodyCount = settings.bodyCount;
+		component.mass = settings.totalMass;
+		component.rotation = glm::dmat3(1.0);
+		memcpy(component.color, settings.model == Model::ExponentialDisk ? diskColor : haloColor, 3);
+
+		if (settings.model == Model::ExponentialDisk) {
+			component.centralMass = settings.totalMass * settings.centralMassFraction;
+		}
+
+		if (settings.model != Model::Merger) {
+			components.push_back(component);
+		}
+		else {
+			// Two identical disks on a parabolic orbit, passing each other off-center
+			double separation = settings.mergerSeparation * settings.scaleRadius;
+			double approachSpeed = std::sqrt(2.0 * settings.gConstant * settings.totalMass / separation);
+			double approachAngle = glm::radians((double)MERGER_APPROACH_ANGLE);
+			glm::dvec3 relativeVelocity = approachSpeed * glm::dvec3(-std::cos(approachAngle), 0.0, std::sin(approachAngle));
+
+			component.model = Model::ExponentialDisk;
+			component.bodyCount = settings.bodyCount / 2;
+			component.mass = settings.totalMass / 2;
+			component.centralMass = component.mass * settings.centralMassFraction;
+			component.position = glm::dvec3(-separation / 2, 0.0, 0.0);
+			component.velocity = -relativeVelocity / 2.0;
+			memcpy(component.color, diskColor, 3);
+			components.push_back(component);
+
+			component.firstBody = component.bodyCount;
+			component.bodyCount = settings.bodyCount - component.bodyCount;
+			component.position = -component.position;
+			component.velocity = -component.velocity;
+			component.rotation = glm::dmat3(glm::rotate(glm::dmat4(1.0), glm::radians((double)MERGER_TILT), glm::dvec3(1.0, 0.0, 0.0)));
+			memcpy(component.color, secondDiskColor, 3);
+			components.push_back(component);
+		}
+
+		SphericalProfile profile;
+		if (settings.model == Model::Hernquist) buildProfile(Model::Hernquist, HERNQUIST_TRUNCATION, profile);
+		if (settings.model == Model::NFW) buildProfile(Model::NFW, settings.concentration, profile);
+
+		std::vector<Job> jobs;
+		for (size_t componentIndex = 0; componentIndex < components.size(); componentIndex++) {
+			const Component& jobComponent = components[componentIndex];
+			for (size_t offset = 0; offset < jobComponent.bodyCount; offset += GENERATOR_CHUNK_SIZE) {
+				Job job = {};
+				job.component = componentIndex;
+				job.firstBody = jobComponent.firstBody + offset;
+				job.bodyCount = std::min<size_t>(GENERATOR_CHUNK_SIZE, jobComponent.bodyCount - offset);
+				job.stream = jobs.size();
+				jobs.push_back(job);
+			}
+		}
+
+		scene.resize(SCENE_V1_HEADER_SIZE + settings.bodyCount * SCENE_V1_BODY_SIZE);
+		memcpy(scene.data(), &settings.gConstant, 4);
+		memcpy(scene.data() + 4, &settings.timeScale, 4);
+		char* bodies = scene.data() + SCENE_V1_HEADER_SIZE;
+
+		WorkerPool workers;
+
+		// First pass: every component around the origin, at rest
+		workers.run(jobs.size(), [&](size_t jobIndex) {
+			Job& job = jobs[jobIndex];
+			const Component& jobComponent = components[job.component];
+			Random random(settings.seed, job.stream);
+
+			bool disk = jobComponent.model == Model::ExponentialDisk;
+			size_t particleCount = disk ? jobComponent.bodyCount - 1 : jobComponent.bodyCount;
+			double particleMass = particleCount > 0 ? (jobComponent.mass - jobComponent.centralMass) / particleCount : 0.0;
+			double speedUnit = std::sqrt(settings.gConstant * jobComponent.mass / settings.scaleRadius); // Velocities are generated with G * mass = scale radius = 1
+
+			for (size_t i = 0; i < job.bodyCount; i++) {
+				size_t bodyIndex = job.firstBody + i;
+				glm::dvec3 position(0.0), velocity(0.0);
+				double mass = particleMass;
+				float radius = settings.bodyRadius;
+				const unsigned char* color = jobComponent.color;
+				const unsigned char centralColor[3] = { 255, 240, 200 };
+
+				if (disk && bodyIndex == jobComponent.firstBody) {
+					// Central body, the light of the scene for the first galaxy
+					mass = jobComponent.centralMass;
+					radius = settings.bodyRadius * 20.0f;
+					color = centralColor;
+				}
+				else if (disk) {
+					// Exponential surface density (the radius follows a gamma distribution), sech² vertical profile
+					double cylindricalRadius;
+					do {
+						cylindricalRadius = -std::log(random.uniform() * random.uniform());
+					} while (cylindricalRadius > DISK_TRUNCATION);
+					double height = DISK_THICKNESS * std::atanh(2.0 * random.uniform() - 1.0);
+					double angle = 2.0 * pi * random.uniform();
+
+					double centralFraction = jobComponent.centralMass / jobComponent.mass;
+					double diskFraction = 1.0 - centralFraction;
+					double enclosed = centralFraction + diskFraction * (1.0 - (1.0 + cylindricalRadius) * std::exp(-cylindricalRadius));
+					double distance = std::sqrt(cylindricalRadius * cylindricalRadius + height * height);
+					double circularSpeed = std::sqrt(enclosed / distance);
+
+					position = glm::dvec3(cylindricalRadius * std::cos(angle), height, cylindricalRadius * std::sin(angle));
+					velocity = circularSpeed * glm::dvec3(-std::sin(angle), 0.0, std::cos(angle));
+					velocity += circularSpeed * DISK_VELOCITY_DISPERSION * glm::dvec3(random.normal(), random.normal(), random.normal());
+				}
+				else if (jobComponent.model == Model::Plummer) {
+					double distance;
+					do {
+						distance = 1.0 / std::sqrt(std::pow(random.uniform(), -2.0 / 3.0) - 1.0);
+					} while (distance > PLUMMER_TRUNCATION);
+
+					// Part of the escape speed, drawn from q² (1 - q²)^3.5 (Aarseth, Henon & Wielen 1974)
+					double q, y;
+					do {
+						q = random.uniform();
+						y = 0.1 * random.uniform();
+					} while (y > q * q * std::pow(1.0 - q * q, 3.5));
+					double speed = q * std::sqrt(2.0) * std::pow(1.0 + distance * distance, -0.25);
+
+					position = distance * random.direction();
+					velocity = speed * random.direction();
+				}
+				else {
+					// Hernquist or NFW: Gaussian velocities with the local dispersion, kept below the escape speed
+					double distance = profile.sampleRadius(random.uniform());
+					double dispersion = profile.interpolate(profile.dispersions, distance);
+					double escapeSpeed = profile.interpolate(profile.escapeSpeeds, distance);
+
+					position = distance * random.direction();
+					for (int attempt = 0; attempt < 100; attempt++) {
+						velocity = dispersion * glm::dvec3(random.normal(), random.normal(), random.normal());
+						if (glm::length(velocity) < 0.95 * escapeSpeed) break;
+					}
+					if (glm::length(velocity) >= escapeSpeed) velocity *= 0.95 * escapeSpeed / glm::length(velocity);
+				}
+
+				position *= settings.scaleRadius;
+				velocity *= speedUnit;
+
+				job.positionSum += position * mass;
+				job.velocitySum += velocity * mass;
+				job.massSum += mass;
+
+				writeBody(bodies + bodyIndex * SCENE_V1_BODY_SIZE, color, (float)mass, radius, glm::vec3(position), glm::vec3(velocity));
+			}
+
+		});
+
+		// Centers of mass, summed in a fixed order so that the result doesn't depend on the threads
+		std::vector<glm::dvec3> centerPositions(components.size(), glm::dvec3(0.0)), centerVelocities(components.size(), glm::dvec3(0.0));
+		std::vector<double> componentMasses(components.size(), 0.0);
+		for (const Job& job : jobs) {
+			centerPositions[job.component] += job.positionSum;
+			centerVelocities[job.component] += job.velocitySum;
+			componentMasses[job.component] += job.massSum;
+		}
+		for (size_t i = 0; i < components.size(); i++) {
+			if (componentMasses[i] <= 0) continue;
+			centerPositions[i] /= componentMasses[i];
+			centerVelocities[i] /= componentMasses[i];
+		}
+
+		// Second pass: every component at rest around its center of mass, then moved into place
+		workers.run(jobs.size(), [&](size_t jobIndex) {
+			const Job& job = jobs[jobIndex];
+			const Component& jobComponent = components[job.component];
+
+			for (size_t i = 0; i < job.bodyCount; i++) {
+				char* record = bodies + (job.firstBody + i) * SCENE_V1_BODY_SIZE;
+				glm::vec3 position, velocity;
+				memcpy(&position, record + 11, 12);
+				memcpy(&velocity, record + 23, 12);
+
+				position = glm::vec3(jobComponent.rotation * (glm::dvec3(position) - centerPositions[job.component]) + jobComponent.position);
+				velocity = glm::vec3(jobComponent.rotation * (glm::dvec3(velocity) - centerVelocities[job.component]) + jobComponent.velocity);
+
+				memcpy(record + 11, &position, 12);
+				memcpy(record + 23, &velocity, 12);
+			}
+		});
+
+		return true;
+	}
+}
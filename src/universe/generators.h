@@ -0,0 +1,40 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+// Initial conditions for large universes, written straight into a version 1 scene file (see "Scenes/Scene File Definition.txt").
+// Bodies are generated in chunks on a WorkerPool, every chunk with its own random sequence derived from the seed,
+// so a seed always gives the same scene whatever the number of threads.
+// All the bodies of a galaxy have the same mass; disks also have a heavy central body, which is the first body of the galaxy.
+#define GENERATOR_CHUNK_SIZE 65536 // Bodies per job (and per random sequence)
+
+namespace generators {
+	enum class Model {
+		Plummer, // Sphere with the exact Plummer velocity distribution
+		Hernquist, // Halo whose velocity dispersion comes from the Jeans equation
+		NFW, // Same, truncated at concentration * scaleRadius
+		ExponentialDisk, // Thin disk on circular orbits around a central body
+		Merger // Two disks on a collision course, the second one tilted
+	};
+
+	struct Settings {
+		Model model = Model::Plummer;
+		size_t bodyCount = 10000; // Central bodies included
+		uint64_t seed = 1;
+		float totalMass = 1000000.0f;
+		float scaleRadius = 10.0f; // Plummer and Hernquist radius, NFW scale radius, disk scale length
+		float concentration = 10.0f; // NFW only
+		float centralMassFraction = 0.1f; // Disks only: part of the mass of a galaxy in its central body
+		float mergerSeparation = 8.0f; // Merger only: distance between the two galaxies, in scale radii
+		float bodyRadius = 0.05f;
+		float gConstant = 0.0001f; // Same default as Universe
+		float timeScale = 1.0f;
+	};
+
+	// Replaces the content of scene with the generated scene file. Returns false if the settings can't be used
+	bool generate(const Settings& settings, std::vector<char>& scene);
+	bool parseModel(const std::string& name, Model& model); // "plummer", "hernquist", "nfw", "disk" or "merger"
+}
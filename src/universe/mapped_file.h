@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+
+// Read-only view of a whole file mapped into memory: pages are read from disk when they are first accessed and
+// can be dropped by the OS under memory pressure, so no copy of the file has to be kept in memory while it is parsed
+class MappedFile
+{
+private:
+	const char* data;
+	size_t size;
+
+#ifdef _WIN32
+	void* fileHandle;
+	void* mappingHandle;
+#endif
+
+public:
+	MappedFile();
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	// Returns false if the file can't be mapped (missing, empty or not a regular file), in which case it has to be read normally
+	bool open(const char* filePath);
+	void close();
+
+	const char* getData();
+	size_t getSize();
+};
@@ -1,6 +1,10 @@
 #include "mass_body.h"
+#include <atomic>
+
+std::atomic<unsigned int> nextBodyId(1); // 0 is never a body
 
 MassBody::MassBody(glm::vec3 position, float mass, float radius, Color color) {
+	this->id = nextBodyId++;
 	this->position = position;
 	this->mass = mass;
 	this->radius = radius;
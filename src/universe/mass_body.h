@@ -6,6 +6,7 @@
 
 struct MassBody
 {
+	unsigned int id; // Never reused, unlike the address of a deleted body. Copies keep the id of their original
 	glm::vec3 position;
 	glm::vec3 velocity;
 	Color color;
@@ -15,8 +16,6 @@ struct MassBody
 	bool affectedByGravity;
 	bool affectsOthers;
 
-	std::vector<MassBody*> occluders;
-
-	MassBody(glm::vec3 position, float mass, float radius, Color color);
+	MassBody(glm::vec3 position, float mass, float radius, Color color); // Gives the body a new id
 };
 
@@ -0,0 +1,377 @@
+#include "playback.h"
+#include "mapped_file.h"
+#include "frame_codec.h"
+
+#include <iostream>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <algorithm>
+
+namespace playback {
+	struct FrameInfo {
+		uint64_t tick;
+		uint64_t offset; // Position of the FrameHeader in the file
+		bool keyframe;
+	};
+
+	struct CachedFrame {
+		long long frameIndex = -1; // -1 when the slot is free
+		bool valid = false; // False if the frame couldn't be decoded
+		recording::Frame frame;
+	};
+
+	MappedFile file;
+	recording::FileHeader fileHeader;
+	std::vector<FrameInfo> frames;
+	bool opened = false;
+
+	double playhead = 0.0; // Tick of the recording being shown (between two frames most of the time)
+	bool paused = false;
+	float speed = 1.0f;
+	std::vector<MassBody> proxies; // One per recorded body, only used for the ids of the snapshot bodies
+
+	std::thread decoderThread;
+	std::mutex cacheMutex;
+	std::condition_variable decoderCondition;
+	bool stopping = false;
+	size_t wantedFrame = 0; // Frame at the playhead, the decoder keeps the PLAYBACK_DECODE_AHEAD frames from this one decoded
+	CachedFrame cache[PLAYBACK_CACHE_SIZE];
+
+	// Only accessed by the decoder thread
+	std::unique_ptr<recording::FrameDecoder> decoder;
+	recording::Frame decodingFrame;
+	long long lastDecodedFrame = -1;
+
+	static bool readFrameHeader(uint64_t offset, recording::FrameHeader& header) {
+		if (offset + sizeof(header) > file.getSize()) return false;
+		memcpy(&header, file.getData() + offset, sizeof(header));
+
+		return memcmp(header.id, RECORDING_FRAME_ID, 4) == 0 && header.dataSize <= file.getSize() - offset - sizeof(header);
+	}
+
+	// Uses the index at the end of the file, or walks through the frames if the recording wasn't stopped properly
+	static void findFrames() {
+		const char* data = file.getData();
+		size_t size = file.getSize();
+
+		std::vector<uint64_t> offsets;
+		recording::Footer footer;
+		if (size >= sizeof(recording::FileHeader) + sizeof(footer)) {
+			memcpy(&footer, data + size - sizeof(footer), sizeof(footer));
+
+			uint64_t indexSize = 4 + (uint64_t)footer.frameCount * sizeof(recording::IndexEntry);
+			if (memcmp(footer.magic, RECORDING_FOOTER_MAGIC, 4) == 0 && footer.indexOffset + indexSize + sizeof(footer) == size && memcmp(data + footer.indexOffset, RECORDING_INDEX_ID, 4) == 0) {
+				for (uint32_t i = 0; i < footer.frameCount; i++) {
+					recording::IndexEntry entry;
+					memcpy(&entry, data + footer.indexOffset + 4 + i * sizeof(entry), sizeof(entry));
+					offsets.push_back(entry.offset);
+				}
+			}
+		}
+
+		if (offsets.empty()) {
+			recording::FrameHeader header;
+			for (uint64_t offset = sizeof(recording::FileHeader); readFrameHeader(offset, header); offset += sizeof(header) + header.dataSize) {
+				offsets.push_back(offset);
+			}
+		}
+
+		for (uint64_t offset : offsets) {
+			recording::FrameHeader header;
+			if (!readFrameHeader(offset, header) || header.frameIndex != frames.size()) break;
+
+			frames.push_back({ header.tick, offset, (header.flags & RECORDING_FRAME_KEYFRAME) != 0 });
+			while (proxies.size() < header.bodyCount) proxies.push_back(MassBody(glm::vec3(0), 1.0f, 1.0f, Color())); // Each with its own id
+		}
+	}
+
+	// Decodes the frame into decodingFrame, decoding the frames it depends on first
+	static bool decodeFrame(size_t frameIndex) {
+		size_t firstFrame = frameIndex;
+		if ((long long)frameIndex != lastDecodedFrame + 1) {
+			while (firstFrame > 0 && !frames[firstFrame].keyframe) firstFrame--;
+			if (lastDecodedFrame >= (long long)firstFrame && lastDecodedFrame < (long long)frameIndex) firstFrame = lastDecodedFrame + 1;
+		}
+
+		for (size_t i = firstFrame; i <= frameIndex; i++) {
+			recording::FrameHeader header;
+			readFrameHeader(frames[i].offset, header);
+
+			if (!decoder->decode(header, file.getData() + frames[i].offset + sizeof(header), decodingFrame)) {
+				lastDecodedFrame = -1;
+				decoder->reset();
+				return false;
+			}
+			lastDecodedFrame = i;
+		}
+
+		return true;
+	}
+
+	static CachedFrame* findCachedFrame(size_t frameIndex) {
+		for (CachedFrame& cachedFrame : cache) {
+			if (cachedFrame.frameIndex == (long long)frameIndex) return &cachedFrame;
+		}
+
+		return nullptr;
+	}
+
+	static void runDecoder() {
+		std::unique_lock<std::mutex> lock(cacheMutex);
+
+		while (!stopping) {
+			size_t windowEnd = std::min(wantedFrame + PLAYBACK_DECODE_AHEAD, frames.size());
+
+			long long nextFrame = -1;
+			for (size_t i = wantedFrame; i < windowEnd; i++) {
+				if (findCachedFrame(i) == nullptr) {
+					nextFrame = i;
+					break;
+				}
+			}
+
+			if (nextFrame < 0) {
+				decoderCondition.wait(lock);
+				continue;
+			}
+
+			// The cache can be read while decoding
+			lock.unlock();
+			bool valid = decodeFrame(nextFrame);
+			lock.lock();
+
+			// The playhead may have moved away meanwhile
+			windowEnd = std::min(wantedFrame + PLAYBACK_DECODE_AHEAD, frames.size());
+			if ((size_t)nextFrame < wantedFrame || (size_t)nextFrame >= windowEnd) continue;
+
+			// There is always a slot outside of the window, since the cache is larger than it
+			for (CachedFrame& cachedFrame : cache) {
+				if (cachedFrame.frameIndex >= (long long)wantedFrame && cachedFrame.frameIndex < (long long)windowEnd) continue;
+
+				cachedFrame.frameIndex = nextFrame;
+				cachedFrame.valid = valid;
+				std::swap(cachedFrame.frame, decodingFrame);
+				break;
+			}
+		}
+	}
+
+	bool open(const std::string& filePath) {
+		close();
+
+		if (!file.open(filePath.c_str())) {
+			std::cout << "[ERROR] Could not open the recording '" << filePath << "'." << std::endl;
+			return false;
+		}
+
+		if (file.getSize() < sizeof(fileHeader)) {
+			std::cout << "[ERROR] '" << filePath << "' is not a recording." << std::endl;
+			file.close();
+			return false;
+		}
+		memcpy(&fileHeader, file.getData(), sizeof(fileHeader));
+
+		if (memcmp(fileHeader.magic, RECORDING_MAGIC, 4) != 0 || fileHeader.tickRate == 0) {
+			std::cout << "[ERROR] '" << filePath << "' is not a recording." << std::endl;
+			file.close();
+			return false;
+		}
+		if (fileHeader.version != RECORDING_VERSION || fileHeader.encoding > RECORDING_ENCODING_QUANTIZED) {
+			std::cout << "[ERROR] The recording '" << filePath << "' was made by an unsupported version (" << fileHeader.version << ")." << std::endl;
+			file.close();
+			return false;
+		}
+
+		findFrames();
+		if (frames.empty()) {
+			std::cout << "[ERROR] The recording '" << filePath << "' has no frames." << std::endl;
+			file.close();
+			return false;
+		}
+
+		playhead = (double)frames[0].tick;
+		paused = false;
+		speed = 1.0f;
+
+		wantedFrame = 0;
+		stopping = false;
+		decoder.reset(new recording::FrameDecoder(fileHeader.encoding));
+		lastDecodedFrame = -1;
+		decoderThread = std::thread(runDecoder);
+		opened = true;
+
+		std::cout << "Playing '" << filePath << "' back (" << frames.size() << " frames, " << getDuration() << " s)." << std::endl;
+		return true;
+	}
+
+	void close() {
+		if (!opened) return;
+		opened = false;
+
+		{
+			std::lock_guard<std::mutex> lock(cacheMutex);
+			stopping = true;
+		}
+		decoderCondition.notify_one();
+		decoderThread.join();
+
+		for (CachedFrame& cachedFrame : cache) {
+			cachedFrame.frameIndex = -1;
+		}
+		decoder.reset();
+		frames.clear();
+		proxies.clear();
+		file.close();
+	}
+
+	bool isOpen() {
+		return opened;
+	}
+
+	void advance(double seconds) {
+		if (!opened || paused) return;
+
+		playhead += seconds * fileHeader.tickRate * speed;
+
+		double lastTick = (double)frames.back().tick;
+		if (playhead >= lastTick) {
+			playhead = lastTick;
+			paused = true;
+		}
+		else if (playhead < frames[0].tick) {
+			playhead = (double)frames[0].tick;
+			paused = true;
+		}
+	}
+
+	void seek(double time) {
+		if (!opened) return;
+		playhead = std::min(std::max(frames[0].tick + time * fileHeader.tickRate, (double)frames[0].tick), (double)frames.back().tick);
+	}
+
+	void setPaused(bool paused) {
+		if (!paused && opened && playhead >= frames.back().tick) seek(0.0);
+		playback::paused = paused;
+	}
+
+	void setSpeed(float speed) {
+		playback::speed = speed;
+	}
+
+	bool isPaused() {
+		return paused;
+	}
+
+	double getTime() {
+		return opened ? (playhead - frames[0].tick) / fileHeader.tickRate : 0.0;
+	}
+
+	double getDuration() {
+		return opened ? (double)(frames.back().tick - frames[0].tick) / fileHeader.tickRate : 0.0;
+	}
+
+	// Moves the playhead (in the direction it is going) out of the frames between the two keyframes around a frame that couldn't be decoded,
+	// since the ones after it depend on it. Closes the recording if nothing can be played in that direction anymore
+	static void skipInvalidFrame(size_t frameIndex) {
+		if (speed >= 0) {
+			size_t nextKeyframe = frameIndex + 1;
+			while (nextKeyframe < frames.size() && !frames[nextKeyframe].keyframe) nextKeyframe++;
+
+			if (nextKeyframe < frames.size()) {
+				std::cout << "[WARNING] Frame " << frameIndex << " of the recording couldn't be decoded, skipping to frame " << nextKeyframe << "." << std::endl;
+				playhead = (double)frames[nextKeyframe].tick;
+				return;
+			}
+		}
+		else {
+			size_t keyframe = frameIndex;
+			while (keyframe > 0 && !frames[keyframe].keyframe) keyframe--;
+
+			if (keyframe > 0) {
+				std::cout << "[WARNING] Frame " << frameIndex << " of the recording couldn't be decoded, skipping to frame " << keyframe - 1 << "." << std::endl;
+				playhead = (double)frames[keyframe - 1].tick;
+				return;
+			}
+		}
+
+		std::cout << "[ERROR] Frame " << frameIndex << " of the recording couldn't be decoded and there is nothing left to play after it, the playback is stopped." << std::endl;
+		close();
+	}
+
+	bool fillSnapshot(simulation::Snapshot& snapshot) {
+		if (!opened) return false;
+
+		// Last frame at or before the playhead
+		size_t frameIndex = std::upper_bound(frames.begin(), frames.end(), playhead, [](double tick, const FrameInfo& frame) { return tick < frame.tick; }) - frames.begin();
+		frameIndex = frameIndex > 0 ? frameIndex - 1 : 0;
+
+		std::unique_lock<std::mutex> lock(cacheMutex);
+		if (wantedFrame != frameIndex) {
+			wantedFrame = frameIndex;
+			decoderCondition.notify_one();
+		}
+
+		CachedFrame* cachedFrame = findCachedFrame(frameIndex);
+		if (cachedFrame == nullptr) return false;
+		if (!cachedFrame->valid) {
+			lock.unlock(); // Closing the recording waits for the decoder thread
+			skipInvalidFrame(frameIndex);
+			return false;
+		}
+
+		const recording::Frame& frame = cachedFrame->frame;
+		size_t bodyCount = frame.getBodyCount();
+
+		// The next frame is only used if it is ready and has the same bodies
+		CachedFrame* nextCachedFrame = findCachedFrame(frameIndex + 1);
+		const recording::Frame* nextFrame = nextCachedFrame != nullptr && nextCachedFrame->valid ? &nextCachedFrame->frame : nullptr;
+		if (nextFrame != nullptr && (nextFrame->getBodyCount() != bodyCount || nextFrame->tick <= frame.tick)) nextFrame = nullptr;
+
+		snapshot.bodies.clear();
+
+		if (nextFrame == nullptr) {
+			for (size_t i = 0; i < bodyCount; i++) {
+				MassBody body = proxies[i];
+				body.position = frame.positions[i];
+				body.velocity = frame.velocities[i];
+				body.mass = frame.masses[i];
+				body.radius = frame.radii[i];
+				body.color = Color(frame.colors[i]);
+
+				snapshot.bodies.push_back(body);
+			}
+		}
+		else {
+			// Cubic Hermite curve between the two frames: it starts and ends with the recorded velocities, so orbits stay round between frames
+			float t = (float)((playhead - frame.tick) / (nextFrame->tick - frame.tick));
+			float simulatedDuration = (float)(nextFrame->tick - frame.tick) / fileHeader.tickRate * frame.timeScale;
+
+			float t2 = t * t, t3 = t2 * t;
+			float startWeight = 2 * t3 - 3 * t2 + 1;
+			float startVelocityWeight = (t3 - 2 * t2 + t) * simulatedDuration;
+			float endWeight = -2 * t3 + 3 * t2;
+			float endVelocityWeight = (t3 - t2) * simulatedDuration;
+
+			for (size_t i = 0; i < bodyCount; i++) {
+				MassBody body = proxies[i];
+				body.position = frame.positions[i] * startWeight + frame.velocities[i] * startVelocityWeight + nextFrame->positions[i] * endWeight + nextFrame->velocities[i] * endVelocityWeight;
+				body.velocity = frame.velocities[i] + (nextFrame->velocities[i] - frame.velocities[i]) * t;
+				body.mass = frame.masses[i];
+				body.radius = frame.radii[i];
+				body.color = Color(frame.colors[i]);
+
+				snapshot.bodies.push_back(body);
+			}
+		}
+
+		// The light stays on the first body if the emissive one wasn't recorded
+		snapshot.emissiveBodyIndex = frame.emissiveBodyIndex >= 0 && (size_t)frame.emissiveBodyIndex < bodyCount ? frame.emissiveBodyIndex : (bodyCount > 0 ? 0 : -1);
+		snapshot.timeScale = frame.timeScale;
+		snapshot.tick = (unsigned long long)playhead;
+
+		return true;
+	}
+}
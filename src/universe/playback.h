@@ -0,0 +1,33 @@
+#pragma once
+
+#include <string>
+
+#include "simulation.h"
+
+#define PLAYBACK_DECODE_AHEAD 8 // Frames kept decoded from the one at the playhead onwards
+#define PLAYBACK_CACHE_SIZE (PLAYBACK_DECODE_AHEAD + 2) // Room for the frames ahead, plus one being replaced after a seek
+
+// Plays a recording (see recording.h) back in place of the simulation: while a recording is open, the simulation thread publishes
+// its frames instead of ticking the universe. Frames are decoded on a background thread ahead of the playhead, and the bodies are
+// interpolated between the two frames around it so that slow motion stays smooth.
+// Every function is meant to be called from the simulation thread
+namespace playback {
+	// Closes the current recording, if there is one
+	bool open(const std::string& filePath);
+	void close();
+	bool isOpen();
+
+	// Moves the playhead by the given real time multiplied by the speed, unless it is paused. Pauses at the end of the recording
+	void advance(double seconds);
+	void seek(double time); // Seconds since the first frame
+	void setPaused(bool paused); // Resuming at the end of the recording starts it over
+	void setSpeed(float speed);
+	bool isPaused();
+	double getTime();
+	double getDuration();
+
+	// Fills the bodies of the snapshot with the state of the recording at the playhead.
+	// Returns false, without touching the snapshot, while the frame at the playhead is still being decoded (e.g. right after a seek).
+	// A frame that can't be decoded is skipped, and the recording is closed if there is no frame to skip to
+	bool fillSnapshot(simulation::Snapshot& snapshot);
+}
@@ -0,0 +1,214 @@
+#include "recorder.h"
+#include "simulation.h"
+
+#include <iostream>
+#include <fstream>
+#include <cstring>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+
+namespace recorder {
+	bool recording = false;
+	Settings settings;
+	std::ofstream file;
+
+	std::thread writerThread;
+	std::mutex queueMutex;
+	std::condition_variable queueCondition;
+	std::deque<recording::Frame*> queuedFrames; // Captured, waiting to be written
+	std::vector<recording::Frame*> freeFrames; // Written, ready to be reused by the next captures
+	bool stopping = false;
+
+	// Only accessed by the writer thread while recording
+	std::unique_ptr<recording::FrameEncoder> encoder;
+	std::vector<recording::IndexEntry> frameIndex;
+	std::vector<char> encodedFrame;
+	uint64_t fileOffset = 0;
+
+	unsigned int droppedFrameCount = 0;
+	std::atomic<bool> writeFailed(false); // Set by the writer thread, the recording is then stopped by the next capture
+
+	void writeFrame(const recording::Frame& frame) {
+		if (writeFailed) return;
+
+		encodedFrame.clear();
+		uint32_t flags = encoder->encode(frame, encodedFrame);
+
+		recording::FrameHeader header = {};
+		memcpy(header.id, RECORDING_FRAME_ID, 4);
+		header.frameIndex = (uint32_t)frameIndex.size();
+		header.tick = frame.tick;
+		header.bodyCount = (uint32_t)frame.getBodyCount();
+		header.emissiveBodyIndex = frame.emissiveBodyIndex;
+		header.dataSize = encodedFrame.size();
+		header.flags = flags;
+		header.timeScale = frame.timeScale;
+
+		file.write((const char*)&header, sizeof(header));
+		file.write(encodedFrame.data(), encodedFrame.size());
+		if (!file.good()) {
+			std::cout << "[ERROR] Could not write to the recording file (is the disk full?), the recording is stopped." << std::endl;
+			writeFailed = true;
+			return;
+		}
+
+		frameIndex.push_back({ frame.tick, fileOffset });
+		fileOffset += sizeof(header) + encodedFrame.size();
+	}
+
+	void runWriter() {
+		std::unique_lock<std::mutex> lock(queueMutex);
+
+		while (true) {
+			queueCondition.wait(lock, []() { return stopping || !queuedFrames.empty(); });
+			if (queuedFrames.empty()) break; // Stopping, and everything was written
+
+			recording::Frame* frame = queuedFrames.front();
+			queuedFrames.pop_front();
+
+			// The disk is only accessed without the lock, so captures never wait for it
+			lock.unlock();
+			writeFrame(*frame);
+			lock.lock();
+
+			freeFrames.push_back(frame);
+		}
+	}
+
+	bool start(const std::string& filePath, Settings newSettings) {
+		stop();
+
+		file.open(filePath, std::ios::binary | std::ios::trunc);
+		if (!file.is_open()) {
+			std::cout << "[ERROR] Could not create the recording file '" << filePath << "'." << std::endl;
+			return false;
+		}
+
+		settings = newSettings;
+		if (settings.tickInterval == 0) settings.tickInterval = 1;
+		if (settings.bodyStride == 0) settings.bodyStride = 1;
+
+		recording::FileHeader header = {};
+		memcpy(header.magic, RECORDING_MAGIC, 4);
+		header.version = RECORDING_VERSION;
+		header.tickRate = SIMULATION_TICK_RATE;
+		header.tickInterval = settings.tickInterval;
+		header.bodyStride = settings.bodyStride;
+		header.encoding = settings.encoding;
+		file.write((const char*)&header, sizeof(header));
+		if (!file.good()) {
+			std::cout << "[ERROR] Could not write to the recording file '" << filePath << "'." << std::endl;
+			file.close();
+			return false;
+		}
+
+		fileOffset = sizeof(header);
+		encoder.reset(new recording::FrameEncoder(settings.encoding, settings.positionBits, settings.velocityBits));
+		frameIndex.clear();
+		droppedFrameCount = 0;
+		writeFailed = false;
+		stopping = false;
+
+		for (unsigned int i = freeFrames.size(); i < RECORDER_QUEUE_SIZE; i++) {
+			freeFrames.push_back(new recording::Frame());
+		}
+
+		writerThread = std::thread(runWriter);
+		recording = true;
+
+		std::cout << "Recording to '" << filePath << "'." << std::endl;
+		return true;
+	}
+
+	void capture(Universe* universe, unsigned long long tick) {
+		if (!recording || tick % settings.tickInterval != 0) return;
+		if (writeFailed) {
+			stop();
+			return;
+		}
+
+		recording::Frame* frame;
+		{
+			std::lock_guard<std::mutex> lock(queueMutex);
+			if (freeFrames.empty()) {
+				droppedFrameCount++;
+				return;
+			}
+
+			frame = freeFrames.back();
+			freeFrames.pop_back();
+		}
+
+		const std::vector<MassBody*>& bodies = *universe->GetBodies();
+		size_t recordedCount = (bodies.size() + settings.bodyStride - 1) / settings.bodyStride;
+
+		frame->tick = tick;
+		frame->timeScale = universe->timeScale;
+		frame->resize(recordedCount);
+
+		unsigned int emissiveBodyIndex = universe->GetEmissiveBodyIndex();
+		frame->emissiveBodyIndex = emissiveBodyIndex % settings.bodyStride == 0 ? emissiveBodyIndex / settings.bodyStride : -1;
+
+		for (size_t i = 0; i < recordedCount; i++) {
+			const MassBody& body = *bodies[i * settings.bodyStride];
+			frame->positions[i] = body.position;
+			frame->velocities[i] = body.velocity;
+			frame->masses[i] = body.mass;
+			frame->radii[i] = body.radius;
+			frame->colors[i] = (uint32_t)body.color.toHex();
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(queueMutex);
+			queuedFrames.push_back(frame);
+		}
+		queueCondition.notify_one();
+	}
+
+	void stop() {
+		if (!recording) return;
+		recording = false;
+
+		{
+			std::lock_guard<std::mutex> lock(queueMutex);
+			stopping = true;
+		}
+		queueCondition.notify_one();
+		writerThread.join();
+		encoder.reset();
+
+		// The frames before the failed write can still be played back, they are found by walking through them
+		if (writeFailed) {
+			file.close();
+			std::cout << "Recording stopped after a write error (" << frameIndex.size() << " frames)." << std::endl;
+			return;
+		}
+
+		// Index of the frames, then the footer that points to it
+		uint64_t indexOffset = fileOffset;
+		file.write(RECORDING_INDEX_ID, 4);
+		file.write((const char*)frameIndex.data(), frameIndex.size() * sizeof(recording::IndexEntry));
+
+		recording::Footer footer = {};
+		memcpy(footer.magic, RECORDING_FOOTER_MAGIC, 4);
+		footer.frameCount = (uint32_t)frameIndex.size();
+		footer.indexOffset = indexOffset;
+		file.write((const char*)&footer, sizeof(footer));
+		if (!file.good()) std::cout << "[ERROR] Could not write the index of the recording, it will be slower to open." << std::endl;
+
+		file.close();
+
+		std::cout << "Recording stopped (" << frameIndex.size() << " frames)." << std::endl;
+		if (droppedFrameCount > 0) {
+			std::cout << "[WARNING] " << droppedFrameCount << " frames were dropped because the disk couldn't keep up." << std::endl;
+		}
+	}
+
+	bool isRecording() {
+		return recording;
+	}
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+
+#include "universe.h"
+#include "frame_codec.h"
+
+#define RECORDER_QUEUE_SIZE 16 // Frames that can wait to be written; when the disk can't keep up, new frames are dropped instead of slowing the simulation down
+#define RECORDER_DEFAULT_TICK_INTERVAL 8 // Ticks between two recorded frames (30 frames per second at the default tick rate)
+
+// Records the simulation into a recording file (see recording.h). Every function is meant to be called from the simulation thread,
+// the encoding and the writing happen on background threads
+namespace recorder {
+	struct Settings {
+		unsigned int tickInterval = RECORDER_DEFAULT_TICK_INTERVAL;
+		unsigned int bodyStride = 1; // Record every bodyStride-th body only
+		uint32_t encoding = RECORDING_ENCODING_QUANTIZED;
+		uint32_t positionBits = RECORDING_DEFAULT_POSITION_BITS; // RECORDING_ENCODING_QUANTIZED only
+		uint32_t velocityBits = RECORDING_DEFAULT_VELOCITY_BITS;
+	};
+
+	// Stops the current recording, if there is one
+	bool start(const std::string& filePath, Settings settings);
+	// Copies the recorded bodies if a frame is due at this tick. Never waits for the disk
+	void capture(Universe* universe, unsigned long long tick);
+	// Writes the frames that are still queued and the frame index, then closes the file
+	void stop();
+	bool isRecording();
+}
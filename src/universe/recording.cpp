@@ -0,0 +1,146 @@
+#include "recording.h"
+
+#include <cstring>
+
+static_assert(sizeof(recording::FileHeader) == 32, "Recording headers must keep their size");
+static_assert(sizeof(recording::FrameHeader) == 40, "Recording headers must keep their size");
+static_assert(sizeof(recording::Footer) == 16, "Recording headers must keep their size");
+
+namespace recording {
+	size_t Frame::getBodyCount() const {
+		return positions.size();
+	}
+
+	void Frame::resize(size_t bodyCount) {
+		positions.resize(bodyCount);
+		velocities.resize(bodyCount);
+		masses.resize(bodyCount);
+		radii.resize(bodyCount);
+		colors.resize(bodyCount);
+	}
+
+	static void append(std::vector<char>& output, const void* data, size_t size) {
+		size_t offset = output.size();
+		output.resize(offset + size);
+		memcpy(output.data() + offset, data, size);
+	}
+
+	static void appendHalfs(std::vector<char>& output, const std::vector<glm::vec3>& vectors) {
+		size_t offset = output.size();
+		output.resize(offset + vectors.size() * 3 * sizeof(uint16_t));
+
+		uint16_t* halfs = (uint16_t*)(output.data() + offset);
+		for (size_t i = 0; i < vectors.size(); i++) {
+			halfs[i * 3 + 0] = floatToHalf(vectors[i].x);
+			halfs[i * 3 + 1] = floatToHalf(vectors[i].y);
+			halfs[i * 3 + 2] = floatToHalf(vectors[i].z);
+		}
+	}
+
+	static void readHalfs(const char* data, std::vector<glm::vec3>& vectors) {
+		for (size_t i = 0; i < vectors.size(); i++) {
+			uint16_t halfs[3];
+			memcpy(halfs, data + i * 3 * sizeof(uint16_t), sizeof(halfs));
+			vectors[i] = glm::vec3(halfToFloat(halfs[0]), halfToFloat(halfs[1]), halfToFloat(halfs[2]));
+		}
+	}
+
+	void encodeFrame(const Frame& frame, uint32_t encoding, std::vector<char>& output) {
+		size_t bodyCount = frame.getBodyCount();
+
+		if (encoding == RECORDING_ENCODING_FLOAT16) {
+			appendHalfs(output, frame.positions);
+			appendHalfs(output, frame.velocities);
+		}
+		else {
+			append(output, frame.positions.data(), bodyCount * sizeof(glm::vec3));
+			append(output, frame.velocities.data(), bodyCount * sizeof(glm::vec3));
+		}
+
+		append(output, frame.masses.data(), bodyCount * sizeof(float));
+		append(output, frame.radii.data(), bodyCount * sizeof(float));
+		append(output, frame.colors.data(), bodyCount * sizeof(uint32_t));
+	}
+
+	bool decodeFrame(const char* data, size_t size, uint32_t encoding, uint32_t bodyCount, Frame& frame) {
+		size_t vectorSize = encoding == RECORDING_ENCODING_FLOAT16 ? 3 * sizeof(uint16_t) : sizeof(glm::vec3);
+		if (size < bodyCount * (2 * vectorSize + 2 * sizeof(float) + sizeof(uint32_t))) return false;
+
+		frame.resize(bodyCount);
+
+		if (encoding == RECORDING_ENCODING_FLOAT16) {
+			readHalfs(data, frame.positions);
+			readHalfs(data + bodyCount * vectorSize, frame.velocities);
+		}
+		else {
+			memcpy(frame.positions.data(), data, bodyCount * vectorSize);
+			memcpy(frame.velocities.data(), data + bodyCount * vectorSize, bodyCount * vectorSize);
+		}
+		data += bodyCount * vectorSize * 2;
+
+		memcpy(frame.masses.data(), data, bodyCount * sizeof(float));
+		memcpy(frame.radii.data(), data + bodyCount * sizeof(float), bodyCount * sizeof(float));
+		memcpy(frame.colors.data(), data + bodyCount * sizeof(float) * 2, bodyCount * sizeof(uint32_t));
+
+		return true;
+	}
+
+	// IEEE 754 half precision, rounded to the nearest value (overflows become infinity)
+	uint16_t floatToHalf(float value) {
+		uint32_t bits;
+		memcpy(&bits, &value, sizeof(bits));
+
+		uint16_t sign = (bits >> 16) & 0x8000;
+		int32_t exponent = ((bits >> 23) & 0xFF) - 127 + 15;
+		uint32_t mantissa = bits & 0x7FFFFF;
+
+		if (((bits >> 23) & 0xFF) == 0xFF) return sign | 0x7C00 | (mantissa ? 0x200 : 0); // Infinity or NaN
+		if (exponent >= 31) return sign | 0x7C00;
+		if (exponent <= 0) {
+			if (exponent < -10) return sign; // Too small, even for a subnormal half
+
+			// Subnormal half
+			mantissa |= 0x800000;
+			uint32_t shift = 14 - exponent;
+			uint16_t half = (uint16_t)(mantissa >> shift);
+			if ((mantissa >> (shift - 1)) & 1) half++;
+			return sign | half;
+		}
+
+		uint16_t half = sign | (uint16_t)(exponent << 10) | (uint16_t)(mantissa >> 13);
+		if (mantissa & 0x1000) half++; // Round (a carry into the exponent is still the right value)
+		return half;
+	}
+
+	float halfToFloat(uint16_t value) {
+		uint32_t sign = (uint32_t)(value & 0x8000) << 16;
+		uint32_t exponent = (value >> 10) & 0x1F;
+		uint32_t mantissa = value & 0x3FF;
+		uint32_t bits;
+
+		if (exponent == 0) {
+			if (mantissa == 0) {
+				bits = sign;
+			}
+			else {
+				// Subnormal half, normalized for the float
+				exponent = 127 - 15 + 1;
+				while ((mantissa & 0x400) == 0) {
+					mantissa <<= 1;
+					exponent--;
+				}
+				bits = sign | (exponent << 23) | ((mantissa & 0x3FF) << 13);
+			}
+		}
+		else if (exponent == 31) {
+			bits = sign | 0x7F800000 | (mantissa << 13);
+		}
+		else {
+			bits = sign | ((exponent - 15 + 127) << 23) | (mantissa << 13);
+		}
+
+		float result;
+		memcpy(&result, &bits, sizeof(result));
+		return result;
+	}
+}
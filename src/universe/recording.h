@@ -0,0 +1,82 @@
+#pragma once
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Recording files store the state of the bodies every few ticks of a simulation run:
+// a FileHeader, then one FrameHeader + encoded frame per recorded tick, then (once the recording is stopped) an index of the frames and a Footer.
+// A recording that wasn't stopped properly has no index, but its frames can still be found by walking through them.
+
+#define RECORDING_MAGIC "GREC"
+#define RECORDING_VERSION 3
+#define RECORDING_FRAME_ID "FRAM"
+#define RECORDING_INDEX_ID "INDX"
+#define RECORDING_FOOTER_MAGIC "GEND"
+
+// How the bodies of a frame are stored (always as one array per property)
+#define RECORDING_ENCODING_FLOAT32 0 // Positions and velocities as floats
+#define RECORDING_ENCODING_FLOAT16 1 // Positions and velocities as half floats (half the size, about 3 significant digits)
+#define RECORDING_ENCODING_QUANTIZED 2 // Compressed, see frame_codec.h
+
+#define RECORDING_FRAME_KEYFRAME 1 // The frame can be decoded on its own (otherwise the previous frame must have been decoded first)
+
+namespace recording {
+	struct FileHeader {
+		char magic[4];
+		uint32_t version;
+		uint32_t tickRate; // Ticks per second of the simulation that was recorded
+		uint32_t tickInterval; // Ticks between two frames
+		uint32_t bodyStride; // Only every bodyStride-th body is recorded
+		uint32_t encoding; // RECORDING_ENCODING_*
+		uint32_t reserved[2];
+	};
+
+	struct FrameHeader {
+		char id[4];
+		uint32_t frameIndex;
+		uint64_t tick;
+		uint32_t bodyCount;
+		int32_t emissiveBodyIndex; // Index among the recorded bodies, -1 if the emissive body wasn't recorded
+		uint32_t flags; // RECORDING_FRAME_*
+		float timeScale; // Simulated seconds per real second when the frame was recorded (velocities are in simulated time)
+		uint64_t dataSize; // Size of the encoded frame following this header
+	};
+
+	struct IndexEntry {
+		uint64_t tick;
+		uint64_t offset; // Position of the FrameHeader in the file
+	};
+
+	// Written at the very end of the file, so that the index can be found without reading the frames
+	struct Footer {
+		char magic[4];
+		uint32_t frameCount;
+		uint64_t indexOffset; // Position of the index (RECORDING_INDEX_ID followed by frameCount IndexEntry)
+	};
+
+	// Recorded bodies of one tick, one array per property
+	struct Frame {
+		uint64_t tick = 0;
+		int32_t emissiveBodyIndex = -1;
+		float timeScale = 1.0f;
+
+		std::vector<glm::vec3> positions;
+		std::vector<glm::vec3> velocities;
+		std::vector<float> masses;
+		std::vector<float> radii;
+		std::vector<uint32_t> colors; // 0xRRGGBB
+
+		size_t getBodyCount() const;
+		void resize(size_t bodyCount);
+	};
+
+	// Appends the encoded bodies of the frame to output (uncompressed encodings only, every frame is a keyframe)
+	void encodeFrame(const Frame& frame, uint32_t encoding, std::vector<char>& output);
+	// Returns false if the data is too short for the given body count
+	bool decodeFrame(const char* data, size_t size, uint32_t encoding, uint32_t bodyCount, Frame& frame);
+
+	uint16_t floatToHalf(float value);
+	float halfToFloat(uint16_t value);
+}
@@ -1,34 +1,39 @@
 #include "scene_loader.h"
+#include "mapped_file.h"
+
 #include <iostream>
+#include <cstring>
+#include <vector>
 
-#define BODY_CHUNK_SIZE 35 // Size of a body in a scene file (in bytes)
+#define BODY_CHUNK_SIZE 35 // Size of a body in a version 1 scene file (in bytes)
+#define READ_CHUNK_SIZE 65536 // Size of the reads made when the scene file can't be mapped (in bytes)
 
-Universe* loadScene(const char* filePath) {
-	std::ifstream infile(filePath);
+static_assert(sizeof(SceneHeader) == 64, "The scene header must keep its size");
+static_assert(sizeof(SceneSectionHeader) == SCENE_ALIGNMENT, "Section headers must keep the sections aligned");
+static_assert(sizeof(glm::vec3) == 12, "Positions and velocities are copied as 3 packed floats");
 
-	if (!infile.good()) {
-		std::cout << "[ERROR] File '" << filePath << "' does not exist." << std::endl;
+static size_t alignSceneOffset(size_t offset) {
+	return (offset + SCENE_ALIGNMENT - 1) / SCENE_ALIGNMENT * SCENE_ALIGNMENT;
+}
+
+// Version 1: 8 bytes of configuration followed by 35 byte bodies, see "Scenes/Scene File Definition.txt"
+static Universe* parseSceneV1(const char* data, size_t length) {
+	if (length < 8) {
+		std::cout << "[ERROR] Scene file is too short." << std::endl;
 		return nullptr;
 	}
 
-	//get length of file
-	infile.seekg(0, std::ios::end);
-	size_t length = infile.tellg();
-	infile.seekg(0, std::ios::beg);
-
-	char* buffer = new char[length];
-
-	//read file
-	infile.read(buffer, length);
-
 	Universe* universe = new Universe();
 
-	memcpy(&universe->gConstant, buffer, 4);
-	memcpy(&universe->timeScale, buffer+4, 4);
+	memcpy(&universe->gConstant, data, 4);
+	memcpy(&universe->timeScale, data + 4, 4);
+
+	size_t bodyCount = (length - 8) / BODY_CHUNK_SIZE;
+	std::vector<MassBody*> bodies;
+	bodies.reserve(bodyCount);
 
-	int bodyCount = (length - 8) / BODY_CHUNK_SIZE;
-	for (int i = 0; i < bodyCount; i++) {
-		const char * bodyOffset = buffer + 8 + i * BODY_CHUNK_SIZE;
+	for (size_t i = 0; i < bodyCount; i++) {
+		const char * bodyOffset = data + 8 + i * BODY_CHUNK_SIZE;
 
 		unsigned char colR, colG, colB;
 		memcpy(&colR, bodyOffset + 0, 1);
@@ -42,44 +47,337 @@ Universe* loadScene(const char* filePath) {
 		memcpy(&body->radius, bodyOffset + 7, 4);
 		memcpy(&body->position, bodyOffset + 11, 12);
 		memcpy(&body->velocity, bodyOffset + 23, 12);
-		universe->AddBody(body);
+		bodies.push_back(body);
 	}
 
-	delete[] buffer;
+	universe->AddBodies(bodies.data(), bodies.size()); // All at once, so that the universe only grows its storage once
 
 	return universe;
 }
 
-void saveScene(Universe* universe, const char* filePath) {
-	std::ofstream outfile(filePath);
+// Version 2: header followed by one aligned section per body property
+static Universe* parseSceneV2(const char* data, size_t length) {
+	SceneHeader header;
+	if (length < sizeof(SceneHeader)) {
+		std::cout << "[ERROR] Scene file is too short." << std::endl;
+		return nullptr;
+	}
+	memcpy(&header, data, sizeof(SceneHeader));
 
-	int bodyCount = universe->GetBodies()->size();
-	int length = 8 + BODY_CHUNK_SIZE * bodyCount;
-	char* buffer = new char[length];
+	if (header.version > SCENE_VERSION) {
+		std::cout << "[ERROR] Scene file version " << header.version << " is newer than the supported version (" << SCENE_VERSION << ")." << std::endl;
+		return nullptr;
+	}
+	if (header.integrator != SCENE_INTEGRATOR_SEMI_IMPLICIT_EULER) {
+		std::cout << "[WARNING] Unknown integrator " << header.integrator << " in scene file, the default one is used." << std::endl;
+	}
+
+	// Find the sections (unknown ones are skipped, so newer files can add some)
+	const char* positions = nullptr;
+	const char* velocities = nullptr;
+	const char* masses = nullptr;
+	const char* radii = nullptr;
+	const char* colors = nullptr;
+	const char* flags = nullptr;
 
-	memcpy(buffer , &universe->gConstant, 4);
-	memcpy(buffer  + 4, &universe->timeScale, 4);
+	size_t offset = alignSceneOffset(header.headerSize);
+	for (uint32_t i = 0; i < header.sectionCount; i++) {
+		SceneSectionHeader section;
+		if (offset + sizeof(SceneSectionHeader) > length) {
+			std::cout << "[ERROR] Scene file is truncated." << std::endl;
+			return nullptr;
+		}
+		memcpy(&section, data + offset, sizeof(SceneSectionHeader));
+		offset += sizeof(SceneSectionHeader);
 
-	for (int i = 0; i < bodyCount; i++) {
-		char* bodyOffset = buffer + 8 + i * BODY_CHUNK_SIZE;
+		if (section.size > length - offset) {
+			std::cout << "[ERROR] Scene file is truncated." << std::endl;
+			return nullptr;
+		}
 
-		MassBody body = *universe->GetBodies()->at(i);
+		const char** target = nullptr;
+		uint32_t expectedElementSize = 0;
+		switch (section.id) {
+		case SCENE_SECTION_POSITIONS: target = &positions; expectedElementSize = 12; break;
+		case SCENE_SECTION_VELOCITIES: target = &velocities; expectedElementSize = 12; break;
+		case SCENE_SECTION_MASSES: target = &masses; expectedElementSize = 4; break;
+		case SCENE_SECTION_RADII: target = &radii; expectedElementSize = 4; break;
+		case SCENE_SECTION_COLORS: target = &colors; expectedElementSize = 4; break;
+		case SCENE_SECTION_FLAGS: target = &flags; expectedElementSize = 1; break;
+		}
 
-		unsigned char colR = body.color.red * 255;
-		unsigned char colG = body.color.green * 255;
-		unsigned char colB = body.color.blue * 255;
-		memcpy(bodyOffset + 0, &colR, 1);
-		memcpy(bodyOffset + 1, &colG, 1);
-		memcpy(bodyOffset + 2, &colB, 1);
+		if (target != nullptr) {
+			if (section.elementSize != expectedElementSize || section.size < (uint64_t)header.bodyCount * expectedElementSize) {
+				std::cout << "[ERROR] Invalid section in scene file." << std::endl;
+				return nullptr;
+			}
+			*target = data + offset;
+		}
 
-		memcpy(bodyOffset + 3, &body.mass, 4);
-		memcpy(bodyOffset + 7, &body.radius, 4);
-		memcpy(bodyOffset + 11, &body.position, 12);
-		memcpy(bodyOffset + 23, &body.velocity, 12);
+		offset = alignSceneOffset(offset + section.size);
 	}
 
-	outfile.write(buffer, length);
-	outfile.close();
+	if (positions == nullptr || masses == nullptr || radii == nullptr) {
+		std::cout << "[ERROR] Scene file is missing the positions, masses or radii of its bodies." << std::endl;
+		return nullptr;
+	}
+
+	Universe* universe = new Universe();
+	universe->gConstant = header.gConstant;
+	universe->timeScale = header.timeScale;
+
+	std::vector<MassBody*> bodies;
+	bodies.reserve(header.bodyCount);
+
+	for (size_t i = 0; i < header.bodyCount; i++) { // size_t, so that the offsets below can't overflow
+		Color bodyColor = COLOR_WHITE;
+		if (colors != nullptr) {
+			const unsigned char* color = (const unsigned char*)colors + i * 4;
+			bodyColor = Color(color[0] / 255.0f, color[1] / 255.0f, color[2] / 255.0f);
+		}
+
+		MassBody* body = new MassBody(glm::vec3(0), 0, 1, bodyColor);
+		memcpy(&body->position, positions + i * 12, 12);
+		memcpy(&body->mass, masses + i * 4, 4);
+		memcpy(&body->radius, radii + i * 4, 4);
+		if (velocities != nullptr) memcpy(&body->velocity, velocities + i * 12, 12);
+		if (flags != nullptr) {
+			body->affectedByGravity = (flags[i] & SCENE_BODY_AFFECTED_BY_GRAVITY) != 0;
+			body->affectsOthers = (flags[i] & SCENE_BODY_AFFECTS_OTHERS) != 0;
+		}
+
+		bodies.push_back(body);
+	}
+
+	universe->AddBodies(bodies.data(), bodies.size());
+	if (header.emissiveBodyIndex < header.bodyCount) universe->SetEmissiveBody(header.emissiveBodyIndex);
+
+	return universe;
+}
+
+Universe* parseScene(const char* data, size_t length) {
+	if (length >= 4 && memcmp(data, SCENE_MAGIC, 4) == 0) return parseSceneV2(data, length);
+
+	return parseSceneV1(data, length); // Version 1 files start directly with the G-constant
+}
+
+// Appends up to size bytes of the stream to the buffer, one chunk at a time so that a wrong size in the file can't allocate
+// more than what is actually there. Returns false if the stream ended first
+static bool readSceneChunks(std::ifstream& infile, std::vector<char>& buffer, uint64_t size) {
+	while (size > 0) {
+		size_t chunkSize = size < READ_CHUNK_SIZE ? (size_t)size : READ_CHUNK_SIZE;
+		size_t offset = buffer.size();
+		buffer.resize(offset + chunkSize);
+		infile.read(buffer.data() + offset, chunkSize);
+
+		size_t readSize = infile.gcount();
+		if (readSize < chunkSize) {
+			buffer.resize(offset + readSize);
+			return false;
+		}
+		size -= chunkSize;
+	}
+
+	return true;
+}
+
+static bool skipSceneBytes(std::ifstream& infile, uint64_t size) {
+	while (size > 0) {
+		size_t chunkSize = size < READ_CHUNK_SIZE ? (size_t)size : READ_CHUNK_SIZE;
+		infile.ignore(chunkSize);
+		if ((size_t)infile.gcount() < chunkSize) return false;
+		size -= chunkSize;
+	}
+
+	return true;
+}
+
+// Reads a scene from a stream that can't be mapped. Only the sections parseSceneV2 uses are kept, repacked after the header
+static Universe* readScene(std::ifstream& infile) {
+	std::vector<char> buffer;
+	readSceneChunks(infile, buffer, 4);
+
+	if (buffer.size() < 4 || memcmp(buffer.data(), SCENE_MAGIC, 4) != 0) {
+		// Version 1 has no sections, its bodies are read until the end of the file
+		while (readSceneChunks(infile, buffer, READ_CHUNK_SIZE));
+		return parseSceneV1(buffer.data(), buffer.size());
+	}
+
+	if (!readSceneChunks(infile, buffer, sizeof(SceneHeader) - 4)) {
+		std::cout << "[ERROR] Scene file is too short." << std::endl;
+		return nullptr;
+	}
+	SceneHeader header;
+	memcpy(&header, buffer.data(), sizeof(SceneHeader));
+
+	uint64_t position = sizeof(SceneHeader);
+	uint64_t firstSection = alignSceneOffset(header.headerSize);
+	bool complete = firstSection < position || skipSceneBytes(infile, firstSection - position);
+	position = firstSection;
+
+	uint32_t keptSections = 0;
+	for (uint32_t i = 0; i < header.sectionCount && complete; i++) {
+		SceneSectionHeader section;
+		infile.read((char*)&section, sizeof(SceneSectionHeader));
+		if ((size_t)infile.gcount() < sizeof(SceneSectionHeader)) {
+			complete = false;
+			break;
+		}
+		position += sizeof(SceneSectionHeader);
 
-	delete[] buffer;
-}
\ No newline at end of file
+		switch (section.id) {
+		case SCENE_SECTION_POSITIONS:
+		case SCENE_SECTION_VELOCITIES:
+		case SCENE_SECTION_MASSES:
+		case SCENE_SECTION_RADII:
+		case SCENE_SECTION_COLORS:
+		case SCENE_SECTION_FLAGS: {
+			size_t offset = buffer.size();
+			buffer.resize(offset + sizeof(SceneSectionHeader));
+			memcpy(buffer.data() + offset, &section, sizeof(SceneSectionHeader));
+			complete = readSceneChunks(infile, buffer, section.size);
+			buffer.resize(alignSceneOffset(buffer.size()), 0);
+			keptSections++;
+			break;
+		}
+		default:
+			complete = skipSceneBytes(infile, section.size);
+			break;
+		}
+
+		// The padding of the last section may be missing
+		uint64_t nextSection = alignSceneOffset(position + section.size);
+		if (complete && i + 1 < header.sectionCount) complete = skipSceneBytes(infile, nextSection - position - section.size);
+		position = nextSection;
+	}
+
+	if (!complete) {
+		std::cout << "[ERROR] Scene file is truncated." << std::endl;
+		return nullptr;
+	}
+
+	SceneHeader* packedHeader = (SceneHeader*)buffer.data();
+	packedHeader->headerSize = sizeof(SceneHeader);
+	packedHeader->sectionCount = keptSections;
+
+	return parseSceneV2(buffer.data(), buffer.size());
+}
+
+Universe* loadScene(const char* filePath) {
+	// Parse straight from the mapped file: the only copy of the data that is made is the bodies themselves
+	MappedFile mappedFile;
+	if (mappedFile.open(filePath)) {
+		return parseScene(mappedFile.getData(), mappedFile.getSize());
+	}
+
+	// Fallback for files that can't be mapped (e.g. pipes)
+	std::ifstream infile(filePath, std::ios::binary);
+
+	if (!infile.good()) {
+		std::cout << "[ERROR] File '" << filePath << "' does not exist." << std::endl;
+		return nullptr;
+	}
+
+	return readScene(infile);
+}
+
+// Appends a section and pads it so that the next one is aligned
+static void writeSceneSection(std::vector<char>& buffer, uint32_t id, uint32_t elementSize, const void* data, size_t size) {
+	SceneSectionHeader section = { id, elementSize, size };
+
+	size_t offset = buffer.size();
+	buffer.resize(alignSceneOffset(offset + sizeof(SceneSectionHeader) + size), 0);
+	memcpy(buffer.data() + offset, &section, sizeof(SceneSectionHeader));
+	if (size > 0) memcpy(buffer.data() + offset + sizeof(SceneSectionHeader), data, size);
+}
+
+void appendSceneSection(std::vector<char>& buffer, uint32_t id, uint32_t elementSize, const void* data, size_t size) {
+	writeSceneSection(buffer, id, elementSize, data, size);
+
+	SceneHeader* header = (SceneHeader*)buffer.data();
+	header->sectionCount++;
+}
+
+const char* findSceneSection(const char* data, size_t length, uint32_t id, uint64_t& size) {
+	SceneHeader header;
+	if (length < sizeof(SceneHeader) || memcmp(data, SCENE_MAGIC, 4) != 0) return nullptr;
+	memcpy(&header, data, sizeof(SceneHeader));
+
+	size_t offset = alignSceneOffset(header.headerSize);
+	for (uint32_t i = 0; i < header.sectionCount && offset + sizeof(SceneSectionHeader) <= length; i++) {
+		SceneSectionHeader section;
+		memcpy(&section, data + offset, sizeof(SceneSectionHeader));
+		offset += sizeof(SceneSectionHeader);
+
+		if (section.size > length - offset) return nullptr;
+		if (section.id == id) {
+			size = section.size;
+			return data + offset;
+		}
+
+		offset = alignSceneOffset(offset + section.size);
+	}
+
+	return nullptr;
+}
+
+void serializeScene(Universe* universe, std::vector<char>& buffer) {
+	const std::vector<MassBody*>& bodies = *universe->GetBodies();
+	uint32_t bodyCount = bodies.size();
+
+	// Split the bodies into one array per property
+	std::vector<glm::vec3> positions(bodyCount), velocities(bodyCount);
+	std::vector<float> masses(bodyCount), radii(bodyCount);
+	std::vector<unsigned char> colors(bodyCount * 4), flags(bodyCount);
+
+	for (uint32_t i = 0; i < bodyCount; i++) {
+		const MassBody& body = *bodies[i];
+
+		positions[i] = body.position;
+		velocities[i] = body.velocity;
+		masses[i] = body.mass;
+		radii[i] = body.radius;
+
+		colors[i * 4 + 0] = (unsigned char)(body.color.red * 255);
+		colors[i * 4 + 1] = (unsigned char)(body.color.green * 255);
+		colors[i * 4 + 2] = (unsigned char)(body.color.blue * 255);
+		colors[i * 4 + 3] = 255;
+
+		flags[i] = (body.affectedByGravity ? SCENE_BODY_AFFECTED_BY_GRAVITY : 0) | (body.affectsOthers ? SCENE_BODY_AFFECTS_OTHERS : 0);
+	}
+
+	SceneHeader header = {};
+	memcpy(header.magic, SCENE_MAGIC, 4);
+	header.version = SCENE_VERSION;
+	header.headerSize = sizeof(SceneHeader);
+	header.bodyCount = bodyCount;
+	header.emissiveBodyIndex = universe->GetEmissiveBodyIndex();
+	header.gConstant = universe->gConstant;
+	header.timeScale = universe->timeScale;
+	header.integrator = SCENE_INTEGRATOR_SEMI_IMPLICIT_EULER;
+	header.sectionCount = 6;
+
+	buffer.assign(sizeof(SceneHeader), 0);
+	memcpy(buffer.data(), &header, sizeof(SceneHeader));
+
+	writeSceneSection(buffer, SCENE_SECTION_POSITIONS, 12, positions.data(), bodyCount * 12);
+	writeSceneSection(buffer, SCENE_SECTION_VELOCITIES, 12, velocities.data(), bodyCount * 12);
+	writeSceneSection(buffer, SCENE_SECTION_MASSES, 4, masses.data(), bodyCount * 4);
+	writeSceneSection(buffer, SCENE_SECTION_RADII, 4, radii.data(), bodyCount * 4);
+	writeSceneSection(buffer, SCENE_SECTION_COLORS, 4, colors.data(), bodyCount * 4);
+	writeSceneSection(buffer, SCENE_SECTION_FLAGS, 1, flags.data(), bodyCount);
+}
+
+void saveScene(Universe* universe, const char* filePath) {
+	std::vector<char> buffer;
+	serializeScene(universe, buffer);
+
+	std::ofstream outfile(filePath, std::ios::binary);
+	if (!outfile.is_open()) {
+		std::cout << "[ERROR] Could not write the scene file '" << filePath << "'." << std::endl;
+		return;
+	}
+
+	outfile.write(buffer.data(), buffer.size());
+	outfile.close();
+}
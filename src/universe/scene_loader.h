@@ -2,6 +2,57 @@
 
 #include "universe.h"
 #include <fstream>
+#include <cstdint>
+#include <vector>
+
+#define SCENE_MAGIC "GSCN"
+#define SCENE_VERSION 2 // Version written by saveScene (version 1 files, which have no header, can still be loaded)
+#define SCENE_ALIGNMENT 16 // Every section of a version 2 file starts at a multiple of this offset
+
+#define SCENE_INTEGRATOR_SEMI_IMPLICIT_EULER 0 // Velocities are updated before the positions (see Universe::updateBodies)
+
+// Section identifiers (four characters read as an integer, in the byte order of the file, see SceneHeader)
+#define SCENE_SECTION_POSITIONS 0x49534F50 // "POSI": 3 floats per body
+#define SCENE_SECTION_VELOCITIES 0x4F4C4556 // "VELO": 3 floats per body
+#define SCENE_SECTION_MASSES 0x5353414D // "MASS": 1 float per body
+#define SCENE_SECTION_RADII 0x49444152 // "RADI": 1 float per body
+#define SCENE_SECTION_COLORS 0x524C4F43 // "COLR": 4 bytes per body (red, green, blue, unused)
+#define SCENE_SECTION_FLAGS 0x47414C46 // "FLAG": 1 byte per body (SCENE_BODY_* bits)
+
+#define SCENE_BODY_AFFECTED_BY_GRAVITY 1
+#define SCENE_BODY_AFFECTS_OTHERS 2
+
+// Start of a version 2 scene file, see "Scenes/Scene File Definition.txt". Like the sections, it is copied as is,
+// so files are in the byte order of the machine that saved them
+struct SceneHeader {
+	char magic[4];
+	uint32_t version;
+	uint32_t headerSize; // Offset of the first section, so that fields can be added without breaking older readers
+	uint32_t bodyCount;
+	uint32_t flags; // None defined yet
+	uint32_t emissiveBodyIndex;
+	float gConstant;
+	float timeScale;
+	uint32_t integrator;
+	uint32_t sectionCount;
+	uint32_t reserved[6];
+};
+
+struct SceneSectionHeader {
+	uint32_t id;
+	uint32_t elementSize; // Size of the data of a single body
+	uint64_t size; // Size of the data following this header, without the padding up to the next section
+};
 
 Universe* loadScene(const char* filePath);
-void saveScene(Universe* universe, const char* filePath);
\ No newline at end of file
+void saveScene(Universe* universe, const char* filePath);
+
+// Builds a universe from the content of a scene file (any version), nullptr if it isn't valid
+Universe* parseScene(const char* data, size_t length);
+
+// Replaces the content of buffer with the universe as a version 2 scene file
+void serializeScene(Universe* universe, std::vector<char>& buffer);
+// Adds a section to a scene made by serializeScene (loaders skip the sections they don't know)
+void appendSceneSection(std::vector<char>& buffer, uint32_t id, uint32_t elementSize, const void* data, size_t size);
+// Data of the first section with the given id in a version 2 scene file, nullptr if there is none
+const char* findSceneSection(const char* data, size_t length, uint32_t id, uint64_t& size);
@@ -0,0 +1,425 @@
+#include "simulation.h"
+#include "triple_buffer.h"
+#include "scene_loader.h"
+#include "playback.h"
+
+#include <iostream>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+
+namespace simulation {
+	Universe* universe; // Owned by the simulation thread once it has started
+	TripleBuffer<Snapshot> snapshots;
+	unsigned long long tickCount = 0;
+	unsigned int universeId = 0;
+
+	std::thread simulationThread;
+	std::atomic<bool> running(false);
+
+	std::mutex commandMutex;
+	std::vector<Command> queuedCommands;
+	std::vector<Command> pendingCommands; // Commands being applied, swapped with queuedCommands so the lock is only held for the swap
+	std::vector<MassBody*> batchedBodies; // Bodies of consecutive AddBody commands
+	std::vector<unsigned int> batchedBodyIds; // Bodies of consecutive DeleteBody commands
+
+	PropertyValue::PropertyValue(float number) : number(number), color(), flag(false) {}
+	PropertyValue::PropertyValue(Color color) : number(0.0f), color(color), flag(false) {}
+	PropertyValue::PropertyValue(bool flag) : number(0.0f), color(), flag(flag) {}
+
+	Command::Command(CommandType type) : type(type), body(nullptr), bodyId(0), property(BodyProperty::Mass), value(0.0f), universe(nullptr) {}
+
+	Command Command::AddBody(MassBody* body) {
+		Command command(CommandType::AddBody);
+		command.body = body;
+		return command;
+	}
+
+	Command Command::DeleteBody(unsigned int bodyId) {
+		Command command(CommandType::DeleteBody);
+		command.bodyId = bodyId;
+		return command;
+	}
+
+	Command Command::SetProperty(unsigned int bodyId, BodyProperty property, PropertyValue value) {
+		Command command(CommandType::SetProperty);
+		command.bodyId = bodyId;
+		command.property = property;
+		command.value = value;
+		return command;
+	}
+
+	Command Command::SetEmissive(unsigned int bodyId) {
+		Command command(CommandType::SetEmissive);
+		command.bodyId = bodyId;
+		return command;
+	}
+
+	Command Command::SetTimeScale(float timeScale) {
+		Command command(CommandType::SetTimeScale);
+		command.value = timeScale;
+		return command;
+	}
+
+	Command Command::SetGravityConstant(float gConstant) {
+		Command command(CommandType::SetGravityConstant);
+		command.value = gConstant;
+		return command;
+	}
+
+	Command Command::LoadScene(std::string path) {
+		Command command(CommandType::LoadScene);
+		command.path = path;
+		return command;
+	}
+
+	Command Command::SaveScene(std::string path) {
+		Command command(CommandType::SaveScene);
+		command.path = path;
+		return command;
+	}
+
+	Command Command::SetUniverse(Universe* universe) {
+		Command command(CommandType::SetUniverse);
+		command.universe = universe;
+		return command;
+	}
+
+	Command Command::StartRecording(std::string path, recorder::Settings settings) {
+		Command command(CommandType::StartRecording);
+		command.path = path;
+		command.recordingSettings = settings;
+		return command;
+	}
+
+	Command Command::StopRecording() {
+		return Command(CommandType::StopRecording);
+	}
+
+	Command Command::StartPlayback(std::string path) {
+		Command command(CommandType::StartPlayback);
+		command.path = path;
+		return command;
+	}
+
+	Command Command::StopPlayback() {
+		return Command(CommandType::StopPlayback);
+	}
+
+	Command Command::SetPlaybackPaused(bool paused) {
+		Command command(CommandType::SetPlaybackPaused);
+		command.value = paused;
+		return command;
+	}
+
+	Command Command::SeekPlayback(float time) {
+		Command command(CommandType::SeekPlayback);
+		command.value = time;
+		return command;
+	}
+
+	Command Command::SetPlaybackSpeed(float speed) {
+		Command command(CommandType::SetPlaybackSpeed);
+		command.value = speed;
+		return command;
+	}
+
+	void setBodyProperty(MassBody* body, BodyProperty property, PropertyValue value) {
+		switch (property) {
+		case BodyProperty::Mass: body->mass = value.number; break;
+		case BodyProperty::Radius: body->radius = value.number; break;
+		case BodyProperty::Color: body->color = value.color; break;
+		case BodyProperty::AffectedByGravity: body->affectedByGravity = value.flag; break;
+		case BodyProperty::AffectsOthers: body->affectsOthers = value.flag; break;
+		}
+	}
+
+	Snapshot::RaycastHit::RaycastHit(bool hit, unsigned int hitBodyId, unsigned int hitBodyIndex, glm::vec3 hitPosition) {
+		this->hit = hit;
+		this->hitBodyId = hitBodyId;
+		this->hitBodyIndex = hitBodyIndex;
+		this->hitPosition = hitPosition;
+	}
+
+	int Snapshot::GetBodyIndex(unsigned int bodyId) const {
+		for (unsigned int i = 0; i < bodies.size(); i++) {
+			if (bodies[i].id == bodyId) return i;
+		}
+
+		return -1;
+	}
+
+	const MassBody* Snapshot::FindBody(unsigned int bodyId) const {
+		int bodyIndex = GetBodyIndex(bodyId);
+		return bodyIndex >= 0 ? &bodies[bodyIndex] : nullptr;
+	}
+
+	const MassBody* Snapshot::GetEmissiveBody() const {
+		return emissiveBodyIndex >= 0 ? &bodies[emissiveBodyIndex] : nullptr;
+	}
+
+	Snapshot::RaycastHit Snapshot::Raycast(glm::vec3 startPos, glm::vec3 dir) const {
+		RaycastHit closestHit(false, 0, 0, glm::vec3());
+
+		for (unsigned int i = 0; i < bodies.size(); i++) {
+			const MassBody& body = bodies[i];
+			float t = glm::dot(body.position - startPos, dir);
+			glm::vec3 p = startPos + dir * t;
+
+			float y = glm::length(body.position - p);
+			float radius = body.radius;
+			if (y < radius) {
+				float x = std::sqrt(radius * radius - y * y);
+				float t1 = t - x;
+				if (t1 > 0) {
+					glm::vec3 hitPos = startPos + dir * t1;
+					if (!closestHit.hit || glm::distance(closestHit.hitPosition, startPos) > glm::distance(hitPos, startPos)) {
+						closestHit = RaycastHit(true, body.id, i, hitPos);
+					}
+				}
+			}
+		}
+
+		return closestHit;
+	}
+
+	// Copies the universe (or the recording being played back) into the back snapshot and hands it over to the render thread
+	void publishSnapshot() {
+		Snapshot& snapshot = snapshots.getBack();
+
+		if (playback::isOpen()) {
+			if (!playback::fillSnapshot(snapshot)) {
+				if (!playback::isOpen()) universeId++; // Closed after a decoding error, the next snapshots have the bodies of the universe again
+				return; // The frame at the playhead isn't decoded yet, the render thread keeps the previous one
+			}
+		}
+		else {
+			const std::vector<MassBody*>& bodies = *universe->GetBodies();
+
+			snapshot.bodies.clear();
+			for (MassBody* body : bodies) {
+				snapshot.bodies.push_back(*body);
+			}
+
+			snapshot.emissiveBodyIndex = bodies.empty() ? -1 : (int)std::min<size_t>(universe->GetEmissiveBodyIndex(), bodies.size() - 1);
+			snapshot.timeScale = universe->timeScale;
+			snapshot.tick = tickCount;
+		}
+
+		snapshot.gConstant = universe->gConstant;
+		snapshot.universeId = universeId;
+		snapshot.recording = recorder::isRecording();
+
+		snapshot.playingBack = playback::isOpen();
+		snapshot.playbackPaused = playback::isPaused();
+		snapshot.playbackTime = (float)playback::getTime();
+		snapshot.playbackDuration = (float)playback::getDuration();
+
+		snapshots.publish();
+	}
+
+	void replaceUniverse(Universe* newUniverse) {
+		delete universe;
+		universe = newUniverse;
+		universeId++;
+	}
+
+	void applyCommand(const Command& command) {
+		switch (command.type) {
+		case CommandType::SetProperty: {
+			int bodyIndex = universe->GetBodyIndex(command.bodyId);
+			if (bodyIndex >= 0) setBodyProperty((*universe->GetBodies())[bodyIndex], command.property, command.value);
+			break;
+		}
+		case CommandType::SetEmissive: {
+			int bodyIndex = universe->GetBodyIndex(command.bodyId);
+			if (bodyIndex >= 0) universe->SetEmissiveBody(bodyIndex);
+			break;
+		}
+		case CommandType::SetTimeScale:
+			universe->timeScale = command.value.number;
+			break;
+		case CommandType::SetGravityConstant:
+			universe->gConstant = command.value.number;
+			break;
+		case CommandType::LoadScene: {
+			Universe* loadedUniverse = loadScene(command.path.c_str());
+			if (loadedUniverse != nullptr) replaceUniverse(loadedUniverse);
+			break;
+		}
+		case CommandType::SaveScene:
+			saveScene(universe, command.path.c_str());
+			break;
+		case CommandType::SetUniverse:
+			replaceUniverse(command.universe);
+			break;
+		case CommandType::StartRecording:
+			recorder::start(command.path, command.recordingSettings);
+			break;
+		case CommandType::StopRecording:
+			recorder::stop();
+			break;
+		case CommandType::StartPlayback:
+			if (playback::open(command.path)) universeId++; // The snapshots now have other bodies
+			break;
+		case CommandType::StopPlayback:
+			if (playback::isOpen()) universeId++;
+			playback::close();
+			break;
+		case CommandType::SetPlaybackPaused:
+			playback::setPaused(command.value.flag);
+			break;
+		case CommandType::SeekPlayback:
+			playback::seek(command.value.number);
+			break;
+		case CommandType::SetPlaybackSpeed:
+			playback::setSpeed(command.value.number);
+			break;
+		default:
+			break;
+		}
+	}
+
+	void applyCommands() {
+		{
+			std::lock_guard<std::mutex> lock(commandMutex);
+			pendingCommands.swap(queuedCommands);
+		}
+
+		for (size_t i = 0; i < pendingCommands.size();) {
+			CommandType type = pendingCommands[i].type;
+
+			if (type != CommandType::AddBody && type != CommandType::DeleteBody) {
+				applyCommand(pendingCommands[i]);
+				i++;
+				continue;
+			}
+
+			// Consecutive additions or deletions go to the universe all at once
+			batchedBodies.clear();
+			batchedBodyIds.clear();
+			for (; i < pendingCommands.size() && pendingCommands[i].type == type; i++) {
+				if (type == CommandType::AddBody) batchedBodies.push_back(pendingCommands[i].body);
+				else batchedBodyIds.push_back(pendingCommands[i].bodyId);
+			}
+
+			if (type == CommandType::AddBody) {
+				universe->AddBodies(batchedBodies.data(), batchedBodies.size());
+			}
+			else {
+				// Only bodies that are still there count towards the limit, each of them once
+				std::sort(batchedBodyIds.begin(), batchedBodyIds.end());
+				batchedBodyIds.erase(std::unique(batchedBodyIds.begin(), batchedBodyIds.end()), batchedBodyIds.end());
+				batchedBodyIds.erase(std::remove_if(batchedBodyIds.begin(), batchedBodyIds.end(), [](unsigned int bodyId) { return universe->GetBodyIndex(bodyId) < 0; }), batchedBodyIds.end());
+
+				size_t deletableCount = universe->GetBodies()->size() - 1; // The camera and the light always need a body
+				if (batchedBodyIds.size() > deletableCount) batchedBodyIds.resize(deletableCount);
+				universe->DeleteBodies(batchedBodyIds.data(), batchedBodyIds.size());
+			}
+		}
+		pendingCommands.clear();
+	}
+
+	void tick(double tickDuration) {
+		applyCommands();
+		if (playback::isOpen()) {
+			playback::advance(tickDuration); // The universe waits, untouched, for the playback to stop
+		}
+		else {
+			universe->tick(tickDuration);
+			tickCount++;
+			recorder::capture(universe, tickCount);
+		}
+		publishSnapshot();
+	}
+
+	void run() {
+		typedef std::chrono::steady_clock Clock;
+		const std::chrono::duration<double> tickDuration(1.0 / SIMULATION_TICK_RATE);
+		const std::chrono::duration<double> maxLag(SIMULATION_MAX_LAG);
+
+		Clock::time_point nextTick = Clock::now();
+
+		while (running) {
+			tick(tickDuration.count());
+
+			nextTick += std::chrono::duration_cast<Clock::duration>(tickDuration);
+
+			// When ticks take longer than they simulate (too many bodies), slow the scene down rather than piling up ticks to catch up on
+			Clock::time_point now = Clock::now();
+			if (now - nextTick > maxLag) nextTick = now;
+
+			std::this_thread::sleep_until(nextTick);
+		}
+
+		applyCommands();
+	}
+
+	void start(Universe* universe, bool realTime) {
+		if (running) {
+			std::cout << "[WARNING] The simulation is already running." << std::endl;
+			return;
+		}
+
+		simulation::universe = universe;
+
+		// The first snapshot is published from this thread so that it can be used right away
+		publishSnapshot();
+		acquireSnapshot();
+
+		running = true;
+		if (realTime) simulationThread = std::thread(run);
+	}
+
+	void step(unsigned int ticks) {
+		if (!running || simulationThread.joinable()) {
+			std::cout << "[WARNING] Only a simulation that isn't ticked in real time can be stepped." << std::endl;
+			return;
+		}
+
+		for (unsigned int i = 0; i < ticks; i++) {
+			tick(1.0 / SIMULATION_TICK_RATE);
+		}
+	}
+
+	void stop() {
+		if (!running) return;
+
+		running = false;
+		if (simulationThread.joinable()) simulationThread.join();
+		else applyCommands();
+		recorder::stop();
+		playback::close();
+
+		delete universe;
+		universe = nullptr;
+	}
+
+	bool isRunning() {
+		return running;
+	}
+
+	void queueCommand(const Command& command) {
+		std::lock_guard<std::mutex> lock(commandMutex);
+		queuedCommands.push_back(command);
+	}
+
+	void setUniverse(Universe* universe, bool realTime) {
+		if (!running) {
+			start(universe, realTime);
+			return;
+		}
+
+		queueCommand(Command::SetUniverse(universe));
+	}
+
+	bool acquireSnapshot() {
+		return snapshots.acquire();
+	}
+
+	const Snapshot& getSnapshot() {
+		return snapshots.getFront();
+	}
+}
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <vector>
+#include <string>
+
+#include "universe.h"
+#include "mass_body.h"
+#include "recorder.h"
+
+#define SIMULATION_TICK_RATE 240 // Ticks per second (every tick advances the universe by the same amount of time, whatever the frame rate is)
+#define SIMULATION_MAX_LAG 0.1 // Seconds the simulation may fall behind real time before it stops trying to catch up
+
+namespace simulation {
+	// Copy of the universe made after a tick. The render thread only reads bodies from snapshots, never from the universe itself
+	struct Snapshot {
+		std::vector<MassBody> bodies; // Copies, identified by their id
+		int emissiveBodyIndex = -1; // -1 when there are no bodies
+		float timeScale = 0.0f;
+		float gConstant = 0.0f;
+		unsigned long long tick = 0; // Number of ticks simulated before the snapshot was made
+		unsigned int universeId = 0; // Changes every time the universe is replaced (e.g. a scene was loaded)
+		bool recording = false;
+
+		// State of the recording being played back instead of the simulation, if there is one
+		bool playingBack = false;
+		bool playbackPaused = false;
+		float playbackTime = 0.0f; // Seconds
+		float playbackDuration = 0.0f;
+
+		struct RaycastHit {
+			bool hit;
+			unsigned int hitBodyId;
+			unsigned int hitBodyIndex;
+			glm::vec3 hitPosition;
+
+			RaycastHit(bool hit, unsigned int hitBodyId, unsigned int hitBodyIndex, glm::vec3 hitPosition);
+		};
+
+		int GetBodyIndex(unsigned int bodyId) const;
+		const MassBody* FindBody(unsigned int bodyId) const; // nullptr if the body isn't part of the snapshot
+		const MassBody* GetEmissiveBody() const;
+		RaycastHit Raycast(glm::vec3 startPos, glm::vec3 dir) const;
+	};
+
+	enum class CommandType {
+		AddBody,
+		DeleteBody,
+		SetProperty,
+		SetEmissive,
+		SetTimeScale,
+		SetGravityConstant,
+		LoadScene,
+		SaveScene,
+		SetUniverse,
+		StartRecording,
+		StopRecording,
+		StartPlayback,
+		StopPlayback,
+		SetPlaybackPaused,
+		SeekPlayback,
+		SetPlaybackSpeed
+	};
+
+	enum class BodyProperty {
+		Mass,
+		Radius,
+		Color,
+		AffectedByGravity,
+		AffectsOthers
+	};
+
+	struct PropertyValue {
+		float number;
+		Color color;
+		bool flag;
+
+		PropertyValue(float number);
+		PropertyValue(Color color);
+		PropertyValue(bool flag);
+	};
+
+	// Change to the universe, applied by the simulation thread between two ticks. Built with the static functions below
+	struct Command {
+		CommandType type;
+		MassBody* body; // AddBody (ownership is passed to the universe)
+		unsigned int bodyId; // DeleteBody, SetProperty, SetEmissive. Commands for a body that has been deleted meanwhile are ignored
+		BodyProperty property; // SetProperty
+		PropertyValue value; // SetProperty, SetTimeScale, SetGravityConstant, SetPlaybackPaused, SeekPlayback, SetPlaybackSpeed
+		std::string path; // LoadScene, SaveScene, StartRecording, StartPlayback
+		recorder::Settings recordingSettings; // StartRecording
+		Universe* universe; // SetUniverse (ownership is passed to the simulation)
+
+		static Command AddBody(MassBody* body);
+		static Command DeleteBody(unsigned int bodyId); // Ignored if it is the last body of the universe
+		static Command SetProperty(unsigned int bodyId, BodyProperty property, PropertyValue value);
+		static Command SetEmissive(unsigned int bodyId);
+		static Command SetTimeScale(float timeScale);
+		static Command SetGravityConstant(float gConstant);
+		static Command LoadScene(std::string path);
+		static Command SaveScene(std::string path);
+		static Command SetUniverse(Universe* universe);
+		static Command StartRecording(std::string path, recorder::Settings settings);
+		static Command StopRecording();
+		static Command StartPlayback(std::string path); // The universe is left as it is until the playback is stopped
+		static Command StopPlayback();
+		static Command SetPlaybackPaused(bool paused);
+		static Command SeekPlayback(float time); // Seconds since the start of the recording
+		static Command SetPlaybackSpeed(float speed);
+
+	private:
+		Command(CommandType type);
+	};
+
+	void setBodyProperty(MassBody* body, BodyProperty property, PropertyValue value); // Applies a SetProperty command's change directly
+
+	// Publishes a first snapshot of the universe and starts ticking it on the simulation thread, which owns it from then on.
+	// Without realTime, no thread is started and the universe only advances when step() is called (e.g. a fixed number of ticks per video frame)
+	void start(Universe* universe, bool realTime = true);
+	// Applies the queued commands and ticks on the calling thread, publishing a snapshot after every tick. Only for a simulation started without realTime
+	void step(unsigned int ticks);
+	// Stops the simulation thread (after applying the commands that are still queued), finishes the recording, closes the playback and deletes the universe
+	void stop();
+	bool isRunning();
+
+	// Can be called from any thread. Consecutive AddBody and DeleteBody commands are applied as a single batch
+	void queueCommand(const Command& command);
+	// Replaces the simulated universe (the previous one is deleted by the simulation thread). Starts the simulation if it isn't running
+	void setUniverse(Universe* universe, bool realTime = true);
+
+	// Render thread only: makes the latest published snapshot the current one. Call once per frame so that a frame only sees one state
+	bool acquireSnapshot();
+	// Render thread only: the current snapshot, which stays the same until the next acquireSnapshot()
+	const Snapshot& getSnapshot();
+}
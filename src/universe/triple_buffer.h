@@ -0,0 +1,42 @@
+#pragma once
+
+#include <atomic>
+
+// Lets one thread publish values that another thread reads without ever blocking either of them.
+// The writer fills the back buffer and publishes it, the reader acquires the latest published buffer as its front buffer.
+// The buffers are reused, so values that own memory (e.g. vectors) stop allocating once they have grown large enough.
+template<typename T>
+class TripleBuffer
+{
+private:
+	static const int FRESH_BIT = 4; // Set on the shared index when it holds a buffer the reader hasn't acquired yet
+
+	T buffers[3];
+	std::atomic<int> shared; // Buffer that is between the writer and the reader (| FRESH_BIT)
+	int back; // Only accessed by the writer
+	int front; // Only accessed by the reader
+
+public:
+	TripleBuffer() : shared(1), back(0), front(2) {}
+
+	// Writer side
+	T& getBack() {
+		return buffers[back];
+	}
+
+	void publish() {
+		back = shared.exchange(back | FRESH_BIT, std::memory_order_acq_rel) & ~FRESH_BIT;
+	}
+
+	// Reader side. Returns false (and keeps the current front buffer) if nothing was published since the last call
+	bool acquire() {
+		if ((shared.load(std::memory_order_relaxed) & FRESH_BIT) == 0) return false;
+
+		front = shared.exchange(front, std::memory_order_acq_rel) & ~FRESH_BIT;
+		return true;
+	}
+
+	const T& getFront() const {
+		return buffers[front];
+	}
+};
@@ -14,55 +14,67 @@ Universe::~Universe() {
 	}
 }
 
-std::vector<MassBody*>* Universe::GetBodies() {
+const std::vector<MassBody*>* Universe::GetBodies() {
 	return &bodies;
 }
 
-int Universe::GetBodyIndex(MassBody* body) {
-	int bodyIndex = -1;
-	for (int i = 0; i < bodies.size(); i++) {
-		if (bodies.at(i) == body) bodyIndex = i;
-	}
-	
-	return bodyIndex;
+int Universe::GetBodyIndex(unsigned int bodyId) {
+	auto bodyIndex = bodyIndices.find(bodyId);
+	if (bodyIndex == bodyIndices.end()) return -1;
+
+	return bodyIndex->second;
 }
 
-void Universe::AssignOccluders() {
-	for (int i = 0; i < bodies.size(); i++) {
-		bodies.at(i)->occluders.clear();
+void Universe::AddBody(MassBody* body) {
+	AddBodies(&body, 1);
+}
 
-		for (int j = 0; j < bodies.size(); j++) {
-			if (i == j || j == emissiveBodyIndex) continue; // A body should never been its own occluder, nor should the light source been an occluder
+void Universe::AddBodies(MassBody* const* addedBodies, size_t count) {
+	bodies.reserve(bodies.size() + count);
+	bodyIndices.reserve(bodies.size() + count);
 
-			bodies.at(i)->occluders.push_back(bodies.at(j));
-			if (bodies.at(i)->occluders.size() >= MAX_OCCLUDERS) break;
+	for (size_t i = 0; i < count; i++) {
+		auto added = bodyIndices.emplace(addedBodies[i]->id, (unsigned int)bodies.size());
+		if (!added.second) {
+			// A body with this id is already part of the universe: the one passed is owned but unused, unless it's that same body
+			if (bodies[added.first->second] != addedBodies[i]) delete addedBodies[i];
+			continue;
 		}
+
+		bodies.push_back(addedBodies[i]);
 	}
 }
 
-void Universe::AddBody(MassBody* body) {
-	bodies.push_back(body);
-
-	// Re-assign occluders
-	AssignOccluders();
+void Universe::DeleteBody(unsigned int bodyId) {
+	DeleteBodies(&bodyId, 1);
 }
 
-void Universe::DeleteBody(MassBody* body) {
-	int bodyIndex = GetBodyIndex(body);
+void Universe::DeleteBodies(const unsigned int* deletedBodyIds, size_t count) {
+	unsigned int emissiveBodyId = emissiveBodyIndex < bodies.size() ? bodies[emissiveBodyIndex]->id : 0;
+
+	for (size_t i = 0; i < count; i++) {
+		auto deletedIndex = bodyIndices.find(deletedBodyIds[i]);
+		if (deletedIndex == bodyIndices.end()) continue;
 
-	if (bodyIndex >= 0) bodies.erase(bodies.begin() + bodyIndex);
+		// Swap and pop: the last body takes the place of the deleted one
+		unsigned int index = deletedIndex->second;
+		MassBody* deletedBody = bodies[index];
+		MassBody* lastBody = bodies.back();
+		bodies[index] = lastBody;
+		bodyIndices[lastBody->id] = index;
 
-	delete body;
+		bodies.pop_back();
+		bodyIndices.erase(deletedBodyIds[i]);
+		delete deletedBody;
+	}
 
-	// Re-assign occluders
-	AssignOccluders();
+	// Keep the same body emissive, it may have been moved
+	int newEmissiveBodyIndex = GetBodyIndex(emissiveBodyId);
+	emissiveBodyIndex = newEmissiveBodyIndex >= 0 ? newEmissiveBodyIndex : 0;
 }
 
 void Universe::SetEmissiveBody(unsigned int index) {
 	emissiveBodyIndex = index;
-
-	// Re-assign occluders
-	AssignOccluders();
 }
 
 unsigned int Universe::GetEmissiveBodyIndex() {
@@ -73,38 +85,6 @@ MassBody* Universe::GetEmissiveBody() {
 	return bodies.at(emissiveBodyIndex);
 }
 
-Universe::RaycastHit::RaycastHit(bool hit, MassBody* hitBody, unsigned int hitBodyIndex, glm::vec3 hitPosition) {
-	this->hit = hit;
-	this->hitBody = hitBody;
-	this->hitBodyIndex = hitBodyIndex;
-	this->hitPosition = hitPosition;
-}
-
-Universe::RaycastHit Universe::Raycast(glm::vec3 startPos, glm::vec3 dir) {
-	RaycastHit closestHit(false, nullptr, 0, glm::vec3());
-
-	for (unsigned int i = 0; i < bodies.size(); i++) {
-		MassBody* body = bodies.at(i);
-		float t =  glm::dot(body->position-startPos, dir);
-		glm::vec3 p = startPos + dir*t;
-
-		float y = glm::length(body->position-p);
-		float radius = body->radius;
-		if (y < radius) {
-			float x = std::sqrtf(radius * radius - y * y);
-			float t1 = t - x;
-			if (t1 > 0) {
-				glm::vec3 hitPos = startPos + dir * t1;
-				if (!closestHit.hit || glm::distance(closestHit.hitPosition, startPos) > glm::distance(hitPos, startPos)) {
-					closestHit = RaycastHit(true, body, i, hitPos);
-				}
-			}
-		}
-	}
-
-	return closestHit;
-}
-
 void Universe::tick(double deltaTime) {
 	if (timeScale > 0 && deltaTime < 0.05F) updateBodies(deltaTime*timeScale); // If deltaTime is too high, don't update the bodies as the large deltaTime will distort orbits
 }
@@ -2,17 +2,16 @@
 
 #include <glm/gtc/matrix_transform.hpp>
 #include <vector>
+#include <unordered_map>
 
-#include "../rendering/render_model.h"
 #include "mass_body.h"
 
-#define MAX_OCCLUDERS 4
-
 class Universe
 {
 private:
 	glm::vec3 lightPosition;
-	std::vector<MassBody*> bodies;
+	std::vector<MassBody*> bodies; // Unordered: removing a body moves the last one into its place
+	std::unordered_map<unsigned int, unsigned int> bodyIndices; // Where every body is in bodies, by id
 	unsigned int emissiveBodyIndex;
 
 	void updateBodies(double deltaTime); // Update velocities and positions of all bodies in the universe
@@ -20,25 +19,16 @@ public:
 	Universe();
 	~Universe();
 
-	struct RaycastHit {
-		bool hit;
-		MassBody* hitBody;
-		unsigned int hitBodyIndex;
-		glm::vec3 hitPosition;
-
-		RaycastHit(bool hit, MassBody* hitBody, unsigned int hitBodyIndex, glm::vec3 hitPosition);
-	};
-
 	float timeScale;
 	float gConstant;
 
-	std::vector<MassBody*>* GetBodies();
-	int GetBodyIndex(MassBody* body);
-	void AssignOccluders();
+	const std::vector<MassBody*>* GetBodies();
+	int GetBodyIndex(unsigned int bodyId); // -1 if the body isn't part of the universe
 	void AddBody(MassBody* body);
-	void DeleteBody(MassBody* body);
+	void AddBodies(MassBody* const* addedBodies, size_t count); // Takes ownership of the bodies, those whose id is already used are deleted
+	void DeleteBody(unsigned int bodyId);
+	void DeleteBodies(const unsigned int* deletedBodyIds, size_t count); // Bodies that aren't part of the universe are ignored
 	void SetEmissiveBody(unsigned int emittingBodyIndex);
-	RaycastHit Raycast(glm::vec3 startPos, glm::vec3 dir);
 	unsigned int GetEmissiveBodyIndex();
 	MassBody* GetEmissiveBody();
 	
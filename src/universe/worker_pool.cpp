@@ -0,0 +1,82 @@
+#include "worker_pool.h"
+
+WorkerPool::WorkerPool(unsigned int threadCount) : job(nullptr), jobCount(0), nextJob(0), remainingJobs(0), activeThreads(0), batch(0), stopping(false) {
+	if (threadCount == 0) {
+		unsigned int hardwareThreads = std::thread::hardware_concurrency();
+		threadCount = hardwareThreads > 1 ? hardwareThreads - 1 : 0;
+	}
+
+	for (unsigned int i = 0; i < threadCount; i++) {
+		threads.push_back(std::thread(&WorkerPool::runThread, this));
+	}
+}
+
+WorkerPool::~WorkerPool() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	batchCondition.notify_all();
+
+	for (std::thread& thread : threads) {
+		thread.join();
+	}
+}
+
+size_t WorkerPool::runJobs() {
+	size_t doneJobs = 0;
+	for (size_t jobIndex = nextJob++; jobIndex < jobCount; jobIndex = nextJob++) {
+		(*job)(jobIndex);
+		doneJobs++;
+	}
+
+	return doneJobs;
+}
+
+void WorkerPool::runThread() {
+	unsigned int lastBatch = 0;
+
+	while (true) {
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			batchCondition.wait(lock, [&]() { return stopping || batch != lastBatch; });
+			if (stopping) return;
+			lastBatch = batch;
+			activeThreads++;
+		}
+
+		size_t doneJobs = runJobs();
+
+		std::lock_guard<std::mutex> lock(mutex);
+		remainingJobs -= doneJobs;
+		activeThreads--;
+		if (activeThreads == 0) doneCondition.notify_all();
+	}
+}
+
+void WorkerPool::run(size_t jobCount, const std::function<void(size_t)>& job) {
+	if (jobCount == 0) return;
+
+	{
+		// A thread that woke up late for the previous batch may still be leaving it
+		std::unique_lock<std::mutex> lock(mutex);
+		doneCondition.wait(lock, [&]() { return activeThreads == 0; });
+
+		this->job = &job;
+		this->jobCount = jobCount;
+		nextJob = 0;
+		remainingJobs = jobCount;
+		batch++;
+	}
+	batchCondition.notify_all();
+
+	size_t doneJobs = runJobs();
+
+	std::unique_lock<std::mutex> lock(mutex);
+	remainingJobs -= doneJobs;
+	doneCondition.wait(lock, [&]() { return remainingJobs == 0 && activeThreads == 0; });
+}
+
+unsigned int WorkerPool::getThreadCount() {
+	return threads.size() + 1;
+}
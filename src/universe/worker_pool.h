@@ -0,0 +1,38 @@
+#pragma once
+
+#include <functional>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+// Fixed set of threads that run the jobs of one batch at a time. The thread calling run() works on the batch too
+class WorkerPool
+{
+private:
+	std::vector<std::thread> threads;
+	std::mutex mutex;
+	std::condition_variable batchCondition; // Signaled when a batch starts or the pool is destroyed
+	std::condition_variable doneCondition; // Signaled when the last job of a batch is done
+
+	const std::function<void(size_t)>* job;
+	size_t jobCount;
+	std::atomic<size_t> nextJob;
+	size_t remainingJobs;
+	unsigned int activeThreads; // Threads still looking for jobs in the current batch, which must all leave it before the next batch starts
+	unsigned int batch; // Incremented for every batch so that sleeping threads can tell a new batch from a spurious wake-up
+	bool stopping;
+
+	size_t runJobs(); // Returns the number of jobs it ran
+	void runThread();
+
+public:
+	// 0 threads uses one less than the number of hardware threads (the caller of run() is the remaining one)
+	WorkerPool(unsigned int threadCount = 0);
+	~WorkerPool();
+
+	// Calls job(0) to job(jobCount - 1) spread over the threads, and returns once they have all returned
+	void run(size_t jobCount, const std::function<void(size_t)>& job);
+	unsigned int getThreadCount();
+};
@@ -0,0 +1,94 @@
+// Measures the throughput of the pixel format conversions with every instruction set the CPU has, on a noisy frame.
+// Throughput counts the bytes read and written, so that conversions of different pixel sizes can be compared.
+//
+// Usage: pixel_convert_benchmark [width] [height] [frame count]
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <functional>
+#include <cstdlib>
+
+#include "../src/rendering/pixel_convert.h"
+
+#define DEFAULT_WIDTH 1920
+#define DEFAULT_HEIGHT 1080
+#define DEFAULT_FRAME_COUNT 200
+
+static const char* instructionSetNames[] = { "scalar", "SSSE3", "AVX2", "NEON" };
+
+static double benchmark(const std::function<void()>& convert, unsigned int frameCount) {
+	convert(); // Warms up the caches
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (unsigned int frame = 0; frame < frameCount; frame++) convert();
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv) {
+	int width = argc > 1 ? std::atoi(argv[1]) : DEFAULT_WIDTH;
+	int height = argc > 2 ? std::atoi(argv[2]) : DEFAULT_HEIGHT;
+	unsigned int frameCount = argc > 3 ? (unsigned int)std::atoi(argv[3]) : DEFAULT_FRAME_COUNT;
+	if (width <= 0 || height <= 0 || width % 2 != 0 || height % 2 != 0 || frameCount == 0) {
+		std::cout << "[ERROR] The width and height must be even and positive." << std::endl;
+		return 1;
+	}
+
+	size_t pixelCount = (size_t)width * height;
+	std::vector<unsigned char> rgb(pixelCount * 3), rgba(pixelCount * 4);
+	std::mt19937 random(1);
+	for (unsigned char& value : rgb) value = (unsigned char)random();
+	for (unsigned char& value : rgba) value = (unsigned char)random();
+
+	PixelBufferPool pool = {};
+	unsigned char* buffer = pixelBufferPoolGet(&pool, pixelCount * 4);
+	if (buffer == nullptr) return 1;
+
+	unsigned char* planes[3] = { buffer, buffer + pixelCount, buffer + pixelCount * 2 };
+	unsigned char* chromaPlanes[3] = { buffer, buffer + pixelCount, buffer + pixelCount + pixelCount / 4 };
+	size_t chromaRowBytes[3] = { (size_t)width, (size_t)width / 2, (size_t)width / 2 };
+	unsigned char* biplanes[3] = { buffer, buffer + pixelCount, nullptr };
+	size_t biplanarRowBytes[3] = { (size_t)width, (size_t)width, 0 };
+	size_t packedRowBytes[3] = { (size_t)width * 2, 0, 0 };
+	const unsigned char argbToRGBA[4] = { 1, 2, 3, 0 };
+
+	struct Conversion {
+		const char* name;
+		size_t bytes; // Read and written per frame
+		std::function<void()> convert;
+	};
+
+	std::vector<Conversion> conversions = {
+		{ "RGB888 to planar", pixelCount * 6, [&]() { pixelConvertRGB888ToPlanar8(rgb.data(), width * 3, planes, width, width, height); } },
+		{ "planar to RGB888", pixelCount * 6, [&]() { pixelConvertPlanar8ToRGB888(planes, width, rgb.data(), width * 3, width, height); } },
+		{ "RGB888 to BGR888", pixelCount * 6, [&]() { pixelConvertSwapRB888(rgb.data(), width * 3, buffer, width * 3, width, height); } },
+		{ "ARGB8888 to RGBA8888", pixelCount * 8, [&]() { pixelConvertPermute8888(rgba.data(), width * 4, buffer, width * 4, width, height, argbToRGBA); } },
+		{ "RGBA8888 to RGB888 (flipped)", pixelCount * 7, [&]() { pixelConvertRGBA8888ToRGB888(rgba.data() + (pixelCount - width) * 4, -width * 4, buffer, width * 3, width, height); } },
+		{ "RGB888 to Y'CbCr 4:2:0", pixelCount * 9 / 2, [&]() { pixelConvertRGBToYpCbCr(rgb.data(), width * 3, 3, width, height, PIXEL_YPCBCR_420_PLANAR, 0, chromaPlanes, chromaRowBytes); } },
+		{ "RGBA8888 to Y'CbCr 4:2:0 bi-planar", pixelCount * 11 / 2, [&]() { pixelConvertRGBToYpCbCr(rgba.data(), width * 4, 4, width, height, PIXEL_YPCBCR_420_BIPLANAR, 1, biplanes, biplanarRowBytes); } },
+		{ "RGB888 to Y'CbCr 4:2:2 (2vuy)", pixelCount * 5, [&]() { pixelConvertRGBToYpCbCr(rgb.data(), width * 3, 3, width, height, PIXEL_YPCBCR_422_2VUY, 0, planes, packedRowBytes); } }
+	};
+
+	int supported = pixelConvertGetInstructionSet();
+	std::vector<int> instructionSets = { PIXEL_CONVERT_SCALAR };
+	if (supported == PIXEL_CONVERT_NEON) instructionSets.push_back(PIXEL_CONVERT_NEON);
+	for (int instructionSet = PIXEL_CONVERT_SSSE3; instructionSet <= PIXEL_CONVERT_AVX2 && supported != PIXEL_CONVERT_NEON; instructionSet++) {
+		if (instructionSet <= supported) instructionSets.push_back(instructionSet);
+	}
+
+	std::cout << width << "x" << height << ", " << frameCount << " frames" << std::endl;
+	for (const Conversion& conversion : conversions) {
+		std::cout << std::left << std::setw(36) << conversion.name << std::right;
+		for (int instructionSet : instructionSets) {
+			pixelConvertLimitInstructionSet(instructionSet);
+			double seconds = benchmark(conversion.convert, frameCount);
+			std::cout << "  " << instructionSetNames[instructionSet] << " " << std::fixed << std::setprecision(2) << (double)conversion.bytes * frameCount / seconds / 1e9 << " GB/s";
+		}
+		std::cout << std::endl;
+	}
+
+	pixelBufferPoolRelease(&pool);
+	return 0;
+}
@@ -0,0 +1,76 @@
+// Writes large benchmark scenes (version 1 scene files) with a seeded initial-condition model.
+//
+// Usage: scene_generator <plummer|hernquist|nfw|disk|merger> <body count> <output path> [options]
+//   --seed <number>          Random seed (default: 1)
+//   --mass <mass>            Total mass (default: 1e6)
+//   --scale <radius>         Scale radius, or scale length of the disks (default: 10)
+//   --concentration <c>      NFW only: truncation radius in scale radii (default: 10)
+//   --central <fraction>     Disks only: part of the mass in the central body (default: 0.1)
+//   --separation <radii>     Merger only: starting distance between the galaxies, in scale radii (default: 8)
+//   --body-radius <radius>   Radius of every body but the central ones (default: 0.05)
+//   --g <constant>           Gravitational constant written in the scene (default: 0.0001)
+//
+// The same seed gives the same file whatever the number of threads.
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+
+#include "../src/universe/generators.h"
+
+static bool parseOptions(int argc, char** argv, generators::Settings& settings) {
+	for (int i = 4; i < argc; i++) {
+		if (i + 1 >= argc) {
+			std::cout << "[ERROR] Missing value for '" << argv[i] << "'." << std::endl;
+			return false;
+		}
+
+		const char* value = argv[++i];
+		const char* option = argv[i - 1];
+		if (strcmp(option, "--seed") == 0) settings.seed = std::strtoull(value, nullptr, 10);
+		else if (strcmp(option, "--mass") == 0) settings.totalMass = std::atof(value);
+		else if (strcmp(option, "--scale") == 0) settings.scaleRadius = std::atof(value);
+		else if (strcmp(option, "--concentration") == 0) settings.concentration = std::atof(value);
+		else if (strcmp(option, "--central") == 0) settings.centralMassFraction = std::atof(value);
+		else if (strcmp(option, "--separation") == 0) settings.mergerSeparation = std::atof(value);
+		else if (strcmp(option, "--body-radius") == 0) settings.bodyRadius = (float)std::atof(value);
+		else if (strcmp(option, "--g") == 0) settings.gConstant = (float)std::atof(value);
+		else {
+			std::cout << "[ERROR] Unknown option '" << option << "'." << std::endl;
+			return false;
+		}
+	}
+
+	return true;
+}
+
+int main(int argc, char** argv) {
+	generators::Settings settings;
+	if (argc < 4 || !generators::parseModel(argv[1], settings.model) || !parseOptions(argc, argv, settings)) {
+		std::cout << "Usage: scene_generator <plummer|hernquist|nfw|disk|merger> <body count> <output path> [--seed n] [--mass m] [--scale r]"
+			" [--concentration c] [--central f] [--separation d] [--body-radius r] [--g G]" << std::endl;
+		return 1;
+	}
+	settings.bodyCount = std::strtoull(argv[2], nullptr, 10);
+
+	std::vector<char> scene;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	if (!generators::generate(settings, scene)) return 1;
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	std::ofstream file(argv[3], std::ios::binary);
+	file.write(scene.data(), scene.size());
+	if (!file.good()) {
+		std::cout << "[ERROR] Couldn't write '" << argv[3] << "'." << std::endl;
+		return 1;
+	}
+
+	std::cout << "Generated " << settings.bodyCount << " bodies in " << seconds * 1000.0 << " ms (" << settings.bodyCount / seconds / 1e6 << " M bodies/s), "
+		<< scene.size() / (1024.0 * 1024.0) << " MiB written to '" << argv[3] << "'." << std::endl;
+
+	return 0;
+}
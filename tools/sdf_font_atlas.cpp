@@ -0,0 +1,110 @@
+// Converts a bitmap font atlas (e.g. fonts/Comfortaa.png) into a single-channel signed distance field atlas.
+// The glyphs keep their position in the atlas, so the .fnt metrics stay valid for the generated atlas.
+//
+// Usage: sdf_font_atlas <input atlas> <output png> [spread in pixels]
+
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <algorithm>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+#include "../src/rendering/png_writer.h"
+
+#define DEFAULT_SPREAD 4.0f // Distance (in atlas pixels) covered by the field on each side of a glyph edge
+#define COVERAGE_THRESHOLD 128 // Alpha from which a pixel is considered inside a glyph
+
+static const float INF = 1e20f;
+
+// Squared euclidean distance transform of a 1D function (Felzenszwalb & Huttenlocher)
+static void distanceTransform1D(const float* f, float* d, int n, std::vector<int>& v, std::vector<float>& z) {
+	int k = 0;
+	v[0] = 0;
+	z[0] = -INF;
+	z[1] = INF;
+
+	for (int q = 1; q < n; q++) {
+		float s = ((f[q] + q * q) - (f[v[k]] + v[k] * v[k])) / (2.0f * q - 2.0f * v[k]);
+		while (s <= z[k]) {
+			k--;
+			s = ((f[q] + q * q) - (f[v[k]] + v[k] * v[k])) / (2.0f * q - 2.0f * v[k]);
+		}
+		k++;
+		v[k] = q;
+		z[k] = s;
+		z[k + 1] = INF;
+	}
+
+	k = 0;
+	for (int q = 0; q < n; q++) {
+		while (z[k + 1] < q) k++;
+		d[q] = (q - v[k]) * (q - v[k]) + f[v[k]];
+	}
+}
+
+// Squared distance of every pixel to the closest pixel where grid is 0 (the others must be INF)
+static void distanceTransform2D(std::vector<float>& grid, int width, int height) {
+	int size = std::max(width, height);
+	std::vector<float> f(size), d(size), z(size + 1);
+	std::vector<int> v(size);
+
+	for (int x = 0; x < width; x++) {
+		for (int y = 0; y < height; y++) f[y] = grid[y * width + x];
+		distanceTransform1D(f.data(), d.data(), height, v, z);
+		for (int y = 0; y < height; y++) grid[y * width + x] = d[y];
+	}
+
+	for (int y = 0; y < height; y++) {
+		distanceTransform1D(&grid[y * width], d.data(), width, v, z);
+		std::copy(d.begin(), d.begin() + width, grid.begin() + y * width);
+	}
+}
+
+int main(int argc, char** argv) {
+	if (argc < 3) {
+		std::cout << "Usage: " << argv[0] << " <input atlas> <output png> [spread in pixels]" << std::endl;
+		return 1;
+	}
+
+	float spread = argc > 3 ? (float)std::atof(argv[3]) : DEFAULT_SPREAD;
+	if (spread <= 0) {
+		std::cout << "[ERROR] The spread must be positive." << std::endl;
+		return 1;
+	}
+
+	int width, height, channels;
+	unsigned char* atlas = stbi_load(argv[1], &width, &height, &channels, 4);
+	if (atlas == NULL) {
+		std::cout << "[ERROR] Could not load " << argv[1] << "." << std::endl;
+		return 1;
+	}
+
+	// Distance of every pixel to the closest inside pixel, and to the closest outside pixel
+	std::vector<float> toInside(width * height), toOutside(width * height);
+	for (int i = 0; i < width * height; i++) {
+		bool inside = atlas[i * 4 + 3] >= COVERAGE_THRESHOLD;
+		toInside[i] = inside ? 0 : INF;
+		toOutside[i] = inside ? INF : 0;
+	}
+	stbi_image_free(atlas);
+
+	distanceTransform2D(toInside, width, height);
+	distanceTransform2D(toOutside, width, height);
+
+	// The edge lies halfway between an inside and an outside pixel; 0.5 in the output is the edge, higher values are inside
+	std::vector<unsigned char> field(width * height);
+	for (int i = 0; i < width * height; i++) {
+		float distance = toInside[i] > 0 ? std::sqrt(toInside[i]) - 0.5f : -(std::sqrt(toOutside[i]) - 0.5f);
+		float value = 0.5f - distance / (2.0f * spread);
+		field[i] = (unsigned char)std::round(std::min(std::max(value, 0.0f), 1.0f) * 255.0f);
+	}
+
+	if (!renderer::png::write(argv[2], field.data(), width, height, 1)) return 1;
+
+	std::cout << "Wrote " << width << "x" << height << " distance field atlas to " << argv[2] << " (spread " << spread << "px)." << std::endl;
+	return 0;
+}
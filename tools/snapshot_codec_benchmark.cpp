@@ -0,0 +1,121 @@
+// Measures the compression ratio and speed of the recording encodings on a synthetic rotating disk of bodies.
+//
+// Usage: snapshot_codec_benchmark [body count] [frame count] [position bits] [velocity bits]
+
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+
+#include "../src/universe/frame_codec.h"
+
+#define DEFAULT_BODY_COUNT 1000000
+#define DEFAULT_FRAME_COUNT 30
+#define FRAME_DURATION (8.0f / 240.0f) // Default recorder interval at the default tick rate
+
+struct Disk {
+	std::vector<float> radii, angles, angularSpeeds, heights;
+};
+
+static void placeBodies(const Disk& disk, float time, recording::Frame& frame) {
+	for (size_t i = 0; i < frame.getBodyCount(); i++) {
+		float angle = disk.angles[i] + disk.angularSpeeds[i] * time;
+		float speed = disk.angularSpeeds[i] * disk.radii[i];
+		frame.positions[i] = glm::vec3(std::cos(angle) * disk.radii[i], disk.heights[i], std::sin(angle) * disk.radii[i]);
+		frame.velocities[i] = glm::vec3(-std::sin(angle) * speed, 0.0f, std::cos(angle) * speed);
+	}
+}
+
+static double secondsSince(std::chrono::steady_clock::time_point start) {
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void benchmark(const char* name, uint32_t encoding, uint32_t positionBits, uint32_t velocityBits, const Disk& disk, recording::Frame& frame, unsigned int frameCount) {
+	recording::FrameEncoder encoder(encoding, positionBits, velocityBits);
+	recording::FrameDecoder decoder(encoding);
+	recording::Frame decoded;
+
+	size_t bodyCount = frame.getBodyCount();
+	size_t rawFrameSize = bodyCount * (2 * sizeof(glm::vec3) + 2 * sizeof(float) + sizeof(uint32_t));
+	size_t encodedSize = 0;
+	double encodeSeconds = 0.0, decodeSeconds = 0.0;
+	float maxPositionError = 0.0f;
+	unsigned int keyframes = 0;
+	bool valid = true;
+
+	std::vector<char> encoded;
+	for (unsigned int frameIndex = 0; frameIndex < frameCount; frameIndex++) {
+		placeBodies(disk, frameIndex * FRAME_DURATION, frame);
+
+		encoded.clear();
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		uint32_t flags = encoder.encode(frame, encoded);
+		encodeSeconds += secondsSince(start);
+
+		encodedSize += encoded.size();
+		if (flags & RECORDING_FRAME_KEYFRAME) keyframes++;
+
+		recording::FrameHeader header = {};
+		header.frameIndex = frameIndex;
+		header.bodyCount = (uint32_t)bodyCount;
+		header.dataSize = encoded.size();
+		header.flags = flags;
+
+		start = std::chrono::steady_clock::now();
+		valid = decoder.decode(header, encoded.data(), decoded) && valid;
+		decodeSeconds += secondsSince(start);
+
+		for (size_t i = 0; valid && i < bodyCount; i++) {
+			glm::vec3 error = glm::abs(decoded.positions[i] - frame.positions[i]);
+			maxPositionError = std::max(maxPositionError, std::max(std::max(error.x, error.y), error.z));
+		}
+	}
+
+	double rawMegabytes = (double)rawFrameSize * frameCount / (1024.0 * 1024.0);
+	std::cout << name << ": " << (double)encodedSize / frameCount / (1024.0 * 1024.0) << " MB/frame, ratio " << (double)rawFrameSize * frameCount / encodedSize
+		<< ", encode " << rawMegabytes / encodeSeconds << " MB/s, decode " << rawMegabytes / decodeSeconds << " MB/s"
+		<< ", " << keyframes << " keyframes, max position error " << maxPositionError << (valid ? "" : " [DECODING FAILED]") << std::endl;
+}
+
+int main(int argc, char** argv) {
+	size_t bodyCount = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : DEFAULT_BODY_COUNT;
+	unsigned int frameCount = argc > 2 ? std::atoi(argv[2]) : DEFAULT_FRAME_COUNT;
+	uint32_t positionBits = argc > 3 ? std::atoi(argv[3]) : RECORDING_DEFAULT_POSITION_BITS;
+	uint32_t velocityBits = argc > 4 ? std::atoi(argv[4]) : RECORDING_DEFAULT_VELOCITY_BITS;
+
+	if (bodyCount == 0 || frameCount == 0) {
+		std::cout << "Usage: " << argv[0] << " [body count] [frame count] [position bits] [velocity bits]" << std::endl;
+		return 1;
+	}
+
+	// Bodies on circular orbits around a central mass, a few bodies of each mass and color
+	std::mt19937 random(1234);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	std::normal_distribution<float> thickness(0.0f, 0.5f);
+
+	Disk disk;
+	recording::Frame frame;
+	frame.resize(bodyCount);
+	for (size_t i = 0; i < bodyCount; i++) {
+		float radius = 1.0f + 100.0f * std::sqrt(unit(random));
+		disk.radii.push_back(radius);
+		disk.angles.push_back(unit(random) * 6.2831853f);
+		disk.angularSpeeds.push_back(std::sqrt(1000.0f / radius) / radius);
+		disk.heights.push_back(thickness(random));
+
+		frame.masses[i] = (float)(1 + i % 4);
+		frame.radii[i] = 0.1f;
+		frame.colors[i] = i % 2 ? 0xFFD080 : 0x80A0FF;
+	}
+
+	std::cout << bodyCount << " bodies, " << frameCount << " frames, " << bodyCount * (2 * sizeof(glm::vec3) + 2 * sizeof(float) + sizeof(uint32_t)) / (1024.0 * 1024.0) << " MB/frame raw" << std::endl;
+
+	benchmark("float32", RECORDING_ENCODING_FLOAT32, positionBits, velocityBits, disk, frame, frameCount);
+	benchmark("float16", RECORDING_ENCODING_FLOAT16, positionBits, velocityBits, disk, frame, frameCount);
+	benchmark("quantized", RECORDING_ENCODING_QUANTIZED, positionBits, velocityBits, disk, frame, frameCount);
+
+	return 0;
+}